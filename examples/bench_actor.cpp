@@ -0,0 +1,130 @@
+/**
+ * bench_actor.cpp
+ * ---------------
+ * Message throughput of ActorSystem (actors multiplexed on ThreadPoolV2).
+ *
+ *   PING-PONG: pairs of actors bounce one message back and forth.
+ *              Every hop is a full schedule → activate → receive cycle,
+ *              so this measures per-activation overhead (batch never fills).
+ *
+ *   RING:      N actors in a ring, several tokens circulating at once.
+ *              Mailboxes hold more than one message, so activations
+ *              process batches — this shows what batching buys.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_actor.cpp -Iinclude -o bench_actor
+ * Run:
+ *   ./bench_actor
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <string>
+#include "actor.h"
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double sec() const {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// ---- Ping-pong ----
+struct Player : Actor<int> {
+    std::shared_ptr<Player> peer;
+    std::atomic<int>*       finished = nullptr;
+
+    void receive(int& remaining) override {
+        if (remaining == 0) { finished->fetch_add(1); return; }
+        while (!peer->tell(remaining - 1)) std::this_thread::yield();
+    }
+};
+
+double run_ping_pong(size_t threads, size_t pairs, int hops, size_t batch) {
+    ActorSystem<> system(threads, nullptr, batch);
+    std::atomic<int> finished{0};
+    std::vector<std::shared_ptr<Player>> players;
+
+    for (size_t i = 0; i < pairs; ++i) {
+        auto a = system.spawn<Player>();
+        auto b = system.spawn<Player>();
+        a->peer = b; b->peer = a;
+        a->finished = b->finished = &finished;
+        players.push_back(a);
+        players.push_back(b);
+    }
+
+    Timer t;
+    for (size_t i = 0; i < pairs; ++i) players[2 * i]->tell(hops);
+    system.wait_idle();
+    double elapsed = t.sec();
+
+    for (auto& p : players) p->peer.reset();   // break reference cycles
+    return static_cast<double>(pairs) * (hops + 1) / elapsed;
+}
+
+// ---- Ring ----
+struct RingNode : Actor<int, 256> {
+    std::shared_ptr<RingNode> next;
+
+    void receive(int& laps_left) override {
+        if (laps_left == 0) return;
+        while (!next->tell(laps_left - 1)) std::this_thread::yield();
+    }
+};
+
+double run_ring(size_t threads, size_t nodes, size_t tokens, int hops, size_t batch) {
+    ActorSystem<> system(threads, nullptr, batch);
+    std::vector<std::shared_ptr<RingNode>> ring;
+    for (size_t i = 0; i < nodes; ++i) ring.push_back(system.spawn<RingNode>());
+    for (size_t i = 0; i < nodes; ++i) ring[i]->next = ring[(i + 1) % nodes];
+
+    Timer t;
+    for (size_t k = 0; k < tokens; ++k)
+        ring[(k * nodes) / tokens]->tell(hops);
+    system.wait_idle();
+    double elapsed = t.sec();
+
+    for (auto& n : ring) n->next.reset();
+    return static_cast<double>(tokens) * (hops + 1) / elapsed;
+}
+
+void print_row(const std::string& name, double msgs_per_sec) {
+    std::cout << std::left << std::setw(44) << name
+              << std::right << std::setw(14) << std::fixed << std::setprecision(0)
+              << msgs_per_sec << " msgs/sec\n";
+}
+
+int main() {
+    const size_t THREADS = 4;
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║            ActorSystem message throughput                ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Threads: " << THREADS << "\n\n";
+
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << "PING-PONG — one message in flight per pair\n";
+    std::cout << std::string(70, '-') << "\n";
+    for (size_t pairs : {1, 4, 64})
+        print_row("pairs=" + std::to_string(pairs) + " hops=20000",
+                  run_ping_pong(THREADS, pairs, 20000, 32));
+
+    std::cout << "\n" << std::string(70, '-') << "\n";
+    std::cout << "RING — 1000 actors, 200 tokens, batch size sweep\n";
+    std::cout << std::string(70, '-') << "\n";
+    for (size_t batch : {1, 8, 32, 128})
+        print_row("batch=" + std::to_string(batch),
+                  run_ring(THREADS, 1000, 200, 2000, batch));
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  Ping-pong is bounded by schedule/activate cost (1 msg per activation).\n";
+    std::cout << "  In the ring, bigger batches amortize that cost over several messages\n";
+    std::cout << "  while the actor's state stays in one core's cache.\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * bench_affinity.cpp
+ * ------------------
+ * Cache-sensitive workload: ThreadPoolV3::enqueue vs enqueue_affine.
+ *
+ * Each "tenant" owns a table sized to fit comfortably in one core's L2
+ * but not in all of them at once. Every task performs a burst of random
+ * read-modify-writes on its tenant's table.
+ *
+ *   enqueue()          any worker runs any tenant → tables bounce
+ *                      between cores on every task.
+ *   enqueue_affine()   tenant → home worker → table stays hot.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_affinity.cpp -Iinclude -o bench_affinity
+ * Run:
+ *   ./bench_affinity
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "threadpool_v3.h"
+
+struct Tenant {
+    std::vector<uint64_t> table;
+    explicit Tenant(size_t words) : table(words, 1) {}
+};
+
+// Random RMWs on one tenant's table. Only ever run for a given tenant by
+// one task at a time (tasks for the same tenant are issued in waves).
+static uint64_t touch(Tenant& t, uint64_t seed, int ops) {
+    uint64_t x = seed | 1, acc = 0;
+    const size_t mask = t.table.size() - 1;
+    for (int i = 0; i < ops; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        uint64_t& cell = t.table[x & mask];
+        cell = cell * 6364136223846793005ull + 1;
+        acc += cell;
+    }
+    return acc;
+}
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double sec() const {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+double run(bool affine, size_t threads, size_t tenants, size_t table_words,
+           int waves, int ops, double& hit_rate) {
+    MetricsRegistry registry;
+    ThreadPoolV3<4096> pool(threads, &registry);
+    std::vector<Tenant> data;
+    data.reserve(tenants);
+    for (size_t i = 0; i < tenants; ++i) data.emplace_back(table_words);
+
+    Timer t;
+    for (int w = 0; w < waves; ++w) {
+        // One task per tenant per wave — no two tasks touch the same table
+        // concurrently, so the only difference is WHERE they run.
+        for (size_t k = 0; k < tenants; ++k) {
+            auto task = [&data, k, w, ops] { return touch(data[k], k * 977 + w, ops); };
+            if (affine) pool.enqueue_affine(k, task);
+            else        pool.enqueue(task);
+        }
+        pool.wait_all();
+    }
+    double elapsed = t.sec();
+
+    double hits = static_cast<double>(pool.affinity_hits());
+    double total = hits + static_cast<double>(pool.affinity_steals());
+    hit_rate = total > 0 ? hits / total : 0.0;
+    return static_cast<double>(tenants) * waves / elapsed;
+}
+
+int main() {
+    const size_t THREADS     = 4;
+    const size_t TENANTS     = 16;
+    const size_t TABLE_WORDS = 32 * 1024;   // 256 KB per tenant
+    const int    WAVES       = 200;
+    const int    OPS         = 4000;
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Key-affinity routing — cache-sensitive workload      ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Threads: " << THREADS << " | Tenants: " << TENANTS
+              << " | Table: " << TABLE_WORDS * 8 / 1024 << " KB each\n\n";
+
+    double hr_plain = 0, hr_affine = 0;
+    double plain  = run(false, THREADS, TENANTS, TABLE_WORDS, WAVES, OPS, hr_plain);
+    double affine = run(true,  THREADS, TENANTS, TABLE_WORDS, WAVES, OPS, hr_affine);
+
+    std::cout << std::left << std::setw(26) << "enqueue()"
+              << std::right << std::setw(12) << std::fixed << std::setprecision(0)
+              << plain << " tasks/sec\n";
+    std::cout << std::left << std::setw(26) << "enqueue_affine()"
+              << std::right << std::setw(12) << affine << " tasks/sec"
+              << "   affinity hit rate " << std::setprecision(1) << hr_affine * 100 << "%\n";
+    std::cout << "  → speedup: " << std::setprecision(2) << affine / plain << "x\n\n";
+
+    std::cout << "INSIGHT:\n";
+    std::cout << "  Hits stay high while workers are evenly loaded; steals rise only\n";
+    std::cout << "  when one home worker falls behind — that's the fallback working.\n";
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * bench_arena.cpp
+ * ---------------
+ * Soak test: RSS over time with mixed-size task closures.
+ *
+ * Two producers post closures of 16 B … 3 KB (random mix) to a 4-worker
+ * ThreadPoolV2; one task in eight posts a follow-up from its worker, so
+ * memory is allocated on every thread and freed on a different one.
+ *
+ *   arena   closures go into UniqueTask → inline or Arena blocks
+ *   heap    the same closures wrapped in std::function → malloc/free
+ *
+ * Each mode prints a line per interval: RSS, arena footprint, throughput
+ * and every worker's arena bytes. A healthy allocator goes flat after
+ * warm-up; a fragmenting one keeps climbing.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_arena.cpp -Iinclude -o bench_arena
+ * Run:
+ *   ./bench_arena                # 10-minute soak: 300 s arena, 300 s heap
+ *   ./bench_arena 20 arena       # quick look at one mode
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "threadpool_v2.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double rss_mb() {
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<double>(::sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+static uint64_t next_random() {
+    thread_local uint64_t s = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&s);
+    s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+    return s;
+}
+
+constexpr size_t MAX_IN_FLIGHT = 4096;
+constexpr size_t THREADS       = 4;
+
+struct Soak {
+    ThreadPoolV2<8192>    pool{THREADS};
+    std::atomic<int64_t>  in_flight{0};
+    std::atomic<uint64_t> done{0};
+    std::atomic<uint64_t> checksum{0};
+    bool                  use_arena;
+
+    explicit Soak(bool arena) : use_arena(arena) {}
+
+    template<size_t N>
+    void post_sized(bool may_spawn) {
+        std::array<char, N> blob{};
+        blob[0] = static_cast<char>(N & 0x7F);
+        auto task = [this, blob, may_spawn] {
+            checksum.fetch_add(static_cast<uint64_t>(blob[0]), std::memory_order_relaxed);
+            if (may_spawn && next_random() % 8 == 0) post_random(false);
+            in_flight.fetch_sub(1, std::memory_order_relaxed);
+            done.fetch_add(1, std::memory_order_relaxed);
+        };
+        in_flight.fetch_add(1, std::memory_order_relaxed);
+        if (use_arena) pool.post(std::move(task));
+        else           pool.post(std::function<void()>(std::move(task)));
+    }
+
+    void post_random(bool may_spawn) {
+        switch (next_random() % 6) {
+        case 0: post_sized<16>(may_spawn);   break;
+        case 1: post_sized<64>(may_spawn);   break;
+        case 2: post_sized<200>(may_spawn);  break;
+        case 3: post_sized<700>(may_spawn);  break;
+        case 4: post_sized<1500>(may_spawn); break;
+        default: post_sized<3000>(may_spawn); break;
+        }
+    }
+};
+
+static void run(bool arena, double seconds) {
+    std::cout << std::string(78, '-') << "\n";
+    std::cout << (arena ? "ARENA — UniqueTask + Arena" : "HEAP — std::function + malloc")
+              << " (" << seconds << " s)\n";
+    std::cout << std::string(78, '-') << "\n";
+    std::cout << std::right << std::setw(8) << "t (s)" << std::setw(10) << "RSS MB"
+              << std::setw(14) << "arena KB" << std::setw(14) << "reserved KB"
+              << std::setw(12) << "Mtask/s" << "   worker arena KB\n";
+
+    Soak soak(arena);
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; ++p) {
+        producers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (soak.in_flight.load(std::memory_order_relaxed) > static_cast<int64_t>(MAX_IN_FLIGHT)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                soak.post_random(true);
+            }
+        });
+    }
+
+    const double interval = std::max(1.0, seconds / 20);
+    auto start = Clock::now();
+    uint64_t last_done = 0;
+    for (double t = interval; t <= seconds + 1e-9; t += interval) {
+        std::this_thread::sleep_until(start + std::chrono::duration<double>(t));
+        uint64_t d = soak.done.load();
+        std::cout << std::setw(8) << std::fixed << std::setprecision(0) << t
+                  << std::setw(10) << std::setprecision(1) << rss_mb()
+                  << std::setw(14) << Arena::bytes_in_use() / 1024
+                  << std::setw(14) << Arena::bytes_reserved() / 1024
+                  << std::setw(12) << std::setprecision(2) << (d - last_done) / interval / 1e6
+                  << "  ";
+        for (size_t w = 0; w < THREADS; ++w)
+            std::cout << " " << soak.pool.arena_bytes(w) / 1024;
+        std::cout << "\n";
+        last_done = d;
+    }
+    stop = true;
+    for (auto& p : producers) p.join();
+    soak.pool.wait_all();
+    std::cout << "\n";
+}
+
+int main(int argc, char** argv) {
+    double seconds   = argc > 1 ? std::atof(argv[1]) : 300;
+    std::string mode = argc > 2 ? argv[2] : "both";
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Arena soak — RSS under mixed-size cross-thread frees ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Workers: " << THREADS << " | Producers: 2 | In flight ≤ " << MAX_IN_FLIGHT
+              << " | Closures: 16 B … 3 KB\n\n";
+
+    // Arena first: the heap run can't disturb its numbers (slabs are
+    // never unmapped, so the reverse order would).
+    if (mode != "heap")  run(true, seconds);
+    if (mode != "arena") run(false, seconds);
+
+    std::cout << "INSIGHT:\n";
+    std::cout << "  Arena RSS should flatten once every heap has its working set; the\n";
+    std::cout << "  arena column tracks in-flight closures, not history. Worker columns\n";
+    std::cout << "  show the follow-up tasks each worker allocated and hasn't got back.\n";
+    return 0;
+}
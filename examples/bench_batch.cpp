@@ -0,0 +1,137 @@
+/**
+ * bench_batch.cpp
+ * ---------------
+ * ThreadPoolV2 batch dequeue: sweep PoolOptions::max_batch (K).
+ *
+ * Every task records how long it sat in the queue (post → start), so each
+ * row shows what batching buys (throughput) and what it can cost (tail
+ * queueing delay: a task claimed into a worker's buffer waits for the
+ * tasks ahead of it in that buffer).
+ *
+ *   SATURATED  4 producers flood the pool with empty tasks.
+ *   LIGHT      one producer, one task every ~20µs — K should stay at 1
+ *              and p99 should not move with max_batch.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_batch.cpp -Iinclude -o bench_batch
+ * Run:
+ *   ./bench_batch
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "threadpool_v2.h"
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count());
+}
+
+struct Row {
+    double   tasks_per_sec;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+};
+
+static Row summarize(std::vector<uint64_t>& delays, double seconds) {
+    std::sort(delays.begin(), delays.end());
+    return { delays.size() / seconds,
+             delays[delays.size() / 2],
+             delays[delays.size() * 99 / 100] };
+}
+
+Row run_saturated(size_t threads, size_t max_batch, size_t producers, size_t num_tasks) {
+    PoolOptions opts;
+    opts.max_batch = max_batch;
+    ThreadPoolV2<16384> pool(threads, opts);
+    std::vector<uint64_t> delays(num_tasks);
+
+    auto start = Clock::now();
+    std::vector<std::thread> ps;
+    for (size_t p = 0; p < producers; ++p) {
+        ps.emplace_back([&, p] {
+            for (size_t i = p; i < num_tasks; i += producers) {
+                uint64_t posted = now_ns();
+                pool.post([&delays, i, posted] { delays[i] = now_ns() - posted; });
+            }
+        });
+    }
+    for (auto& t : ps) t.join();
+    pool.wait_all();
+    double sec = std::chrono::duration<double>(Clock::now() - start).count();
+    return summarize(delays, sec);
+}
+
+Row run_light(size_t threads, size_t max_batch, size_t num_tasks) {
+    PoolOptions opts;
+    opts.max_batch = max_batch;
+    ThreadPoolV2<1024> pool(threads, opts);
+    std::vector<uint64_t> delays(num_tasks);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < num_tasks; ++i) {
+        uint64_t posted = now_ns();
+        pool.post([&delays, i, posted] { delays[i] = now_ns() - posted; });
+        auto until = Clock::now() + std::chrono::microseconds(20);
+        while (Clock::now() < until)
+            ;  // pace the producer
+    }
+    pool.wait_all();
+    double sec = std::chrono::duration<double>(Clock::now() - start).count();
+    return summarize(delays, sec);
+}
+
+static void print_row(size_t k, const Row& r) {
+    std::cout << std::left << std::setw(8) << k
+              << std::right << std::setw(16) << std::fixed << std::setprecision(0)
+              << r.tasks_per_sec
+              << std::setw(14) << r.p50_ns / 1000.0
+              << std::setw(14) << std::setprecision(1) << r.p99_ns / 1000.0 << "\n";
+}
+
+int main() {
+    const size_t THREADS   = 4;
+    const size_t PRODUCERS = 4;
+    const size_t NUM_TASKS = 400000;
+    const size_t LIGHT     = 5000;
+    const size_t KS[]      = {1, 2, 4, 8, 16, 32, 64};
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     ThreadPoolV2 batch dequeue — max_batch sweep         ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Threads: " << THREADS << " | Producers: " << PRODUCERS
+              << " | Tasks: " << NUM_TASKS << "\n\n";
+
+    auto header = [] {
+        std::cout << std::left << std::setw(8) << "K"
+                  << std::right << std::setw(16) << "tasks/sec"
+                  << std::setw(14) << "p50 wait µs" << std::setw(14) << "p99 wait µs" << "\n";
+    };
+
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << "SATURATED — empty tasks, producers never pause\n";
+    std::cout << std::string(70, '-') << "\n";
+    header();
+    for (size_t k : KS) print_row(k, run_saturated(THREADS, k, PRODUCERS, NUM_TASKS));
+    std::cout << "\n";
+
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << "LIGHT — one task every ~20µs (batching should stay out of the way)\n";
+    std::cout << std::string(70, '-') << "\n";
+    header();
+    for (size_t k : KS) print_row(k, run_light(THREADS, k, LIGHT));
+    std::cout << "\n";
+
+    std::cout << "INSIGHT:\n";
+    std::cout << "  One CAS per K tasks cuts head_ contention; the adaptive limit only\n";
+    std::cout << "  grows while full batches keep coming, so light load keeps K≈1.\n";
+    return 0;
+}
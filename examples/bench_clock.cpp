@@ -0,0 +1,111 @@
+/**
+ * bench_clock.cpp
+ * ---------------
+ * What one timestamp costs, and how far FastClock wanders from
+ * steady_clock.
+ *
+ *   COST    N threads each take 10M stamps; ns per call per thread.
+ *           steady     std::chrono::steady_clock::now() (vDSO)
+ *           coarse     clock_gettime(CLOCK_MONOTONIC_COARSE): cheap,
+ *                      but only jiffy (1-4 ms) resolution
+ *           FastClock  TSC + seqlock'd scale (see fast_clock.h)
+ *   DRIFT   FastClock − steady_clock, sampled every 500 ms for 5 s:
+ *           the offset stays within calibration error and is steered
+ *           back at each ~1 s recalibration.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_clock.cpp -Iinclude -o bench_clock
+ * Run:
+ *   ./bench_clock
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <time.h>
+#include "fast_clock.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int CALLS = 10000000;
+
+static int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+}
+static int64_t coarse_ns() {
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+template<typename Read>
+double ns_per_call(size_t threads, Read read) {
+    std::atomic<bool> go{false};
+    std::atomic<int64_t> sink{0};
+    std::vector<std::thread> ts;
+    for (size_t t = 0; t < threads; ++t)
+        ts.emplace_back([&] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            int64_t x = 0;
+            for (int i = 0; i < CALLS; ++i) x += read();
+            sink.fetch_add(x, std::memory_order_relaxed);
+        });
+    auto t0 = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : ts) th.join();
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / CALLS;
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Clock cost — steady_clock vs FastClock (TSC)         ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    FastClock::now_ns();   // calibrate outside the timed loops
+    std::cout << "CPUs: " << std::thread::hardware_concurrency()
+              << " | FastClock source: " << (FastClock::uses_tsc() ? "TSC" : "steady_clock (fallback)");
+    if (FastClock::uses_tsc())
+        std::cout << " @ " << std::fixed << std::setprecision(3) << FastClock::ticks_per_ns()
+                  << " ticks/ns";
+    std::cout << "\n\n";
+
+    std::cout << "COST (" << CALLS << " calls per thread; ns per call)\n";
+    std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(10)
+              << "steady" << std::setw(10) << "coarse" << std::setw(12) << "FastClock"
+              << std::setw(10) << "speedup\n";
+    std::cout << std::string(51, '-') << "\n";
+    for (size_t threads : {1, 2, 4, 8}) {
+        double s = ns_per_call(threads, steady_ns);
+        double c = ns_per_call(threads, coarse_ns);
+        double f = ns_per_call(threads, [] { return FastClock::now_ns(); });
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << s << std::setw(10) << c
+                  << std::setw(12) << f << std::setw(9) << s / f << "x\n";
+    }
+
+    std::cout << "\nDRIFT (FastClock − steady_clock, ns)\n";
+    std::cout << std::string(30, '-') << "\n";
+    int64_t worst = 0;
+    for (int i = 0; i <= 10; ++i) {
+        int64_t a = steady_ns(), f = FastClock::now_ns(), b = steady_ns();
+        int64_t off = f - (a + (b - a) / 2);
+        worst = std::max<int64_t>(worst, off < 0 ? -off : off);
+        std::cout << std::setw(6) << std::setprecision(1) << i * 0.5 << " s  "
+                  << std::setw(10) << off << "\n";
+        if (i < 10) std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+    std::cout << "worst |offset|: " << worst << " ns over 5 s\n";
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  steady_clock goes through the vDSO: read the vvar page, the\n";
+    std::cout << "  TSC, a sequence count, then scale. FastClock keeps only the TSC\n";
+    std::cout << "  read and a multiply-shift. Its offset from steady_clock stays\n";
+    std::cout << "  in the µs range: each ~1 s recalibration steers the rate toward\n";
+    std::cout << "  steady_clock instead of stepping. (Under a hypervisor that slows\n";
+    std::cout << "  RDTSC the gap narrows — the TSC read is most of both clocks.)\n";
+    return 0;
+}
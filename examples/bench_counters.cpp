@@ -0,0 +1,131 @@
+/**
+ * bench_counters.cpp
+ * ------------------
+ * What instrumentation costs: sharded Counter vs one shared atomic, and
+ * ThreadPoolV3 (every task bumps ~6 metrics) vs bare ThreadPoolV2.
+ *
+ *   COUNTER   N threads each inc() one shared counter 2M times.
+ *             single   — one std::atomic<uint64_t> (the old Counter)
+ *             sharded  — Counter: fetch_add on the thread's own cell
+ *   POOL      N workers, 4 submitting threads, 400K trivial tasks
+ *             through enqueue(); V2 has no per-task metrics, V3 has
+ *             submitted/completed/active/queue-depth/latency.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_counters.cpp -Iinclude -o bench_counters
+ * Run:
+ *   ./bench_counters
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "threadpool_v3.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t INCS_PER_THREAD = 2000000;
+constexpr size_t   TASKS           = 400000;
+constexpr size_t   SUBMITTERS      = 4;
+
+struct SingleAtomic {
+    std::atomic<uint64_t> v{0};
+    void inc() { v.fetch_add(1, std::memory_order_relaxed); }
+    uint64_t get() const { return v.load(std::memory_order_relaxed); }
+};
+
+struct Sharded {
+    Counter c{"bench_total", "bench"};
+    void inc() { c.inc(); }
+    uint64_t get() const { return c.get(); }
+};
+
+template<typename C>
+double ns_per_inc(size_t threads) {
+    C counter;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> ts;
+    for (size_t t = 0; t < threads; ++t)
+        ts.emplace_back([&] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (uint64_t i = 0; i < INCS_PER_THREAD; ++i) counter.inc();
+        });
+    auto t0 = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : ts) th.join();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    if (counter.get() != INCS_PER_THREAD * threads) std::abort();
+    // Wall time per increment of ONE thread: flat = perfect scaling.
+    return ns / INCS_PER_THREAD;
+}
+
+// M tasks/s through `pool`, submitted from SUBMITTERS threads. Submitters
+// back off while the queues are deep so nobody hits the full-queue path.
+template<typename Pool>
+double pool_rate(Pool& pool) {
+    std::atomic<uint64_t> sink{0};
+    auto t0 = Clock::now();
+    std::vector<std::thread> ts;
+    for (size_t s = 0; s < SUBMITTERS; ++s)
+        ts.emplace_back([&] {
+            for (size_t i = 0; i < TASKS / SUBMITTERS; ++i) {
+                while (pool.queue_depth() > 512) std::this_thread::yield();
+                pool.enqueue([&sink, i] { sink.fetch_add(i, std::memory_order_relaxed); });
+            }
+        });
+    for (auto& th : ts) th.join();
+    pool.wait_all();
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    return TASKS / sec / 1e6;
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Metric hot paths — sharded cells vs shared atomics   ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "CPUs: " << std::thread::hardware_concurrency()
+              << " | cells per counter: " << ShardedAtomic<uint64_t>::shards() << "\n\n";
+
+    const size_t sweep[] = {1, 2, 4, 8, 16, 32, 64};
+
+    std::cout << "COUNTER (" << INCS_PER_THREAD << " inc per thread; ns = wall / incs per thread)\n";
+    std::cout << std::left << std::setw(10) << "threads" << std::right
+              << std::setw(12) << "single ns" << std::setw(12) << "sharded ns"
+              << std::setw(12) << "speedup" << "\n";
+    std::cout << std::string(46, '-') << "\n";
+    for (size_t threads : sweep) {
+        double single  = ns_per_inc<SingleAtomic>(threads);
+        double sharded = ns_per_inc<Sharded>(threads);
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << single << std::setw(12) << sharded
+                  << std::setw(11) << single / sharded << "x\n";
+    }
+
+    std::cout << "\nPOOL (" << TASKS << " tasks, " << SUBMITTERS << " submitters, M tasks/s)\n";
+    std::cout << std::left << std::setw(10) << "workers" << std::right
+              << std::setw(12) << "V2 bare" << std::setw(14) << "V3 metrics"
+              << std::setw(12) << "V3 / V2" << "\n";
+    std::cout << std::string(48, '-') << "\n";
+    for (size_t workers : sweep) {
+        double v2, v3;
+        { ThreadPoolV2<> p(workers); v2 = pool_rate(p); }
+        { ThreadPoolV3<> p(workers); v3 = pool_rate(p); }
+        std::cout << std::left << std::setw(10) << workers << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << v2 << std::setw(14) << v3
+                  << std::setw(11) << v3 / v2 * 100 << "%\n";
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  A shared atomic costs one cache-line transfer per increment once\n";
+    std::cout << "  two cores write it; the sharded Counter keeps each core on its own\n";
+    std::cout << "  line, so per-thread cost stays flat as cores are added. V3 makes\n";
+    std::cout << "  ~6 metric updates per task — with shared atomics that was the\n";
+    std::cout << "  bottleneck past a few cores; sharded, the metrics cost about\n";
+    std::cout << "  what the task bookkeeping itself costs. (On a 1-CPU box there is\n";
+    std::cout << "  one cell and no coherence traffic: both columns match.)\n";
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * bench_emplace.cpp
+ * -----------------
+ * LockFreeQueue enqueue/dequeue styles with a large, non-trivial element.
+ *
+ * Each item is an Order: 392 bytes of id + fields plus a std::string that is
+ * too long for SSO, so every copy allocates and every move still copies
+ * 392 bytes of fields. One producer, one consumer, 1024-slot ring.
+ *
+ *   copy + optional     try_enqueue(order)          / auto o = try_dequeue()
+ *   move + optional     try_enqueue(std::move(o))   / auto o = try_dequeue()
+ *   emplace + out-param try_emplace(args...)        / try_dequeue(order)
+ *   emplace + consume   try_emplace(args...)        / try_consume([](Order&){})
+ *
+ * The copy/move columns are per item, counted in Order's own special
+ * members — they are what the API costs, independent of the machine.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_emplace.cpp -Iinclude -o bench_emplace
+ * Run:
+ *   ./bench_emplace
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "lockfree_queue.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Per-thread counters, summed after the run so counting doesn't add
+// contended atomics to the path being measured.
+thread_local uint64_t tl_copies = 0, tl_moves = 0;
+
+struct Order {
+    uint64_t                 id;
+    std::array<uint64_t, 48> fields;
+    std::string              account;
+
+    Order(uint64_t i, const char* acct) : id(i), account(acct) {
+        for (size_t k = 0; k < fields.size(); ++k) fields[k] = i + k;
+    }
+    Order(const Order& o) : id(o.id), fields(o.fields), account(o.account) { ++tl_copies; }
+    Order(Order&& o) noexcept : id(o.id), fields(o.fields), account(std::move(o.account)) { ++tl_moves; }
+    Order& operator=(Order&& o) noexcept {
+        id = o.id; fields = o.fields; account = std::move(o.account);
+        ++tl_moves;
+        return *this;
+    }
+};
+
+static const char* ACCOUNT = "ACCT-0000-0000-0000-EXAMPLE-LONG-NAME";
+
+static uint64_t digest(const Order& o) { return o.id + o.fields[47] + o.account.size(); }
+
+enum class Mode { CopyOptional, MoveOptional, EmplaceOut, EmplaceConsume };
+
+struct Row { double mitems_per_sec; double copies; double moves; uint64_t sum; };
+
+Row run(Mode mode, uint64_t n) {
+    LockFreeQueue<Order, 1024> q;
+    std::atomic<uint64_t> copies{0}, moves{0}, sum{0};
+
+    std::thread consumer([&] {
+        tl_copies = tl_moves = 0;
+        uint64_t s = 0;
+        Order out(0, "");
+        for (uint64_t got = 0; got < n;) {
+            bool ok = false;
+            switch (mode) {
+            case Mode::CopyOptional:
+            case Mode::MoveOptional:
+                if (auto o = q.try_dequeue()) { s += digest(*o); ok = true; }
+                break;
+            case Mode::EmplaceOut:
+                if (q.try_dequeue(out)) { s += digest(out); ok = true; }
+                break;
+            case Mode::EmplaceConsume:
+                ok = q.try_consume([&s](Order& o) { s += digest(o); });
+                break;
+            }
+            if (ok) ++got;
+            else    std::this_thread::yield();
+        }
+        sum = s;
+        copies += tl_copies;
+        moves  += tl_moves;
+    });
+
+    tl_copies = tl_moves = 0;
+    auto t0 = Clock::now();
+    for (uint64_t i = 0; i < n; ++i) {
+        switch (mode) {
+        case Mode::CopyOptional: {
+            Order o(i, ACCOUNT);
+            while (!q.try_enqueue(o)) std::this_thread::yield();
+            break;
+        }
+        case Mode::MoveOptional: {
+            Order o(i, ACCOUNT);
+            while (!q.try_enqueue(std::move(o))) std::this_thread::yield();
+            break;
+        }
+        case Mode::EmplaceOut:
+        case Mode::EmplaceConsume:
+            while (!q.try_emplace(i, ACCOUNT)) std::this_thread::yield();
+            break;
+        }
+    }
+    consumer.join();
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    copies += tl_copies;
+    moves  += tl_moves;
+    return { n / sec / 1e6, double(copies) / n, double(moves) / n, sum.load() };
+}
+
+int main() {
+    const uint64_t N = 2000000;
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     LockFreeQueue — emplace / consume vs copy / optional ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Items: " << N << " × Order (" << sizeof(Order)
+              << " B, heap-allocated account string) | 1 producer, 1 consumer\n\n";
+
+    std::cout << std::left << std::setw(22) << "mode" << std::right
+              << std::setw(12) << "M items/s" << std::setw(12) << "copies/it"
+              << std::setw(12) << "moves/it" << "\n";
+    std::cout << std::string(58, '-') << "\n";
+
+    struct { Mode m; const char* name; } modes[] = {
+        { Mode::CopyOptional,   "copy + optional" },
+        { Mode::MoveOptional,   "move + optional" },
+        { Mode::EmplaceOut,     "emplace + out-param" },
+        { Mode::EmplaceConsume, "emplace + consume" },
+    };
+    uint64_t ref = 0;
+    for (auto& m : modes) {
+        Row r = run(m.m, N);
+        if (!ref) ref = r.sum;
+        std::cout << std::left << std::setw(22) << m.name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << r.mitems_per_sec
+                  << std::setw(12) << r.copies << std::setw(12) << r.moves;
+        if (r.sum != ref) std::cout << "   CHECKSUM MISMATCH";
+        std::cout << "\n";
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  Slots are raw storage, so an emplaced Order is built where the\n";
+    std::cout << "  consumer will read it, and try_consume() reads it right there:\n";
+    std::cout << "  no default-constructed slot to overwrite, no optional to move\n";
+    std::cout << "  through, and no 400-byte move on either side of the ring.\n";
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * bench_families.cpp
+ * ------------------
+ * Per-observation cost of a labeled metric with 1000 children.
+ *
+ * A CounterFamily with one label ("tenant") and 1000 children. N threads
+ * each make 2M increments, cycling through the tenants. Reported: wall
+ * ns per increment per thread.
+ *
+ *   pinned        Counter* resolved once per tenant, then inc() —
+ *                 the intended hot path
+ *   with_labels   with_labels(tenant)->inc() on every increment:
+ *                 lock-free hash-map lookup + value compare
+ *   mutex map     std::unordered_map<string, Counter*> behind a mutex,
+ *                 looked up on every increment (the naive registry)
+ *   hist pinned   HistogramFamily child resolved once, observe()
+ *
+ * Then: ms to serialize the 1000-child counter family.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_families.cpp -Iinclude -o bench_families
+ * Run:
+ *   ./bench_families
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "metrics.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t CHILDREN       = 1000;
+constexpr size_t OPS_PER_THREAD = 2000000;
+
+template<typename Op>
+double ns_per_op(size_t threads, Op op) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> ts;
+    for (size_t t = 0; t < threads; ++t)
+        ts.emplace_back([&, t] {
+            size_t i = t * 7919;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (size_t k = 0; k < OPS_PER_THREAD; ++k) op((i + k) % CHILDREN);
+        });
+    auto t0 = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : ts) th.join();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    return ns / OPS_PER_THREAD;
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Labeled metrics — 1000 children per family           ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Children: " << CHILDREN << " | " << OPS_PER_THREAD
+              << " ops per thread | CPUs: " << std::thread::hardware_concurrency() << "\n\n";
+
+    std::vector<std::string> tenants;
+    for (size_t i = 0; i < CHILDREN; ++i) tenants.push_back("tenant-" + std::to_string(i));
+
+    std::cout << std::left << std::setw(10) << "threads" << std::right
+              << std::setw(10) << "pinned" << std::setw(14) << "with_labels"
+              << std::setw(12) << "mutex map" << std::setw(14) << "hist pinned"
+              << "    (ns / op / thread)\n";
+    std::cout << std::string(60, '-') << "\n";
+
+    double scrape_ms = 0;
+    for (size_t threads : {1, 2, 4, 8, 16}) {
+        MetricsRegistry reg;
+        CounterFamily*   fam  = reg.add_counter_family("jobs_total", "Jobs", {"tenant"});
+        HistogramFamily* hfam = reg.add_histogram_family("job_seconds", "Job latency", {"tenant"});
+
+        std::vector<Counter*>   pinned;
+        std::vector<Histogram*> hpinned;
+        std::unordered_map<std::string, Counter*> naive;
+        std::mutex naive_mtx;
+        for (const auto& t : tenants) {
+            pinned.push_back(fam->with_labels(t));
+            hpinned.push_back(hfam->with_labels(t));
+            naive.emplace(t, pinned.back());
+        }
+
+        double a = ns_per_op(threads, [&](size_t i) { pinned[i]->inc(); });
+        double b = ns_per_op(threads, [&](size_t i) { fam->with_labels(tenants[i])->inc(); });
+        double c = ns_per_op(threads, [&](size_t i) {
+            Counter* ctr;
+            { std::lock_guard<std::mutex> lk(naive_mtx); ctr = naive.find(tenants[i])->second; }
+            ctr->inc();
+        });
+        double d = ns_per_op(threads, [&](size_t i) { hpinned[i]->observe(0.003); });
+
+        uint64_t total = 0;
+        for (Counter* p : pinned) total += p->get();
+        if (total != 3 * OPS_PER_THREAD * threads || fam->size() != CHILDREN) std::abort();
+
+        auto t0 = Clock::now();
+        std::string page = fam->serialize();
+        scrape_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << a << std::setw(14) << b
+                  << std::setw(12) << c << std::setw(14) << d << "\n";
+    }
+    std::cout << "\nScrape of the " << CHILDREN << "-child counter family: "
+              << std::fixed << std::setprecision(2) << scrape_ms << " ms\n";
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  A pinned child costs what an unlabeled Counter costs — the\n";
+    std::cout << "  label set was resolved once. Looking it up per event adds a\n";
+    std::cout << "  string hash, a lock-free probe and a compare, but no lock, so\n";
+    std::cout << "  it stays flat with threads; the mutex map serializes every\n";
+    std::cout << "  increment on one lock and parks threads once it is contended.\n";
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * bench_hashmap.cpp
+ * -----------------
+ * ConcurrentHashMap vs std::unordered_map behind a lock, 90% reads.
+ *
+ * 100K-key space, half of it preloaded. Each operation picks a random
+ * key: 90% find, 5% insert_or_assign, 5% erase — the mix of a result
+ * cache or an in-flight table. A fixed total of operations is split over
+ * 1 … 64 threads; the table reports millions of operations per second.
+ *
+ *   mutex       std::unordered_map + std::mutex (every op exclusive)
+ *   rwlock      std::unordered_map + std::shared_mutex (finds shared)
+ *   lock-free   ConcurrentHashMap<uint64_t, uint32_t>
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_hashmap.cpp -Iinclude -o bench_hashmap
+ * Run:
+ *   ./bench_hashmap
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "concurrent_hash_map.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t KEY_SPACE = 100000;
+constexpr uint64_t TOTAL_OPS = 8000000;
+
+struct Rng {
+    uint64_t s;
+    uint64_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+};
+
+struct MutexMap {
+    std::mutex m;
+    std::unordered_map<uint64_t, uint32_t> map;
+    bool find(uint64_t k) { std::lock_guard<std::mutex> g(m); return map.count(k) != 0; }
+    void put(uint64_t k, uint32_t v) { std::lock_guard<std::mutex> g(m); map[k] = v; }
+    void erase(uint64_t k) { std::lock_guard<std::mutex> g(m); map.erase(k); }
+};
+
+struct RwLockMap {
+    std::shared_mutex m;
+    std::unordered_map<uint64_t, uint32_t> map;
+    bool find(uint64_t k) { std::shared_lock<std::shared_mutex> g(m); return map.count(k) != 0; }
+    void put(uint64_t k, uint32_t v) { std::unique_lock<std::shared_mutex> g(m); map[k] = v; }
+    void erase(uint64_t k) { std::unique_lock<std::shared_mutex> g(m); map.erase(k); }
+};
+
+struct LockFreeMap {
+    ConcurrentHashMap<uint64_t, uint32_t> map{KEY_SPACE};
+    bool find(uint64_t k) { return map.find(k).has_value(); }
+    void put(uint64_t k, uint32_t v) { map.insert_or_assign(k, v); }
+    void erase(uint64_t k) { map.erase(k); }
+};
+
+template<typename Map>
+double run(size_t threads) {
+    Map m;
+    for (uint64_t k = 0; k < KEY_SPACE; k += 2) m.put(k, static_cast<uint32_t>(k));
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> ts;
+    const uint64_t per_thread = TOTAL_OPS / threads;
+    for (size_t t = 0; t < threads; ++t)
+        ts.emplace_back([&, t] {
+            Rng rng{0x9E3779B97F4A7C15ull * (t + 1)};
+            uint64_t local_hits = 0;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (uint64_t i = 0; i < per_thread; ++i) {
+                uint64_t r = rng.next();
+                uint64_t k = (r >> 8) % KEY_SPACE;
+                uint32_t op = static_cast<uint32_t>(r & 0xFF) % 100;
+                if (op < 90)      local_hits += m.find(k);
+                else if (op < 95) m.put(k, static_cast<uint32_t>(i));
+                else              m.erase(k);
+            }
+            hits.fetch_add(local_hits, std::memory_order_relaxed);
+        });
+
+    auto t0 = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : ts) th.join();
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    return per_thread * threads / sec / 1e6;
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Concurrent map — 90% find / 5% upsert / 5% erase     ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Keys: " << KEY_SPACE << " (half preloaded) | Ops: " << TOTAL_OPS
+              << " total | CPUs: " << std::thread::hardware_concurrency() << "\n\n";
+
+    std::cout << std::left << std::setw(10) << "threads" << std::right
+              << std::setw(12) << "mutex" << std::setw(12) << "rwlock"
+              << std::setw(12) << "lock-free" << std::setw(12) << "vs mutex"
+              << "    (M ops/s)\n";
+    std::cout << std::string(70, '-') << "\n";
+
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        double mu = run<MutexMap>(threads);
+        double rw = run<RwLockMap>(threads);
+        double lf = run<LockFreeMap>(threads);
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << mu << std::setw(12) << rw
+                  << std::setw(12) << lf << std::setw(11) << lf / mu << "x\n";
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  A find() in the lock-free map is a handful of loads plus one\n";
+    std::cout << "  store to the thread's own epoch record — no shared cache line\n";
+    std::cout << "  is written, so readers scale with cores. Both locked maps\n";
+    std::cout << "  write the lock word on every find, even the reader-writer lock.\n";
+    std::cout << "  With fewer cores than threads, lock holders get preempted and\n";
+    std::cout << "  every waiter stalls behind them; the lock-free map never waits.\n";
+    return 0;
+}
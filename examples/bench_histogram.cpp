@@ -0,0 +1,141 @@
+/**
+ * bench_histogram.cpp
+ * -------------------
+ * Histogram::observe() cost under contention, before and after.
+ *
+ * N threads each observe 1M latencies drawn log-uniformly from 10 µs to
+ * 10 s (every bucket of the default layout gets traffic) into ONE shared
+ * histogram. Reported: wall ns per observe per thread — flat means the
+ * histogram scales with cores.
+ *
+ *   legacy      the previous observe(): linear scan bumping every
+ *               cumulative bucket that matches, + a mutex around the sum
+ *   one cell    current observe() with sharded = false: binary search,
+ *               one bucket fetch_add, CAS on the sum — all threads share
+ *               one set of lines
+ *   sharded     current observe(), default: same, in the thread's cell
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_histogram.cpp -Iinclude -o bench_histogram
+ * Run:
+ *   ./bench_histogram
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "metrics.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t OBS_PER_THREAD = 1000000;
+
+// The Histogram::observe() this project shipped before: kept here only
+// as the baseline.
+class LegacyHistogram {
+public:
+    LegacyHistogram()
+        : buckets_(Histogram::default_buckets())
+        , counts_(new std::atomic<uint64_t>[buckets_.size() + 1]) {
+        for (size_t i = 0; i <= buckets_.size(); ++i) counts_[i].store(0);
+    }
+    void observe(double seconds) {
+        for (size_t i = 0; i < buckets_.size(); ++i)
+            if (seconds <= buckets_[i])
+                counts_[i].fetch_add(1, std::memory_order_relaxed);
+        counts_[buckets_.size()].fetch_add(1, std::memory_order_relaxed);
+        { std::lock_guard<std::mutex> lk(sum_mtx_); sum_ += seconds; }
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t count() const { return count_.load(); }
+
+private:
+    std::vector<double>                      buckets_;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    double                                   sum_ = 0;
+    std::mutex                               sum_mtx_;
+    std::atomic<uint64_t>                    count_{0};
+};
+
+struct Rng {
+    uint64_t s;
+    uint64_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+};
+
+// 64K samples, log-uniform over [1e-5, 10] seconds.
+static const std::vector<double>& samples() {
+    static const std::vector<double> v = [] {
+        std::vector<double> out(1 << 16);
+        Rng rng{0x9E3779B97F4A7C15ull};
+        for (double& x : out) {
+            double u = static_cast<double>(rng.next() >> 11) / 9007199254740992.0;
+            x = std::pow(10.0, -5.0 + 6.0 * u);
+        }
+        return out;
+    }();
+    return v;
+}
+
+template<typename H>
+double ns_per_observe(H& h, size_t threads) {
+    const auto& xs = samples();
+    std::atomic<bool> go{false};
+    std::vector<std::thread> ts;
+    for (size_t t = 0; t < threads; ++t)
+        ts.emplace_back([&, t] {
+            size_t i = t * 7919;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (size_t k = 0; k < OBS_PER_THREAD; ++k)
+                h.observe(xs[(i + k) & (xs.size() - 1)]);
+        });
+    auto t0 = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : ts) th.join();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    if (h.count() != OBS_PER_THREAD * threads) std::abort();
+    return ns / OBS_PER_THREAD;
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Histogram::observe() under contention                ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Buckets: " << Histogram::default_buckets().size() << " + Inf | "
+              << OBS_PER_THREAD << " observes per thread | CPUs: "
+              << std::thread::hardware_concurrency() << "\n\n";
+
+    std::cout << std::left << std::setw(10) << "threads" << std::right
+              << std::setw(12) << "legacy" << std::setw(12) << "one cell"
+              << std::setw(12) << "sharded" << std::setw(12) << "speedup"
+              << "    (ns / observe / thread)\n";
+    std::cout << std::string(58, '-') << "\n";
+
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        LegacyHistogram legacy;
+        Histogram one("one", "one cell", Histogram::default_buckets(), false);
+        Histogram sharded("sharded", "sharded");
+        double a = ns_per_observe(legacy, threads);
+        double b = ns_per_observe(one, threads);
+        double c = ns_per_observe(sharded, threads);
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << a << std::setw(12) << b
+                  << std::setw(12) << c << std::setw(11) << a / c << "x\n";
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  The old observe() did up to 10 atomic RMWs (one per matching\n";
+    std::cout << "  cumulative bucket) plus a lock/unlock for the sum — and a mutex\n";
+    std::cout << "  that is contended parks threads in the kernel. Now it is a\n";
+    std::cout << "  4-step branchless search, one fetch_add and one CAS, cumulated\n";
+    std::cout << "  only when /metrics is scraped; sharding keeps those two writes\n";
+    std::cout << "  on a line no other core touches.\n";
+    return 0;
+}
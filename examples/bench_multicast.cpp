@@ -0,0 +1,144 @@
+/**
+ * bench_multicast.cpp
+ * -------------------
+ * MulticastRing throughput, one producer and three consumers (1P-3C):
+ *
+ *   MULTICAST   P ──► C1, C2, C3            (independent, all see all)
+ *   PIPELINE    P ──► C1 ──► C2 ──► C3      (each after the previous)
+ *   DIAMOND     P ──► C1, C2 ──► C3         (C3 after both C1 and C2)
+ *
+ * For comparison, MULTICAST is also done the queue way: the producer
+ * copies every event into three LockFreeQueues.
+ *
+ * Each topology is run with producer claim batches of 1 and 16.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_multicast.cpp -Iinclude -o bench_multicast
+ * Run:
+ *   ./bench_multicast
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "multicast_ring.h"
+#include "lockfree_queue.h"
+
+struct Event {
+    int64_t value = 0;
+    int64_t a = 0, b = 0;
+};
+
+constexpr size_t RING = 4096;
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double sec() const {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+enum class Topology { Multicast, Pipeline, Diamond };
+
+double run_ring(Topology topo, int64_t events, size_t batch, int64_t& checksum) {
+    MulticastRing<Event, RING> ring;
+    auto& c1 = ring.add_consumer();
+    auto& c2 = topo == Topology::Pipeline ? ring.add_consumer({&c1}) : ring.add_consumer();
+    auto& c3 = topo == Topology::Multicast ? ring.add_consumer()
+             : topo == Topology::Pipeline  ? ring.add_consumer({&c2})
+                                           : ring.add_consumer({&c1, &c2});
+
+    std::atomic<int64_t> sum3{0};
+    const int64_t last = events - 1;
+    Timer t;
+    std::thread t1([&] { c1.drain_until(last, [](Event& e, int64_t, bool) { e.a = e.value + 1; }); });
+    std::thread t2([&] { c2.drain_until(last, [](Event& e, int64_t, bool) { e.b = e.value + 2; }); });
+    std::thread t3([&] {
+        int64_t local = 0;
+        c3.drain_until(last, [&](Event& e, int64_t, bool end) {
+            local += e.value;
+            if (end) { sum3.fetch_add(local, std::memory_order_relaxed); local = 0; }
+        });
+    });
+
+    for (int64_t s = 0; s < events; s += static_cast<int64_t>(batch)) {
+        size_t n = static_cast<size_t>(std::min<int64_t>(static_cast<int64_t>(batch), events - s));
+        int64_t first = ring.claim(n);
+        for (int64_t k = first; k < first + static_cast<int64_t>(n); ++k) ring[k].value = k;
+        ring.publish(first, n);
+    }
+    t1.join(); t2.join(); t3.join();
+    double rate = events / t.sec();
+    checksum = sum3.load();
+    return rate;
+}
+
+double run_queues(int64_t events, int64_t& checksum) {
+    std::vector<std::unique_ptr<LockFreeQueue<Event, RING>>> qs;
+    for (int i = 0; i < 3; ++i) qs.push_back(std::make_unique<LockFreeQueue<Event, RING>>());
+
+    std::atomic<int64_t> sum3{0};
+    Timer t;
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < 3; ++i)
+        consumers.emplace_back([&, i] {
+            int64_t local = 0;
+            for (int64_t got = 0; got < events;) {
+                if (auto e = qs[i]->try_dequeue()) { local += e->value; ++got; }
+                else std::this_thread::yield();
+            }
+            if (i == 2) sum3 = local;
+        });
+    for (int64_t s = 0; s < events; ++s) {
+        Event e; e.value = s;
+        for (auto& q : qs)
+            while (!q->try_enqueue(e)) std::this_thread::yield();
+    }
+    for (auto& c : consumers) c.join();
+    double rate = events / t.sec();
+    checksum = sum3.load();
+    return rate;
+}
+
+int main() {
+    const int64_t EVENTS = 2000000;
+    const int64_t EXPECT = EVENTS * (EVENTS - 1) / 2;
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     MulticastRing — 1 producer, 3 consumers              ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Events: " << EVENTS << " | Ring: " << RING << " slots\n\n";
+
+    auto row = [&](const std::string& name, double rate, int64_t checksum) {
+        std::cout << std::left << std::setw(34) << name
+                  << std::right << std::setw(14) << std::fixed << std::setprecision(0)
+                  << rate << " events/sec"
+                  << (checksum == EXPECT ? "  ✓" : "  ✗ CHECKSUM MISMATCH") << "\n";
+    };
+
+    int64_t sum = 0;
+    double rate = run_queues(EVENTS, sum);
+    row("3 LockFreeQueues (copy ×3)", rate, sum);
+    const std::pair<const char*, Topology> topologies[] = {
+        {"multicast", Topology::Multicast},
+        {"pipeline ", Topology::Pipeline},
+        {"diamond  ", Topology::Diamond},
+    };
+    for (const auto& [name, topo] : topologies)
+        for (size_t batch : {1, 16}) {
+            sum  = 0;
+            rate = run_ring(topo, EVENTS, batch, sum);
+            row(std::string("ring ") + name + "  claim(" + std::to_string(batch) + ")", rate, sum);
+        }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  One write per event regardless of consumer count, and consumers that\n";
+    std::cout << "  fall behind catch up a whole batch per cursor store.\n";
+    return 0;
+}
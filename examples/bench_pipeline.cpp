@@ -0,0 +1,154 @@
+/**
+ * bench_pipeline.cpp
+ * ------------------
+ * decode → transform → encode, two ways:
+ *
+ *   CHAINED FUTURES: each stage is a separate ThreadPoolV2::enqueue();
+ *                    the caller waits on stage k before submitting k+1.
+ *   PIPELINE:        one Pipeline with bounded tokens; workers carry each
+ *                    item through the stages while it is cache-hot.
+ *
+ * The encode stage must emit results in input order in both variants.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_pipeline.cpp -Iinclude -o bench_pipeline
+ * Run:
+ *   ./bench_pipeline
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <future>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "pipeline.h"
+#include "threadpool_v2.h"
+
+struct Frame {
+    std::string      raw;
+    std::vector<int> values;
+    uint64_t         checksum = 0;
+};
+
+// ---- The three stages (deliberately memory-touching) ----
+static void decode(Frame& f) {
+    f.values.clear();
+    int cur = 0;
+    for (char c : f.raw) {
+        if (c == ',') { f.values.push_back(cur); cur = 0; }
+        else          { cur = cur * 10 + (c - '0'); }
+    }
+    f.values.push_back(cur);
+}
+
+static void transform(Frame& f) {
+    for (int& v : f.values) v = v * 31 + 7;
+    std::partial_sum(f.values.begin(), f.values.end(), f.values.begin());
+}
+
+static uint64_t encode(const Frame& f) {
+    uint64_t h = 1469598103934665603ull;
+    for (int v : f.values) h = (h ^ static_cast<uint64_t>(v)) * 1099511628211ull;
+    return h;
+}
+
+static std::string make_raw(int i, int fields) {
+    std::string s;
+    for (int k = 0; k < fields; ++k) {
+        if (k) s += ',';
+        s += std::to_string((i * 131 + k * 17) % 100000);
+    }
+    return s;
+}
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double sec() const {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+double run_chained(size_t threads, const std::vector<std::string>& inputs, uint64_t& digest) {
+    ThreadPoolV2<65536> pool(threads);
+    const size_t BATCH = 256;   // same in-flight bound as the pipeline
+    digest = 0;
+
+    Timer t;
+    for (size_t base = 0; base < inputs.size(); base += BATCH) {
+        size_t n = std::min(BATCH, inputs.size() - base);
+        std::vector<std::future<Frame>> stage1, stage2;
+        for (size_t i = 0; i < n; ++i)
+            stage1.push_back(pool.enqueue([&, i] {
+                Frame f; f.raw = inputs[base + i]; decode(f); return f; }));
+        for (auto& fut : stage1)
+            stage2.push_back(pool.enqueue([](Frame f) { transform(f); return f; }, fut.get()));
+        std::vector<std::future<uint64_t>> stage3;
+        for (auto& fut : stage2)
+            stage3.push_back(pool.enqueue([](Frame f) { return encode(f); }, fut.get()));
+        for (auto& fut : stage3) digest ^= fut.get() + (digest << 1);
+    }
+    return inputs.size() / t.sec();
+}
+
+double run_pipeline(size_t threads, const std::vector<std::string>& inputs, uint64_t& digest,
+                    MetricsRegistry& registry) {
+    Pipeline<Frame, 256, 65536> p(threads, &registry, "bench");
+    digest = 0;
+    p.add_parallel_stage("decode", threads, decode)
+     .add_parallel_stage("transform", threads, transform)
+     .add_serial_stage("encode", [&](Frame& f) { digest ^= encode(f) + (digest << 1); });
+
+    Timer t;
+    for (const auto& raw : inputs) {
+        Frame f; f.raw = raw;
+        p.push(std::move(f));
+    }
+    p.wait();
+    double rate = inputs.size() / t.sec();
+
+    for (size_t i = 0; i < p.stage_count(); ++i) {
+        auto s = p.stage_stats(i);
+        std::cout << "    stage " << std::left << std::setw(10) << s.name
+                  << (s.mode == StageMode::Parallel ? " parallel(" + std::to_string(s.degree) + ")"
+                                                    : std::string(" serial-in-order"))
+                  << "  processed=" << s.processed << "\n";
+    }
+    return rate;
+}
+
+int main() {
+    const size_t THREADS = 4;
+    const int    ITEMS   = 100000;
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Pipeline vs chained futures (decode→transform→encode)║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Threads: " << THREADS << " | Items: " << ITEMS << "\n\n";
+
+    for (int fields : {8, 64}) {
+        std::vector<std::string> inputs;
+        inputs.reserve(ITEMS);
+        for (int i = 0; i < ITEMS; ++i) inputs.push_back(make_raw(i, fields));
+
+        std::cout << std::string(70, '-') << "\n";
+        std::cout << "FRAME SIZE: " << fields << " fields\n";
+        std::cout << std::string(70, '-') << "\n";
+
+        uint64_t d1 = 0, d2 = 0;
+        MetricsRegistry registry;
+        double chained  = run_chained(THREADS, inputs, d1);
+        double pipeline = run_pipeline(THREADS, inputs, d2, registry);
+
+        std::cout << std::left << std::setw(30) << "  chained futures"
+                  << std::right << std::setw(14) << std::fixed << std::setprecision(0)
+                  << chained << " items/sec\n";
+        std::cout << std::left << std::setw(30) << "  pipeline"
+                  << std::right << std::setw(14) << pipeline << " items/sec\n";
+        std::cout << "  → speedup: " << std::setprecision(2) << pipeline / chained << "x"
+                  << (d1 == d2 ? "  (outputs identical ✓)" : "  (OUTPUT MISMATCH ✗)") << "\n\n";
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * bench_policy.cpp
+ * ----------------
+ * Per-task cost of each ThreadPoolV3 metrics policy.
+ *
+ * N workers, 4 submitting threads, 400K trivial tasks through enqueue(),
+ * once per policy:
+ *
+ *   None          V3 API, instrumentation compiled out (the baseline)
+ *   CountersOnly  submitted / completed / failed / affinity counters
+ *   Sampled<64>   counters + gauges and latency on 1 task in 64
+ *   Full          counters, gauges and latency on every task: three
+ *                 timestamps → queue wait, execution and end-to-end
+ *   +cpu          WithCpuTime<Full>: Full plus two CLOCK_THREAD_CPUTIME_ID
+ *                 reads per task for threadpool_task_cpu_seconds
+ *
+ * Reported: wall ns per task, and the overhead over None. Each cell is
+ * the best of 3 runs.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_policy.cpp -Iinclude -o bench_policy
+ * Run:
+ *   ./bench_policy
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "threadpool_v3.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t TASKS      = 400000;
+constexpr size_t SUBMITTERS = 4;
+constexpr int    RUNS       = 3;
+
+// ns per task through a fresh pool. Submitters back off while the queue
+// is deep so nobody hits the full-queue path.
+template<typename Policy>
+double ns_per_task(size_t workers) {
+    double best = 1e18;
+    for (int r = 0; r < RUNS; ++r) {
+        MetricsRegistry registry;
+        ThreadPoolV3<4096, Policy> pool(workers, &registry);
+        std::atomic<uint64_t> sink{0};
+        auto t0 = Clock::now();
+        std::vector<std::thread> ts;
+        for (size_t s = 0; s < SUBMITTERS; ++s)
+            ts.emplace_back([&] {
+                for (size_t i = 0; i < TASKS / SUBMITTERS; ++i) {
+                    while (pool.queue_depth() > 2048) std::this_thread::yield();
+                    pool.enqueue([&sink, i] { sink.fetch_add(i, std::memory_order_relaxed); });
+                }
+            });
+        for (auto& th : ts) th.join();
+        pool.wait_all();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        best = std::min(best, ns / TASKS);
+    }
+    return best;
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     ThreadPoolV3 metrics policies — cost per task        ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "CPUs: " << std::thread::hardware_concurrency() << " | " << TASKS
+              << " tasks, " << SUBMITTERS << " submitters, best of " << RUNS << "\n\n";
+
+    std::cout << std::left << std::setw(10) << "workers" << std::right
+              << std::setw(10) << "None" << std::setw(16) << "CountersOnly"
+              << std::setw(16) << "Sampled<64>" << std::setw(16) << "Full"
+              << std::setw(16) << "+cpu" << "    (ns / task, +overhead)\n";
+    std::cout << std::string(84, '-') << "\n";
+
+    for (size_t workers : {1, 2, 4, 8, 16}) {
+        double none     = ns_per_task<metrics_policy::None>(workers);
+        double counters = ns_per_task<metrics_policy::CountersOnly>(workers);
+        double sampled  = ns_per_task<metrics_policy::Sampled<64>>(workers);
+        double full     = ns_per_task<metrics_policy::Full>(workers);
+        double cpu      = ns_per_task<metrics_policy::WithCpuTime<metrics_policy::Full>>(workers);
+        auto cell = [none](double v) {
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(0) << v << " (+" << std::max(0.0, v - none) << ")";
+            return ss.str();
+        };
+        std::cout << std::left << std::setw(10) << workers << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(10) << none
+                  << std::setw(16) << cell(counters) << std::setw(16) << cell(sampled)
+                  << std::setw(16) << cell(full) << std::setw(16) << cell(cpu) << "\n";
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  Full pays three FastClock::now() stamps (queue wait and\n";
+    std::cout << "  execution reuse the end-to-end stamps, so the split costs one),\n";
+    std::cout << "  three HDR records and three queue_depth() reads (head and tail\n";
+    std::cout << "  are the lines every producer and consumer write) on every task.\n";
+    std::cout << "  +cpu adds two thread-CPU clock reads, which are syscalls on most\n";
+    std::cout << "  kernels: worth it while profiling, not by default. CountersOnly\n";
+    std::cout << "  keeps the exact counts for a few sharded increments; Sampled<64>\n";
+    std::cout << "  adds latency and gauges at 1/64 of their cost; None is the V3\n";
+    std::cout << "  API with the instrumentation compiled out.\n";
+    return 0;
+}
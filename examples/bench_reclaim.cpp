@@ -0,0 +1,202 @@
+/**
+ * bench_reclaim.cpp
+ * -----------------
+ * Retire/reclaim throughput and peak unreclaimed memory: Epoch vs Hazard.
+ *
+ * A table of 64 shared slots, each holding a 128-byte node. Writers swap
+ * a fresh node into a random slot and retire the old one; readers pick a
+ * random slot and read its node (Epoch: inside a Guard; Hazard: through
+ * protect()). Half the threads write, half read. Reported per run:
+ *
+ *   retire M/s   nodes retired per second (= allocation churn)
+ *   read M/s     node reads per second
+ *   peak KB      max retired-but-not-freed bytes, sampled every 100 µs
+ *
+ * Second table: the same churn with one reader that takes a Guard /
+ * protects a node and then sleeps for the whole run (a preempted or
+ * blocked reader). EBR garbage grows until the reader wakes; hazard
+ * pointers keep it bounded.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_reclaim.cpp -Iinclude -o bench_reclaim
+ * Run:
+ *   ./bench_reclaim
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "reclaim.h"
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+constexpr size_t   SLOTS    = 64;
+constexpr uint64_t RETIRES  = 2000000;   // total per run, split over writers
+
+struct Node {
+    uint64_t payload[16];   // 128 bytes
+};
+
+struct Rng {
+    uint64_t s;
+    uint64_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+};
+
+struct Result { double retire_mps, read_mps, peak_kb; };
+
+std::atomic<uint64_t> g_sink{0};   // keeps the reads from being optimized away
+
+struct EpochScheme {
+    static uint64_t read(std::atomic<Node*>& slot) {
+        Epoch::Guard g;
+        return slot.load(std::memory_order_acquire)->payload[0];
+    }
+    static void retire(Node* n)  { Epoch::retire(n); }
+    static size_t pending_bytes() { return Epoch::pending_bytes(); }
+    static void drain() { for (int i = 0; i < 8; ++i) Epoch::collect(); }
+
+    // Pins the epoch for `hold`.
+    static void stall(std::atomic<Node*>& slot, std::atomic<bool>& ready,
+                      std::chrono::milliseconds hold) {
+        Epoch::Guard g;
+        (void)slot.load(std::memory_order_acquire);
+        ready = true;
+        std::this_thread::sleep_for(hold);
+    }
+};
+
+struct HazardScheme {
+    static uint64_t read(std::atomic<Node*>& slot) {
+        Hazard::Pointer hp;
+        return hp.protect(slot)->payload[0];
+    }
+    static void retire(Node* n)  { Hazard::retire(n); }
+    static size_t pending_bytes() { return Hazard::pending_bytes(); }
+    static void drain() { Hazard::scan(); }
+
+    static void stall(std::atomic<Node*>& slot, std::atomic<bool>& ready,
+                      std::chrono::milliseconds hold) {
+        Hazard::Pointer hp;
+        (void)hp.protect(slot);
+        ready = true;
+        std::this_thread::sleep_for(hold);
+    }
+};
+
+template<typename Scheme>
+Result run(size_t threads, bool stalled) {
+    std::vector<std::atomic<Node*>> table(SLOTS);
+    for (auto& s : table) s.store(new Node{}, std::memory_order_relaxed);
+
+    const size_t writers = std::max<size_t>(1, threads / 2);
+    const size_t readers = threads - writers;
+    const uint64_t per_writer = RETIRES / writers;
+
+    std::atomic<bool> go{false}, done{false}, stall_ready{!stalled};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<size_t> writers_left{writers};
+    std::vector<std::thread> ts;
+
+    std::thread staller;
+    if (stalled)
+        staller = std::thread([&] { Scheme::stall(table[0], stall_ready, 1500ms); });
+    while (!stall_ready.load()) std::this_thread::yield();
+
+    for (size_t w = 0; w < writers; ++w)
+        ts.emplace_back([&, w] {
+            Rng rng{0x9E3779B97F4A7C15ull * (w + 1)};
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (uint64_t i = 0; i < per_writer; ++i) {
+                Node* fresh = new Node{};
+                fresh->payload[0] = i;
+                Scheme::retire(table[rng.next() % SLOTS].exchange(fresh, std::memory_order_acq_rel));
+            }
+            writers_left.fetch_sub(1);
+        });
+    for (size_t r = 0; r < readers; ++r)
+        ts.emplace_back([&, r] {
+            Rng rng{0xC2B2AE3D27D4EB4Full * (r + 1)};
+            uint64_t n = 0, sink = 0;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            while (!done.load(std::memory_order_relaxed)) {
+                sink += Scheme::read(table[rng.next() % SLOTS]);
+                ++n;
+            }
+            reads.fetch_add(n, std::memory_order_relaxed);
+            g_sink.fetch_add(sink, std::memory_order_relaxed);
+        });
+
+    const size_t baseline = Scheme::pending_bytes();   // leftovers of earlier runs
+    size_t peak = 0;
+    auto t0 = Clock::now();
+    go.store(true, std::memory_order_release);
+    while (writers_left.load() != 0) {
+        size_t now = Scheme::pending_bytes();
+        peak = std::max(peak, now > baseline ? now - baseline : 0);
+        std::this_thread::sleep_for(100us);
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    done = true;
+    for (auto& t : ts) t.join();
+    if (staller.joinable()) staller.join();
+
+    Scheme::drain();
+    for (auto& s : table) delete s.load();
+    return { per_writer * writers / sec / 1e6, readers ? reads.load() / sec / 1e6 : 0.0,
+             peak / 1024.0 };
+}
+
+template<typename Scheme>
+void row(const char* name, size_t threads, bool stalled) {
+    Result r = run<Scheme>(threads, stalled);
+    std::cout << std::left << std::setw(10) << threads << std::setw(8) << name << std::right
+              << std::fixed << std::setprecision(2) << std::setw(12) << r.retire_mps
+              << std::setw(12) << r.read_mps << std::setprecision(0) << std::setw(14)
+              << r.peak_kb << "\n";
+}
+
+void header() {
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(8) << "scheme" << std::right
+              << std::setw(12) << "retire M/s" << std::setw(12) << "read M/s"
+              << std::setw(14) << "peak KB" << "\n";
+    std::cout << std::string(56, '-') << "\n";
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Memory reclamation — Epoch (EBR) vs Hazard pointers  ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Slots: " << SLOTS << " | Node: " << sizeof(Node) << " B | Retires: "
+              << RETIRES << " per run | CPUs: " << std::thread::hardware_concurrency() << "\n\n";
+
+    std::cout << "STEADY CHURN (half writers, half readers)\n";
+    header();
+    for (size_t threads : {2, 4, 8, 16}) {
+        row<EpochScheme>("epoch", threads, false);
+        row<HazardScheme>("hazard", threads, false);
+    }
+
+    std::cout << "\nONE STALLED READER (holds a Guard / hazard for 1.5 s)\n";
+    header();
+    for (size_t threads : {2, 8}) {
+        row<EpochScheme>("epoch", threads, true);
+        row<HazardScheme>("hazard", threads, true);
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  Epoch readers pay one store + fence per Guard; hazard readers\n";
+    std::cout << "  pay a store + fence + re-load per pointer, and writers scan\n";
+    std::cout << "  every thread's slots. EBR frees in whole bags two epochs late,\n";
+    std::cout << "  and any reader descheduled inside a Guard holds the epoch for its\n";
+    std::cout << "  whole timeslice — with more threads than cores that alone keeps\n";
+    std::cout << "  megabytes in flight, and a truly stalled reader pins everything\n";
+    std::cout << "  retired meanwhile. Hazard pointers hold back only the nodes\n";
+    std::cout << "  actually named, so their peak stays flat.\n";
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * bench_scrape.cpp
+ * ----------------
+ * Cost of one /metrics scrape with 10,000 series.
+ *
+ * Global operator new is replaced with a counting version so each row
+ * shows how many heap allocations one scrape costs.
+ *
+ * The registry holds 4000 counters, 2000 gauges, 200 histograms
+ * (9 bounds → 12 series each) and a counter family with 1600 children:
+ * 10,000 series. Rows:
+ *
+ *   ostringstream   the old path: one ostringstream per metric, its
+ *                   string appended to the page's ostringstream
+ *   serialize()     MetricsRegistry::serialize(): fresh MetricsBuffer,
+ *                   copied out to a std::string
+ *   write(reused)   MetricsRegistry::write() into a buffer cleared and
+ *                   reused every scrape — what MetricsServer does
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_scrape.cpp -Iinclude -o bench_scrape
+ * Run:
+ *   ./bench_scrape
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "metrics.h"
+
+// ---- Counting allocator ----
+// GCC can't see that these replacements pair malloc with free.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+static std::atomic<uint64_t> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int COUNTERS = 4000, GAUGES = 2000, HISTOGRAMS = 200, CHILDREN = 1600;
+constexpr int SCRAPES  = 200;
+
+struct Row { double us; double allocs; size_t bytes; };
+
+template<typename Scrape>
+Row measure(Scrape scrape) {
+    size_t bytes = scrape();                       // warm-up (and buffer growth)
+    uint64_t a0 = g_allocs.load();
+    auto t0 = Clock::now();
+    for (int i = 0; i < SCRAPES; ++i) bytes = scrape();
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    return {us / SCRAPES, double(g_allocs.load() - a0) / SCRAPES, bytes};
+}
+
+static void print_row(const std::string& name, const Row& r) {
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed
+              << std::setprecision(0) << std::setw(10) << r.us << " µs"
+              << std::setprecision(1) << std::setw(12) << r.allocs << " allocs"
+              << std::setw(12) << r.bytes << " bytes\n";
+}
+
+// The pre-MetricsBuffer serializer, rebuilt from the public getters.
+struct Legacy {
+    std::vector<std::pair<std::string, Counter*>>   counters;
+    std::vector<std::pair<std::string, Gauge*>>     gauges;
+    std::vector<std::pair<std::string, Histogram*>> histograms;
+    std::vector<double>                             bounds = Histogram::default_buckets();
+    std::vector<std::pair<std::string, Counter*>>   children;   // labels
+
+    std::string serialize() const {
+        std::ostringstream page;
+        for (const auto& [n, c] : counters) {
+            std::ostringstream ss;
+            ss << "# HELP " << n << " help\n# TYPE " << n << " counter\n" << n << " " << c->get() << "\n";
+            page << ss.str() << "\n";
+        }
+        for (const auto& [n, g] : gauges) {
+            std::ostringstream ss;
+            ss << "# HELP " << n << " help\n# TYPE " << n << " gauge\n" << n << " " << g->get() << "\n";
+            page << ss.str() << "\n";
+        }
+        for (const auto& [n, h] : histograms) {
+            std::vector<uint64_t> cum = h->cumulative_counts();
+            std::ostringstream ss;
+            ss << "# HELP " << n << " help\n# TYPE " << n << " histogram\n";
+            for (size_t i = 0; i < bounds.size(); ++i)
+                ss << n << "_bucket{le=\"" << bounds[i] << "\"} " << cum[i] << "\n";
+            ss << n << "_bucket{le=\"+Inf\"} " << cum.back() << "\n"
+               << n << "_sum " << h->sum() << "\n" << n << "_count " << cum.back() << "\n";
+            page << ss.str() << "\n";
+        }
+        std::ostringstream ss;
+        ss << "# HELP jobs_total help\n# TYPE jobs_total counter\n";
+        for (const auto& [labels, c] : children)
+            ss << "jobs_total" << (labels.empty() ? std::string() : "{" + labels + "}")
+               << " " << c->get() << "\n";
+        page << ss.str() << "\n";
+        return page.str();
+    }
+};
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     /metrics scrape — 10,000 series                      ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+
+    MetricsRegistry reg;
+    Legacy legacy;
+    for (int i = 0; i < COUNTERS; ++i) {
+        std::string n = "app_counter_" + std::to_string(i) + "_total";
+        Counter* c = reg.add_counter(n, "help");
+        c->inc(uint64_t(i) * 7919);
+        legacy.counters.emplace_back(n, c);
+    }
+    for (int i = 0; i < GAUGES; ++i) {
+        std::string n = "app_gauge_" + std::to_string(i);
+        Gauge* g = reg.add_gauge(n, "help");
+        g->set(i - 1000);
+        legacy.gauges.emplace_back(n, g);
+    }
+    for (int i = 0; i < HISTOGRAMS; ++i) {
+        std::string n = "app_latency_" + std::to_string(i) + "_seconds";
+        Histogram* h = reg.add_histogram(n, "help");
+        for (int k = 0; k < 100; ++k) h->observe(1e-5 * (k * k + i));
+        legacy.histograms.emplace_back(n, h);
+    }
+    CounterFamily* fam = reg.add_counter_family("jobs_total", "help", {"tenant", "queue"},
+                                                CHILDREN);
+    for (int i = 0; i < CHILDREN; ++i) {
+        std::string t = "tenant-" + std::to_string(i), q = i % 2 ? "bulk" : "interactive";
+        Counter* c = fam->with_labels(t, q);
+        c->inc(uint64_t(i));
+        legacy.children.emplace_back("tenant=\"" + t + "\",queue=\"" + q + "\"", c);
+    }
+    std::cout << "Series: " << COUNTERS + GAUGES + HISTOGRAMS * 12 + CHILDREN
+              << " | " << SCRAPES << " scrapes per row\n\n";
+
+    MetricsBuffer reused;
+    Row old_row = measure([&] { return legacy.serialize().size(); });
+    Row ser_row = measure([&] { return reg.serialize().size(); });
+    Row buf_row = measure([&] { reused.clear(); reg.write(reused); return reused.size(); });
+
+    std::cout << std::left << std::setw(18) << "path" << std::right << std::setw(13)
+              << "per scrape" << std::setw(19) << "heap allocs" << std::setw(18) << "page\n";
+    std::cout << std::string(66, '-') << "\n";
+    print_row("ostringstream", old_row);
+    print_row("serialize()", ser_row);
+    print_row("write(reused)", buf_row);
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  The old path paid an ostringstream (locale, streambuf, string)\n";
+    std::cout << "  per metric plus a copy of every line into the page. Headers and\n";
+    std::cout << "  label strings are now rendered once at registration and numbers\n";
+    std::cout << "  go through to_chars, so a reused buffer scrapes 10K series with\n";
+    std::cout << "  no allocation at all; serialize() pays only buffer growth.\n";
+    return 0;
+}
@@ -0,0 +1,267 @@
+/**
+ * bench_shm.cpp
+ * -------------
+ * Two processes on one host: ShmQueue vs TCP loopback for hand-off.
+ *
+ * The parent plays the TaskServer, a forked child plays a front-end.
+ * Every message is 64 bytes { id, timestamp, 48-byte payload }.
+ *
+ *   stream     child sends N messages as fast as it can; parent receives.
+ *              shm: enqueue(msg) / dequeue(msg)
+ *              tcp: one send() per message (as a front-end would), parent
+ *                   recv()s into a 64 KB buffer
+ *   ping-pong  child echoes each message back; parent measures the round
+ *              trip. shm: a request and a response ShmQueue; tcp: one
+ *              TCP_NODELAY connection.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_shm.cpp -Iinclude -o bench_shm
+ * Run:
+ *   ./bench_shm
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "shm_queue.h"
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+struct Wire {
+    uint64_t id;
+    uint64_t sent_ns;
+    char     payload[48];
+};
+static_assert(sizeof(Wire) == 64);
+
+static uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count());
+}
+
+struct Latency { double mean_us, p50_us, p99_us; };
+
+static Latency summarize(std::vector<double>& us) {
+    std::sort(us.begin(), us.end());
+    double sum = 0;
+    for (double v : us) sum += v;
+    return { sum / us.size(), us[us.size() / 2], us[us.size() * 99 / 100] };
+}
+
+static void reap(pid_t pid) {
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        throw std::runtime_error("child process failed");
+}
+
+// ── Shared memory ─────────────────────────────────────────────
+
+static double shm_stream(uint64_t n) {
+    const std::string name = "/tp_bench_shm_" + std::to_string(::getpid());
+    auto q = ShmQueue<Wire>::create(name, 4096);
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        auto tx = ShmQueue<Wire>::open(name, 4096);
+        Wire w{};
+        for (uint64_t i = 0; i < n; ++i) {
+            w.id = i;
+            if (!tx.enqueue(w, 5s)) ::_exit(1);
+        }
+        ::_exit(0);
+    }
+
+    Wire w{};
+    auto t0 = Clock::now();
+    for (uint64_t i = 0; i < n; ++i)
+        if (!q.dequeue(w, 5s) || w.id != i) throw std::runtime_error("shm stream lost a message");
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    reap(pid);
+    return n / sec / 1e6;
+}
+
+static Latency shm_pingpong(uint64_t n) {
+    const std::string base = "/tp_bench_shm_" + std::to_string(::getpid());
+    auto req  = ShmQueue<Wire>::create(base + "_req", 64);
+    auto resp = ShmQueue<Wire>::create(base + "_resp", 64);
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        auto in  = ShmQueue<Wire>::open(base + "_req");
+        auto out = ShmQueue<Wire>::open(base + "_resp");
+        Wire w{};
+        for (uint64_t i = 0; i < n; ++i)
+            if (!in.dequeue(w, 5s) || !out.enqueue(w, 5s)) ::_exit(1);
+        ::_exit(0);
+    }
+
+    std::vector<double> us;
+    us.reserve(n);
+    Wire w{};
+    for (uint64_t i = 0; i < n; ++i) {
+        w.id = i;
+        w.sent_ns = now_ns();
+        if (!req.enqueue(w, 5s) || !resp.dequeue(w, 5s)) throw std::runtime_error("shm ping-pong stalled");
+        us.push_back((now_ns() - w.sent_ns) / 1e3);
+    }
+    reap(pid);
+    return summarize(us);
+}
+
+// ── TCP loopback ──────────────────────────────────────────────
+
+static void check(bool ok, const char* what) {
+    if (!ok) throw std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+
+static void send_all(int fd, const void* buf, size_t len) {
+    const char* p = static_cast<const char*>(buf);
+    while (len) {
+        ssize_t k = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (k <= 0) ::_exit(2);
+        p += k; len -= static_cast<size_t>(k);
+    }
+}
+
+static bool recv_all(int fd, void* buf, size_t len) {
+    char* p = static_cast<char*>(buf);
+    while (len) {
+        ssize_t k = ::recv(fd, p, len, 0);
+        if (k <= 0) return false;
+        p += k; len -= static_cast<size_t>(k);
+    }
+    return true;
+}
+
+// Forks `child(fd)` connected to the parent over 127.0.0.1; returns the
+// parent's end of the connection.
+template<typename F>
+static int tcp_pair(pid_t& pid, F&& child) {
+    int lfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    check(lfd >= 0, "socket");
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    check(::bind(lfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0, "bind");
+    check(::listen(lfd, 1) == 0, "listen");
+    socklen_t len = sizeof(addr);
+    check(::getsockname(lfd, reinterpret_cast<sockaddr*>(&addr), &len) == 0, "getsockname");
+
+    pid = ::fork();
+    if (pid == 0) {
+        ::close(lfd);
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) ::_exit(3);
+        child(fd);
+        ::close(fd);
+        ::_exit(0);
+    }
+    int fd = ::accept(lfd, nullptr, nullptr);
+    ::close(lfd);
+    check(fd >= 0, "accept");
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static double tcp_stream(uint64_t n) {
+    pid_t pid;
+    int fd = tcp_pair(pid, [n](int s) {
+        Wire w{};
+        for (uint64_t i = 0; i < n; ++i) {
+            w.id = i;
+            send_all(s, &w, sizeof(w));
+        }
+    });
+
+    std::vector<char> buf(64 * 1024);
+    uint64_t bytes = 0, want = n * sizeof(Wire);
+    auto t0 = Clock::now();
+    while (bytes < want) {
+        ssize_t k = ::recv(fd, buf.data(), buf.size(), 0);
+        if (k <= 0) throw std::runtime_error("tcp stream closed early");
+        bytes += static_cast<uint64_t>(k);
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    ::close(fd);
+    reap(pid);
+    return n / sec / 1e6;
+}
+
+static Latency tcp_pingpong(uint64_t n) {
+    pid_t pid;
+    int fd = tcp_pair(pid, [n](int s) {
+        Wire w{};
+        for (uint64_t i = 0; i < n; ++i) {
+            if (!recv_all(s, &w, sizeof(w))) ::_exit(4);
+            send_all(s, &w, sizeof(w));
+        }
+    });
+
+    std::vector<double> us;
+    us.reserve(n);
+    Wire w{};
+    for (uint64_t i = 0; i < n; ++i) {
+        w.id = i;
+        w.sent_ns = now_ns();
+        send_all(fd, &w, sizeof(w));
+        if (!recv_all(fd, &w, sizeof(w))) throw std::runtime_error("tcp ping-pong closed early");
+        us.push_back((now_ns() - w.sent_ns) / 1e3);
+    }
+    ::close(fd);
+    reap(pid);
+    return summarize(us);
+}
+
+int main() {
+    const uint64_t STREAM = 2000000;
+    const uint64_t PINGS  = 50000;
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Cross-process hand-off: ShmQueue vs TCP loopback     ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Two processes (fork) | 64-byte messages | CPUs: "
+              << std::thread::hardware_concurrency() << "\n\n";
+
+    double shm_rate = shm_stream(STREAM);
+    double tcp_rate = tcp_stream(STREAM);
+    std::cout << "STREAM (" << STREAM << " messages, one producer process)\n";
+    std::cout << std::fixed << std::setprecision(2)
+              << "  ShmQueue        " << std::setw(8) << shm_rate << " M msg/s\n"
+              << "  TCP loopback    " << std::setw(8) << tcp_rate << " M msg/s"
+              << "   (shm " << shm_rate / tcp_rate << "x)\n\n";
+
+    Latency shm = shm_pingpong(PINGS);
+    Latency tcp = tcp_pingpong(PINGS);
+    std::cout << "PING-PONG (" << PINGS << " round trips)\n";
+    std::cout << std::left << std::setw(18) << "" << std::right
+              << std::setw(10) << "mean µs" << std::setw(10) << "p50 µs" << std::setw(10) << "p99 µs" << "\n";
+    for (auto [label, l] : { std::pair{"  ShmQueue", shm}, std::pair{"  TCP loopback", tcp} })
+        std::cout << std::left << std::setw(18) << label << std::right << std::setprecision(2)
+                  << std::setw(10) << l.mean_us << std::setw(10) << l.p50_us
+                  << std::setw(10) << l.p99_us << "\n";
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  A shm hand-off is a CAS and a copy into memory both processes map;\n";
+    std::cout << "  the kernel is only involved to park an idle consumer (shared futex).\n";
+    std::cout << "  TCP pays send()/recv() syscalls and the loopback stack per message.\n";
+    std::cout << "  On a single CPU every round trip is a context switch either way, so\n";
+    std::cout << "  ping-pong gaps narrow; with a core per process shm needs none.\n";
+    return 0;
+}
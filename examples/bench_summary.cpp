@@ -0,0 +1,116 @@
+/**
+ * bench_summary.cpp
+ * -----------------
+ * What a latency observation costs in each metric type, and what a
+ * scrape of a Summary costs.
+ *
+ * N threads each observe 1M latencies drawn log-uniformly from 1 µs to
+ * 10 s into ONE shared metric. Reported: wall ns per observe per thread.
+ *
+ *   histogram   Histogram — 9 fixed buckets, sharded cells
+ *   hdr         HdrHistogram — log-linear, 2 significant digits
+ *   summary     Summary — DDSketch α=1%, 1m/5m windows, per-shard buffers
+ *
+ * Then: µs for one Summary::serialize() after the run (drains every
+ * shard buffer and merges the window's slices — the cost moved off the
+ * hot path).
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_summary.cpp -Iinclude -o bench_summary
+ * Run:
+ *   ./bench_summary
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "metrics.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t OBS_PER_THREAD = 1000000;
+
+struct Rng {
+    uint64_t s;
+    uint64_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+};
+
+// 64K samples, log-uniform over [1e-6, 10] seconds.
+static const std::vector<double>& samples() {
+    static const std::vector<double> v = [] {
+        std::vector<double> out(1 << 16);
+        Rng rng{0x9E3779B97F4A7C15ull};
+        for (double& x : out) {
+            double u = static_cast<double>(rng.next() >> 11) / 9007199254740992.0;
+            x = std::pow(10.0, -6.0 + 7.0 * u);
+        }
+        return out;
+    }();
+    return v;
+}
+
+template<typename M>
+double ns_per_observe(M& m, size_t threads) {
+    const auto& xs = samples();
+    std::atomic<bool> go{false};
+    std::vector<std::thread> ts;
+    for (size_t t = 0; t < threads; ++t)
+        ts.emplace_back([&, t] {
+            size_t i = t * 7919;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (size_t k = 0; k < OBS_PER_THREAD; ++k)
+                m.observe(xs[(i + k) & (xs.size() - 1)]);
+        });
+    auto t0 = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : ts) th.join();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    return ns / OBS_PER_THREAD;
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Recording cost — Histogram vs HDR vs Summary         ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << OBS_PER_THREAD << " observes per thread | CPUs: "
+              << std::thread::hardware_concurrency() << "\n\n";
+
+    std::cout << std::left << std::setw(10) << "threads" << std::right
+              << std::setw(12) << "histogram" << std::setw(12) << "hdr"
+              << std::setw(12) << "summary" << std::setw(14) << "scrape µs"
+              << "    (ns / observe / thread)\n";
+    std::cout << std::string(60, '-') << "\n";
+
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        Histogram    hist("h", "h");
+        HdrHistogram hdr("d", "d");
+        Summary      summ("s", "s");
+        double a = ns_per_observe(hist, threads);
+        double b = ns_per_observe(hdr, threads);
+        double c = ns_per_observe(summ, threads);
+
+        auto t0 = Clock::now();
+        std::string page = summ.serialize();
+        double scrape = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        if (summ.count() != OBS_PER_THREAD * threads || page.empty()) std::abort();
+
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << a << std::setw(12) << b
+                  << std::setw(12) << c << std::setprecision(0) << std::setw(14) << scrape
+                  << "\n";
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  Summary's observe() is a buffer append; every 128th call per\n";
+    std::cout << "  thread folds 128 log()s into its shard's own sketches (no lock),\n";
+    std::cout << "  so its average sits above the histograms' single fetch_add. In\n";
+    std::cout << "  return it gives windowed quantiles at 1% over any range in a\n";
+    std::cout << "  few KB per slice, and the scrape — not the request — pays for\n";
+    std::cout << "  merging them, without holding up a single observe().\n";
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * bench_typed.cpp
+ * ---------------
+ * TypedPool<Job, Handler> vs ThreadPoolV2 on the same homogeneous work.
+ *
+ * Every job is { int id; 64-byte buffer }; the handler hashes the buffer
+ * (FNV-1a) and writes the hash to out[id]. One producer submits all jobs,
+ * then waits for the pool to drain.
+ *
+ *   V2 post            lambda capturing the Job → 72-byte UniqueTask
+ *                      closure → arena block + indirect call per task
+ *   V2 post, batch 16  same, with PoolOptions::max_batch = 16
+ *   Typed, batch 1     Job stored in the ring slot, handler called directly
+ *   Typed, batch 16    same, 16 jobs per CAS
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_typed.cpp -Iinclude -o bench_typed
+ * Run:
+ *   ./bench_typed
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "threadpool_v2.h"
+#include "typed_pool.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Job {
+    int                  id = 0;
+    std::array<char, 64> buf{};
+};
+
+struct HashInto {
+    uint64_t* out;
+    void operator()(const Job& j) const {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (char c : j.buf) { h ^= static_cast<unsigned char>(c); h *= 0x100000001b3ull; }
+        out[j.id] = h;
+    }
+};
+
+static Job make_job(int i) {
+    Job j;
+    j.id = i;
+    for (size_t k = 0; k < j.buf.size(); ++k) j.buf[k] = static_cast<char>(i + k);
+    return j;
+}
+
+static uint64_t checksum(const std::vector<uint64_t>& out) {
+    uint64_t s = 0;
+    for (uint64_t v : out) s += v;
+    return s;
+}
+
+struct Row { double mtasks_per_sec; uint64_t sum; };
+
+Row run_v2(size_t threads, size_t max_batch, int n) {
+    std::vector<uint64_t> out(n);
+    PoolOptions opts;
+    opts.max_batch = max_batch;
+    ThreadPoolV2<4096> pool(threads, opts);
+    HashInto handle{out.data()};
+
+    auto t0 = Clock::now();
+    for (int i = 0; i < n; ++i) {
+        Job job = make_job(i);
+        pool.post([handle, job] { handle(job); });
+    }
+    pool.wait_all();
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    return { n / sec / 1e6, checksum(out) };
+}
+
+Row run_typed(size_t threads, size_t max_batch, int n) {
+    std::vector<uint64_t> out(n);
+    TypedPool<Job, HashInto, 4096> pool(threads, HashInto{out.data()}, max_batch);
+
+    auto t0 = Clock::now();
+    for (int i = 0; i < n; ++i) pool.submit(make_job(i));
+    pool.wait_all();
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    return { n / sec / 1e6, checksum(out) };
+}
+
+int main() {
+    const int N = 2000000;
+
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     TypedPool vs ThreadPoolV2 — homogeneous jobs         ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "Jobs: " << N << " × { int id; char buf[64]; } → FNV-1a hash\n\n";
+
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::right << std::setw(14) << "V2 post" << std::setw(14) << "V2 batch16"
+              << std::setw(14) << "Typed b1" << std::setw(14) << "Typed b16"
+              << "    (M jobs/s)\n";
+    std::cout << std::string(70, '-') << "\n";
+
+    for (size_t threads : {1, 2, 4}) {
+        Row v2   = run_v2(threads, 1, N);
+        Row v2b  = run_v2(threads, 16, N);
+        Row ty1  = run_typed(threads, 1, N);
+        Row ty16 = run_typed(threads, 16, N);
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed
+                  << std::setprecision(2)
+                  << std::setw(14) << v2.mtasks_per_sec << std::setw(14) << v2b.mtasks_per_sec
+                  << std::setw(14) << ty1.mtasks_per_sec << std::setw(14) << ty16.mtasks_per_sec;
+        if (v2.sum != ty1.sum || v2.sum != v2b.sum || v2.sum != ty16.sum)
+            std::cout << "   CHECKSUM MISMATCH";
+        std::cout << "\n";
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  With one job type and one handler the pool needs no type erasure:\n";
+    std::cout << "  the job rides in the ring slot and the handler inlines into the\n";
+    std::cout << "  worker loop — no closure box, no indirect call, no allocation.\n";
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * bench_utilization.cpp
+ * ---------------------
+ * What per-worker utilization accounting costs, and what it shows.
+ *
+ *   COST   ThreadPoolV2, 4 submitting threads, 400K trivial post()s,
+ *          PoolOptions::worker_stats off vs on: wall ns per task and
+ *          the difference. Best of 3.
+ *   SHOW   4 Blocking workers fed 20 µs tasks at a paced rate for
+ *          ~0.5 s per row (offered load 10%, 50%, 90% of what the pool
+ *          can run at once: min(workers, CPUs) tasks in parallel);
+ *          worker 0's busy / idle / spin / park split, tasks and
+ *          dequeue retries, the pool's utilization, and one instant
+ *          active_count() read for contrast.
+ *
+ * Compile:
+ *   g++ -std=c++17 -O2 -pthread examples/bench_utilization.cpp -Iinclude -o bench_utilization
+ * Run:
+ *   ./bench_utilization
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "threadpool_v2.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t TASKS      = 400000;
+constexpr size_t SUBMITTERS = 4;
+constexpr int    RUNS       = 3;
+
+double ns_per_task(size_t workers, bool stats) {
+    double best = 1e18;
+    for (int r = 0; r < RUNS; ++r) {
+        PoolOptions opts;
+        opts.worker_stats = stats;
+        ThreadPoolV2<4096> pool(workers, opts);
+        std::atomic<uint64_t> sink{0};
+        auto t0 = Clock::now();
+        std::vector<std::thread> ts;
+        for (size_t s = 0; s < SUBMITTERS; ++s)
+            ts.emplace_back([&] {
+                for (size_t i = 0; i < TASKS / SUBMITTERS; ++i) {
+                    while (pool.queue_depth() > 2048) std::this_thread::yield();
+                    pool.post([&sink, i] { sink.fetch_add(i, std::memory_order_relaxed); });
+                }
+            });
+        for (auto& th : ts) th.join();
+        pool.wait_all();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        best = std::min(best, ns / TASKS);
+    }
+    return best;
+}
+
+static void spin_for(std::chrono::nanoseconds d) {
+    auto end = Clock::now() + d;
+    while (Clock::now() < end) {}
+}
+
+int main() {
+    std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     Worker utilization — cost and breakdown              ║\n";
+    std::cout << "╚══════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "CPUs: " << std::thread::hardware_concurrency() << "\n\n";
+
+    std::cout << "COST (" << TASKS << " tasks, " << SUBMITTERS << " submitters, best of "
+              << RUNS << "; ns per task)\n";
+    std::cout << std::left << std::setw(10) << "workers" << std::right << std::setw(12)
+              << "stats off" << std::setw(12) << "stats on" << std::setw(12) << "delta\n";
+    std::cout << std::string(45, '-') << "\n";
+    for (size_t workers : {1, 2, 4, 8, 16}) {
+        double off = ns_per_task(workers, false);
+        double on  = ns_per_task(workers, true);
+        std::cout << std::left << std::setw(10) << workers << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << off << std::setw(12) << on
+                  << std::setw(11) << std::showpos << on - off << std::noshowpos << "\n";
+    }
+
+    constexpr size_t WORKERS = 4;
+    constexpr auto   TASK    = std::chrono::microseconds(20);
+    std::cout << "\nSHOW (" << WORKERS << " Blocking workers, " << TASK.count()
+              << " µs tasks; worker 0 in ms)\n";
+    std::cout << std::left << std::setw(8) << "load" << std::right << std::setw(8) << "busy"
+              << std::setw(8) << "idle" << std::setw(8) << "spin" << std::setw(8) << "park"
+              << std::setw(8) << "tasks" << std::setw(9) << "retries" << std::setw(8) << "util"
+              << std::setw(9) << "active\n";
+    std::cout << std::string(74, '-') << "\n";
+    for (double load : {0.10, 0.50, 0.90}) {
+        PoolOptions opts;
+        opts.wait_strategy = WaitStrategy::Blocking;
+        ThreadPoolV2<4096> pool(WORKERS, opts);
+        // One task every `gap` keeps `load` of the pool's capacity busy.
+        const double capacity = double(std::min<size_t>(WORKERS, std::max(1u,
+                                    std::thread::hardware_concurrency())));
+        const auto gap = std::chrono::duration_cast<Clock::duration>(TASK / (load * capacity));
+        auto next = Clock::now();
+        const auto end = next + std::chrono::milliseconds(500);
+        size_t active  = 0;
+        bool   sampled = false;
+        while (next < end) {
+            pool.post([TASK] { spin_for(TASK); });
+            next += gap;
+            while (Clock::now() < next) std::this_thread::yield();
+            if (!sampled && Clock::now() > end - std::chrono::milliseconds(250)) {
+                active  = pool.active_count();   // one mid-run sample
+                sampled = true;
+            }
+        }
+        pool.wait_all();
+        WorkerStats::Snapshot s = pool.worker_stats(0);
+        std::cout << std::left << std::setw(8) << std::to_string(int(load * 100)) + "%"
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(8) << s.busy_ns / 1e6 << std::setw(8) << s.idle_ns / 1e6
+                  << std::setw(8) << s.spin_ns / 1e6 << std::setw(8) << s.park_ns / 1e6
+                  << std::setw(8) << s.tasks << std::setw(9) << s.dequeue_retries
+                  << std::setprecision(2) << std::setw(8) << pool.utilization()
+                  << std::setw(8) << active << "\n";
+    }
+
+    std::cout << "\nINSIGHT:\n";
+    std::cout << "  A worker stamps the clock only when it switches between busy and\n";
+    std::cout << "  idle and around each idle round, so a saturated pool pays one add\n";
+    std::cout << "  per task to a line only that worker writes — the delta column is\n";
+    std::cout << "  within run-to-run noise. util is busy / (busy + idle) over all\n";
+    std::cout << "  workers: with a CPU per worker it follows the offered load, with\n";
+    std::cout << "  fewer CPUs it reads about load × CPUs / workers — more workers than\n";
+    std::cout << "  the pool can use. The one active_count() read beside it is 0 or a\n";
+    std::cout << "  few workers depending on when it lands: too noisy to size a pool by.\n";
+    return 0;
+}
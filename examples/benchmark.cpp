@@ -23,6 +23,10 @@
 #include <atomic>
 #include <vector>
 #include <string>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <ctime>
 #include "threadpool.h"
 #include "threadpool_v2.h"
 
@@ -85,6 +89,88 @@ Result run_bench(const std::string& name, Pool& pool, size_t num_tasks, int work
     return { name, elapsed, num_tasks };
 }
 
+// ---- Scaling runner: several producers, fire-and-forget tasks ----
+// No futures here: at 64 threads the per-task packaged_task/shared_ptr
+// would dominate and hide the queue itself.
+template<typename Pool>
+double run_post_bench(Pool& pool, size_t producers, size_t num_tasks) {
+    std::atomic<size_t> done{0};
+    std::vector<std::thread> threads;
+
+    Timer t;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            size_t n = num_tasks / producers + (p < num_tasks % producers ? 1 : 0);
+            for (size_t i = 0; i < n; ++i)
+                pool.post([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        });
+    }
+    for (auto& th : threads) th.join();
+    pool.wait_all();
+    return num_tasks / t.sec();
+}
+
+// ---- Chain runner: each task posts the next hop of its chain ----
+// Models request → reply message passing. Returns mean µs per hop.
+template<typename Pool>
+double run_chain_bench(Pool& pool, size_t chains, size_t hops) {
+    std::atomic<size_t> done{0};
+    std::function<void(size_t)> hop = [&](size_t left) {
+        if (left == 0) { done.fetch_add(1, std::memory_order_relaxed); return; }
+        pool.post([&hop, left] { hop(left - 1); });
+    };
+
+    Timer t;
+    for (size_t c = 0; c < chains; ++c)
+        pool.post([&hop, hops] { hop(hops); });
+    while (done.load(std::memory_order_relaxed) < chains)
+        std::this_thread::yield();
+    pool.wait_all();
+    return t.ms() * 1000.0 / hops;
+}
+
+// ---- Wait-strategy runner: wake latency after idling, idle CPU ----
+struct WaitResult {
+    double   wake_p50_us, wake_p99_us;
+    double   idle_cores;           // CPU-seconds per wall-second while idle
+    uint64_t spins, parks;
+};
+
+static double process_cpu_sec() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+WaitResult run_wait_bench(WaitStrategy ws, size_t threads) {
+    PoolOptions opts;
+    opts.wait_strategy = ws;
+    ThreadPoolV2<1024> pool(threads, opts);
+
+    // Idle CPU: nothing queued for 200ms.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    double cpu0 = process_cpu_sec();
+    Timer idle;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    double idle_cores = (process_cpu_sec() - cpu0) / idle.sec();
+
+    // Wake latency: one task after each 1ms quiet period.
+    std::vector<double> lat;
+    for (int i = 0; i < 200; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        auto posted = std::chrono::steady_clock::now();
+        // Measured inside the task: post → start, not post → get().
+        lat.push_back(pool.enqueue([posted] {
+            return std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - posted).count();
+        }).get());
+    }
+    pool.wait_all();
+    std::sort(lat.begin(), lat.end());
+    return { lat[lat.size() / 2], lat[lat.size() * 99 / 100], idle_cores,
+             pool.total_spins(), pool.total_parks() };
+}
+
 int main() {
     const int  THREADS    = 4;
     const int  NUM_TASKS  = 50000;
@@ -140,6 +226,81 @@ int main() {
         print_speedup(r1, r2);
     }
 
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << "SCENARIO 4: QUEUE MODE SCALING — Global ring vs Sharded (power of two choices)\n";
+    std::cout << "            4 producers, 0µs tasks, post() (no futures)\n";
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::right << std::setw(18) << "global tasks/s"
+              << std::setw(18) << "sharded tasks/s" << std::setw(10) << "ratio" << "\n";
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        double global, sharded;
+        {
+            ThreadPoolV2<16384> pool(threads);
+            global = run_post_bench(pool, 4, NUM_TASKS * 4);
+        }
+        {
+            PoolOptions opts;
+            opts.queue_mode = QueueMode::Sharded;
+            ThreadPoolV2<16384> pool(threads, opts);
+            sharded = run_post_bench(pool, 4, NUM_TASKS * 4);
+        }
+        std::cout << std::left << std::setw(10) << threads
+                  << std::right << std::setw(18) << std::setprecision(0) << global
+                  << std::setw(18) << sharded
+                  << std::setw(9) << std::setprecision(2) << sharded / global << "x\n";
+    }
+    std::cout << "\n";
+
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << "SCENARIO 5: MESSAGE CHAINS — LIFO next-task slot off vs on\n";
+    std::cout << "            Each task posts its successor; mean latency per hop\n";
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << std::left << std::setw(10) << "chains"
+              << std::right << std::setw(16) << "fifo µs/hop"
+              << std::setw(16) << "lifo µs/hop" << std::setw(10) << "ratio" << "\n";
+    for (size_t chains : {1, 8, 64}) {
+        const size_t HOPS = 20000;
+        double fifo, lifo;
+        {
+            ThreadPoolV2<1024> pool(THREADS);
+            fifo = run_chain_bench(pool, chains, HOPS);
+        }
+        {
+            PoolOptions opts;
+            opts.lifo_slot = true;
+            ThreadPoolV2<1024> pool(THREADS, opts);
+            lifo = run_chain_bench(pool, chains, HOPS);
+        }
+        std::cout << std::left << std::setw(10) << chains
+                  << std::right << std::setw(16) << std::setprecision(3) << fifo
+                  << std::setw(16) << lifo
+                  << std::setw(9) << std::setprecision(2) << fifo / lifo << "x\n";
+    }
+    std::cout << "\n";
+
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << "SCENARIO 6: WAIT STRATEGIES — wake latency after 1ms idle, idle CPU\n";
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << std::left << std::setw(10) << "strategy"
+              << std::right << std::setw(14) << "p50 wake µs" << std::setw(14) << "p99 wake µs"
+              << std::setw(12) << "idle cores" << std::setw(14) << "spins" << std::setw(10) << "parks"
+              << "\n";
+    const std::pair<const char*, WaitStrategy> strategies[] = {
+        {"busyspin", WaitStrategy::BusySpin}, {"yielding", WaitStrategy::Yielding},
+        {"sleeping", WaitStrategy::Sleeping}, {"blocking", WaitStrategy::Blocking},
+        {"adaptive", WaitStrategy::Adaptive},
+    };
+    for (const auto& [name, ws] : strategies) {
+        auto r = run_wait_bench(ws, THREADS);
+        std::cout << std::left << std::setw(10) << name
+                  << std::right << std::setprecision(1)
+                  << std::setw(13) << r.wake_p50_us << std::setw(13) << r.wake_p99_us
+                  << std::setw(12) << std::setprecision(2) << r.idle_cores
+                  << std::setw(14) << r.spins << std::setw(10) << r.parks << "\n";
+    }
+    std::cout << "\n";
+
     std::cout << "INSIGHT:\n";
     std::cout << "  High contention → lock-free wins (no context switches)\n";
     std::cout << "  Low  contention → mutex wins or ties (sleeping is free)\n";
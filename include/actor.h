@@ -0,0 +1,431 @@
+#pragma once
+
+/**
+ * actor.h — Lightweight actors scheduled on the lock-free pool
+ * =============================================================
+ *
+ * WHY ACTORS?
+ * -----------
+ * Long-lived stateful entities (sessions, shards, connections) want
+ * "one logical thread each": their state is only ever touched by one
+ * thread at a time, so it needs no locks. Giving each entity a real
+ * std::thread stops scaling at a few thousand (8 MB stack + a kernel
+ * task each). An actor gives the same guarantee for the price of a
+ * mailbox: millions of them share one ThreadPoolV2.
+ *
+ * HOW AN ACTOR IS SCHEDULED:
+ * --------------------------
+ *
+ *   tell(msg) ──► mailbox (bounded MPSC ring)
+ *                     │
+ *                     ▼  scheduled_: false → true  (only one sender wins)
+ *               pool.post(activation)
+ *                     │
+ *                     ▼
+ *   worker: pop up to `batch` messages → receive() each
+ *           scheduled_ = false
+ *           mailbox not empty? re-arm (scheduled_: false → true) and post again
+ *
+ * The scheduled_ flag is the whole trick: an actor is in the pool queue
+ * AT MOST ONCE, so its receive() never runs on two workers at the same
+ * time, and an idle actor costs nothing but memory.
+ *
+ * A FULL POOL QUEUE: with millions of actors, more can be runnable than
+ * the pool's ring holds. schedule() therefore never throws: it makes one
+ * try_post(), and if the ring is full it appends the actor to an
+ * unbounded overflow run queue instead. Every activation ends by taking
+ * overflowed actors (up to `batch` of them) and running them on the same
+ * worker. A drain that leaves actors behind posts another drain, and so
+ * does an overflow push. When such a post fails the ring is full, so a
+ * task still in it will reach the end of its own drain and post again:
+ * while the overflow queue is non-empty, some task in the ring will
+ * drain it.
+ *
+ * BATCHING — fairness vs cache warmth:
+ * ------------------------------------
+ * Each activation processes at most `batch` messages. Larger batches keep
+ * the actor's state hot in one core's cache; smaller batches stop a busy
+ * actor from starving others queued behind it. This is the same knob as
+ * Akka's "throughput" dispatcher setting.
+ *
+ * WHY NOT LockFreeQueue FOR THE MAILBOX?
+ * --------------------------------------
+ * LockFreeQueue pads every slot to a cache line (64 B × capacity), which
+ * is right for one shared pool queue but means gigabytes for a million
+ * actors. The mailbox also has exactly ONE consumer (the activation that
+ * holds scheduled_), so the dequeue side needs no CAS at all. Mailbox
+ * keeps the same sequence-per-slot protocol with compact slots and a
+ * plain consumer cursor.
+ *
+ * USAGE:
+ * ------
+ *   struct Counter : Actor<int> {
+ *       long total = 0;                     // no lock needed
+ *       void receive(int& n) override { total += n; }
+ *   };
+ *
+ *   ActorSystem<> system(4, &registry);
+ *   auto c = system.spawn<Counter>();
+ *   c->tell(5);
+ *   system.wait_idle();
+ */
+
+#include <atomic>
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <cstdint>
+
+#include "threadpool_v2.h"
+#include "metrics.h"
+
+// ─────────────────────────────────────────────────────────────
+// Mailbox — bounded MPSC ring buffer
+//
+// Producers (any thread calling tell()) claim a slot with a CAS on
+// tail_, exactly like LockFreeQueue::try_enqueue. The single consumer
+// owns head_ outright, so try_pop is a load + store with no CAS.
+// ─────────────────────────────────────────────────────────────
+template<typename T, size_t Capacity>
+class Mailbox {
+    static_assert(Capacity >= 2,                   "Capacity must be >= 2");
+    static_assert((Capacity & (Capacity-1)) == 0,  "Capacity must be power of 2");
+
+public:
+    Mailbox() {
+        for (size_t i = 0; i < Capacity; ++i)
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Any thread. Returns false when full (backpressure to the sender).
+    bool try_push(T item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[tail & MASK];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(tail);
+
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(tail, tail + 1,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+                    slot.data = std::move(item);
+                    slot.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                tail = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer only (the running activation). Returns false when empty
+    // or when the next producer has claimed but not yet published.
+    bool try_pop(T& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[head & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+            return false;
+        out = std::move(slot.data);
+        slot.sequence.store(head + Capacity, std::memory_order_release);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate, like LockFreeQueue::size().
+    size_t size() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T                   data{};
+    };
+
+    std::array<Slot, Capacity> slots_;
+    std::atomic<size_t>        head_{0};
+    std::atomic<size_t>        tail_{0};
+};
+
+// ─────────────────────────────────────────────────────────────
+// ActorScheduler — what an actor needs from its runtime.
+// Keeps Actor<Msg> independent of the pool's queue capacity.
+// ─────────────────────────────────────────────────────────────
+class ActorCell;
+
+class ActorScheduler {
+public:
+    virtual ~ActorScheduler() = default;
+    virtual void schedule(std::shared_ptr<ActorCell> cell) = 0;
+};
+
+// Shared by a system and every actor it spawned; the system clears it
+// on destruction, so actors that outlive it see null instead of a
+// dangling scheduler.
+using SchedulerLink = std::shared_ptr<std::atomic<ActorScheduler*>>;
+
+// ─────────────────────────────────────────────────────────────
+// ActorCell — message-type-independent scheduling state
+// ─────────────────────────────────────────────────────────────
+class ActorCell : public std::enable_shared_from_this<ActorCell> {
+public:
+    virtual ~ActorCell() = default;
+
+    /**
+     * activate — run by a pool worker. Processes up to `batch` messages,
+     * then either goes idle or re-arms itself if more mail arrived.
+     * Returns the number of messages processed.
+     */
+    size_t activate(size_t batch) {
+        size_t n = drain(batch);
+
+        // Publish "idle" BEFORE re-checking the mailbox. A sender that
+        // pushed after our last pop either sees scheduled_ == false and
+        // schedules us itself, or we see its message below. seq_cst on
+        // both sides rules out both of us missing each other.
+        scheduled_.store(false, std::memory_order_seq_cst);
+        if (has_mail())
+            try_schedule();
+        return n;
+    }
+
+    virtual size_t mailbox_depth() const = 0;
+
+protected:
+    virtual size_t drain(size_t batch) = 0;
+    virtual bool   has_mail() const = 0;
+
+    // False once the actor's system is gone (or if it never had one).
+    bool attached() const {
+        return scheduler_ && scheduler_->load(std::memory_order_acquire) != nullptr;
+    }
+
+    // Called by tell() after a successful push. If schedule() fails
+    // (out of memory) the flag is dropped again, so the next tell() can
+    // retry instead of finding the actor "scheduled" forever.
+    void try_schedule() {
+        bool expected = false;
+        if (scheduled_.compare_exchange_strong(expected, true,
+                                               std::memory_order_seq_cst)) {
+            ActorScheduler* scheduler =
+                scheduler_ ? scheduler_->load(std::memory_order_acquire) : nullptr;
+            if (!scheduler) {                       // system destroyed
+                scheduled_.store(false, std::memory_order_seq_cst);
+                return;
+            }
+            try {
+                scheduler->schedule(shared_from_this());
+            } catch (...) {
+                scheduled_.store(false, std::memory_order_seq_cst);
+                throw;
+            }
+        }
+    }
+
+private:
+    template<size_t> friend class ActorSystem;
+
+    SchedulerLink     scheduler_;
+    std::atomic<bool> scheduled_{false};
+};
+
+/**
+ * Actor<Msg, MailboxCapacity> — derive from this and override receive().
+ *
+ * receive() is never called concurrently for the same actor, so member
+ * state needs no synchronization. Messages from one sender are received
+ * in the order they were sent.
+ */
+template<typename Msg, size_t MailboxCapacity = 64>
+class Actor : public ActorCell {
+public:
+    using message_type = Msg;
+
+    /**
+     * tell — send a message. Never blocks.
+     * Returns false if the mailbox is full; the caller decides whether
+     * to retry, drop, or push back further upstream. Also false once the
+     * actor's ActorSystem has been destroyed.
+     */
+    bool tell(Msg msg) {
+        if (!attached() || !mailbox_.try_push(std::move(msg)))
+            return false;
+        try_schedule();
+        return true;
+    }
+
+    size_t mailbox_depth() const override { return mailbox_.size(); }
+
+protected:
+    virtual void receive(Msg& msg) = 0;
+
+private:
+    size_t drain(size_t batch) override {
+        size_t n = 0;
+        Msg msg;
+        while (n < batch && mailbox_.try_pop(msg)) {
+            receive(msg);
+            ++n;
+        }
+        return n;
+    }
+
+    bool has_mail() const override { return !mailbox_.empty(); }
+
+    Mailbox<Msg, MailboxCapacity> mailbox_;
+};
+
+/**
+ * ActorSystem — owns the pool that actors are scheduled on.
+ *
+ * Each scheduled actor is ONE post() to the pool — no future, no
+ * packaged_task. Metrics (when a registry is given):
+ *   actor_spawned_total                  actors created
+ *   actor_activations_total              times an actor was run by a worker
+ *   actor_messages_processed_total       receive() calls
+ *   actor_mailbox_depth                  histogram of depth at activation
+ */
+template<size_t QueueCapacity = 65536>
+class ActorSystem : public ActorScheduler {
+public:
+    explicit ActorSystem(size_t num_threads = std::thread::hardware_concurrency(),
+                         MetricsRegistry* registry = nullptr,
+                         size_t batch = 32)
+        : pool_(num_threads), batch_(batch)
+    {
+        if (batch_ == 0)
+            throw std::invalid_argument("ActorSystem: batch must be >= 1");
+
+        if (!registry) {
+            private_registry_ = std::make_unique<MetricsRegistry>();
+            registry = private_registry_.get();
+        }
+
+        spawned_ = registry->add_counter(
+            "actor_spawned_total",
+            "Total number of actors spawned");
+        activations_ = registry->add_counter(
+            "actor_activations_total",
+            "Total number of times an actor was scheduled onto a worker");
+        messages_ = registry->add_counter(
+            "actor_messages_processed_total",
+            "Total number of messages processed by actors");
+        mailbox_depth_ = registry->add_histogram(
+            "actor_mailbox_depth",
+            "Mailbox depth observed at the start of each activation",
+            {1, 2, 4, 8, 16, 32, 64, 128, 256, 1024});
+    }
+
+    /**
+     * spawn — construct an actor bound to this system.
+     * The returned shared_ptr is the actor's address; the system keeps
+     * the actor alive while it has an activation queued or running.
+     * The actor may outlive the system: tell() then returns false. A
+     * tell() racing the system's destructor is not supported.
+     */
+    template<typename A, typename... Args>
+    std::shared_ptr<A> spawn(Args&&... args) {
+        static_assert(std::is_base_of_v<ActorCell, A>,
+                      "ActorSystem::spawn: A must derive from Actor<Msg>");
+        auto actor = std::make_shared<A>(std::forward<Args>(args)...);
+        actor->scheduler_ = link_;
+        spawned_->inc();
+        return actor;
+    }
+
+    /**
+     * wait_idle — block until no actor has mail queued or running.
+     * Activations re-arm themselves from inside pool tasks, so once the
+     * pool is drained no further activations can appear on their own.
+     */
+    void wait_idle() {
+        pool_.wait_all();
+        // The drain tasks re-post themselves, so this only helps a
+        // waiter along; it is not needed for progress.
+        while (overflowed_.load(std::memory_order_seq_cst) != 0) {
+            drain_overflow();
+            pool_.wait_all();
+        }
+    }
+
+    size_t batch()          const { return batch_; }
+    size_t thread_count()   const { return pool_.thread_count(); }
+    uint64_t activations()  const { return activations_->get(); }
+    uint64_t messages_processed() const { return messages_->get(); }
+
+    ~ActorSystem() override {
+        wait_idle();
+        link_->store(nullptr, std::memory_order_release);
+    }
+
+    ActorSystem(const ActorSystem&) = delete;
+    ActorSystem& operator=(const ActorSystem&) = delete;
+
+private:
+    // Never throws on a full pool (see A FULL POOL QUEUE): a throw here
+    // would strand the actor with scheduled_ set, or terminate a worker.
+    void schedule(std::shared_ptr<ActorCell> cell) override {
+        if (pool_.try_post([this, cell] { run(*cell); drain_overflow(); }))
+            return;
+        {
+            std::lock_guard<std::mutex> lk(overflow_mtx_);
+            overflow_.push_back(std::move(cell));
+        }
+        overflowed_.fetch_add(1, std::memory_order_seq_cst);
+        (void)pool_.try_post([this] { drain_overflow(); });
+    }
+
+    void run(ActorCell& cell) {
+        mailbox_depth_->observe(static_cast<double>(cell.mailbox_depth()));
+        size_t n = cell.activate(batch_);
+        activations_->inc();
+        messages_->inc(n);
+    }
+
+    // Run up to batch_ overflowed actors on this worker, then hand the
+    // rest to another drain task. One atomic load when there are none.
+    void drain_overflow() {
+        for (size_t i = 0; i < batch_; ++i) {
+            if (overflowed_.load(std::memory_order_seq_cst) == 0) return;
+            std::shared_ptr<ActorCell> cell;
+            {
+                std::lock_guard<std::mutex> lk(overflow_mtx_);
+                if (overflow_.empty()) return;   // taken by a drain that is still running it
+                cell = std::move(overflow_.front());
+                overflow_.pop_front();
+            }
+            run(*cell);
+            overflowed_.fetch_sub(1, std::memory_order_seq_cst);
+        }
+        if (overflowed_.load(std::memory_order_seq_cst) != 0)
+            (void)pool_.try_post([this] { drain_overflow(); });
+    }
+
+    ThreadPoolV2<QueueCapacity>      pool_;
+    size_t                           batch_;
+    SchedulerLink                    link_ = std::make_shared<std::atomic<ActorScheduler*>>(this);
+
+    // Runnable actors that found the pool ring full (see A FULL POOL QUEUE).
+    std::mutex                             overflow_mtx_;
+    std::deque<std::shared_ptr<ActorCell>> overflow_;
+    std::atomic<size_t>                    overflowed_{0};   // pushed, not yet run
+    std::unique_ptr<MetricsRegistry> private_registry_;
+
+    Counter*   spawned_{nullptr};
+    Counter*   activations_{nullptr};
+    Counter*   messages_{nullptr};
+    Histogram* mailbox_depth_{nullptr};
+};
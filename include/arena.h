@@ -0,0 +1,368 @@
+#pragma once
+
+/**
+ * arena.h — Per-thread slab allocator with remote-free queues
+ * ============================================================
+ *
+ * THE PROBLEM:
+ * ------------
+ * A task's closure is allocated by the thread that submits it and freed
+ * by the worker that runs it. Every one of those frees is a CROSS-THREAD
+ * free: glibc malloc sends the block back to the producer's arena under
+ * that arena's lock, or strands it in the worker's tcache where the
+ * producer never sees it again. Under a steady stream of mixed-size
+ * closures the heap fragments and RSS creeps up for hours.
+ *
+ * THE DESIGN (same shape as mimalloc / snmalloc, minus the generality):
+ * ----------------------------------------------------------------------
+ *
+ *   thread A's Heap                          thread B (a worker)
+ *   ┌───────────────────────────────┐
+ *   │ free[32B]  → □ → □            │ ◄── A allocates / frees: plain
+ *   │ free[64B]  → □                │     pointer pushes, no atomics
+ *   │ ...                           │
+ *   │ free[4K]   → (empty)          │
+ *   │ bump slab: [used....|free...] │
+ *   │                               │      B frees a block A allocated:
+ *   │ remote ─► □ ─► □ ─► □   ◄─────┼───── one CAS push (MPSC stack)
+ *   └───────────────────────────────┘
+ *
+ *   • Every block carries a 16-byte header naming its OWNING heap and its
+ *     size class, so deallocate() needs no lookup and no size argument.
+ *   • The owner frees locally; anyone else pushes onto the owner's
+ *     `remote` stack. The owner takes the whole stack with ONE exchange
+ *     when a free list runs dry — no ABA, because it never pops singly.
+ *   • Blocks are carved from 64 KB slabs. Slabs are never returned to
+ *     the OS: a task system's working set is its steady state, and keeping
+ *     it is exactly what flattens the RSS curve.
+ *   • Size classes are powers of two from 32 B to 4 KB (header included).
+ *     Bigger requests go straight to operator new.
+ *
+ * THREAD EXIT:
+ * ------------
+ * Blocks routinely outlive the thread that allocated them, so heaps are
+ * never destroyed. A thread's heap is ABANDONED when it exits (remote
+ * frees keep landing on it) and ADOPTED by the next thread that needs
+ * one, which drains its remote stack. The number of heaps is bounded by
+ * the peak number of live threads.
+ *
+ * PUBLIC HOOKS:
+ * -------------
+ *   Arena::allocate(n) / Arena::deallocate(p)    raw blocks (16-aligned)
+ *   ArenaAllocator<T>                             std-style allocator:
+ *       std::allocate_shared<T>(ArenaAllocator<T>{}, ...)
+ *       std::promise<R>(std::allocator_arg, ArenaAllocator<R>{})
+ *       std::vector<T, ArenaAllocator<T>>
+ *   Arena::local_heap().bytes_in_use()            this thread's footprint
+ *   Arena::bytes_in_use() / bytes_reserved()      process-wide totals
+ *
+ * UniqueTask (unique_task.h) — the pools' task type — stores any closure
+ * too big for its inline buffer here.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+class Arena {
+    struct Block;
+
+public:
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t SLAB_SIZE   = 64 * 1024;
+    static constexpr size_t NUM_CLASSES = 27;                      // 32 B … 4 KB blocks
+    static constexpr size_t MAX_SMALL   = 4096 - HEADER_SIZE;
+
+    class Heap {
+    public:
+        // Bytes in blocks handed out by this heap and not yet back on its
+        // free lists (remote frees count once the owner has drained them).
+        size_t   bytes_in_use()   const { return in_use_.load(std::memory_order_relaxed); }
+        // Slab memory this heap has taken from the system.
+        size_t   bytes_reserved() const { return reserved_.load(std::memory_order_relaxed); }
+        // Blocks that came back through the remote-free stack.
+        uint64_t remote_frees()   const { return remote_drained_.load(std::memory_order_relaxed); }
+
+    private:
+        friend class Arena;
+
+        void* alloc(size_t cls);
+        void  free_local(Block* b);
+        void  free_remote(Block* b);
+        void  drain_remote();
+        Block* carve(size_t cls);
+
+        void add_in_use(size_t delta, bool up) {
+            size_t v = in_use_.load(std::memory_order_relaxed);
+            in_use_.store(up ? v + delta : v - delta, std::memory_order_relaxed);
+        }
+
+        Block* free_[NUM_CLASSES] = {};
+        char*  bump_     = nullptr;
+        char*  bump_end_ = nullptr;
+
+        // Counters have a single writer (the current owner) and are read
+        // by anyone, hence atomics with relaxed load+store, not fetch_add.
+        std::atomic<size_t>   in_use_{0};
+        std::atomic<size_t>   reserved_{0};
+        std::atomic<uint64_t> remote_drained_{0};
+
+        Heap* next_all_       = nullptr;   // registry of every heap
+        Heap* next_abandoned_ = nullptr;
+
+        // Written by every other thread — keep it off the owner's line.
+        alignas(64) std::atomic<Block*> remote_{nullptr};
+    };
+
+    // Allocate `size` bytes, 16-byte aligned. Never returns nullptr.
+    static void* allocate(size_t size) {
+        Heap* h = size <= MAX_SMALL ? current_heap() : nullptr;
+        return h ? h->alloc(class_of(size)) : allocate_large(size);
+    }
+
+    // Free a block from allocate(), on any thread.
+    static void deallocate(void* p) noexcept {
+        if (!p) return;
+        Block* b = reinterpret_cast<Block*>(static_cast<char*>(p) - HEADER_SIZE);
+        if (b->cls == LARGE) {
+            global().large_bytes.fetch_sub(b->large_size, std::memory_order_relaxed);
+            ::operator delete(b);
+            return;
+        }
+        Heap* owner = b->owner;
+        if (owner == tls_heap_) owner->free_local(b);
+        else                    owner->free_remote(b);
+    }
+
+    // The calling thread's heap (adopted or created on first use).
+    // Not available from thread_local destructors that run after the
+    // heap has been abandoned — allocate() falls back to operator new there.
+    static Heap& local_heap() { return *current_heap(); }
+
+    // Process-wide totals (walks every heap; not for hot paths).
+    static size_t bytes_in_use() {
+        Global& g = global();
+        std::lock_guard<std::mutex> lk(g.mtx);
+        size_t total = g.large_bytes.load(std::memory_order_relaxed);
+        for (Heap* h = g.all; h; h = h->next_all_) total += h->bytes_in_use();
+        return total;
+    }
+    static size_t bytes_reserved() {
+        Global& g = global();
+        std::lock_guard<std::mutex> lk(g.mtx);
+        size_t total = g.large_bytes.load(std::memory_order_relaxed);
+        for (Heap* h = g.all; h; h = h->next_all_) total += h->bytes_reserved();
+        return total;
+    }
+    static size_t heap_count() {
+        Global& g = global();
+        std::lock_guard<std::mutex> lk(g.mtx);
+        size_t n = 0;
+        for (Heap* h = g.all; h; h = h->next_all_) ++n;
+        return n;
+    }
+
+    // 32, 48 … 128 in 16-byte steps, then four steps per doubling:
+    // 160, 192, 224, 256, 320, 384 … 3584, 4096.
+    static constexpr size_t block_size(size_t cls) {
+        if (cls <= 6) return 32 + 16 * cls;
+        size_t k = cls - 7, e = 7 + k / 4;
+        return (size_t{1} << e) + (k % 4 + 1) * (size_t{1} << (e - 2));
+    }
+
+private:
+    static constexpr uint32_t LARGE = 0xFFFFFFFFu;
+
+    // Sits in front of every block. While a block is free the owner
+    // field is reused as the free-list link; cls survives, so a drained
+    // remote block can be filed under the right class.
+    struct alignas(16) Block {
+        union {
+            Heap*  owner;
+            Block* next;
+            size_t large_size;   // LARGE blocks: bytes including header
+        };
+        uint32_t cls;
+        uint32_t unused_;
+    };
+    static_assert(sizeof(Block) == HEADER_SIZE, "header must keep payloads 16-aligned");
+
+    static size_t class_of(size_t size) {
+        size_t need = size + HEADER_SIZE;
+        if (need <= 128) return need <= 32 ? 0 : (need + 15) / 16 - 2;
+        size_t e    = static_cast<size_t>(63 - __builtin_clzll(need - 1));
+        size_t step = size_t{1} << (e - 2);
+        return 7 + (e - 7) * 4 + (need - (size_t{1} << e) + step - 1) / step - 1;
+    }
+
+    static void* allocate_large(size_t size) {
+        Block* b = static_cast<Block*>(::operator new(size + HEADER_SIZE));
+        b->large_size = size + HEADER_SIZE;
+        b->cls        = LARGE;
+        global().large_bytes.fetch_add(b->large_size, std::memory_order_relaxed);
+        return reinterpret_cast<char*>(b) + HEADER_SIZE;
+    }
+
+    // Heaps and the registry are deliberately never destroyed: blocks
+    // can be freed from static destructors and exiting threads.
+    struct Global {
+        std::mutex          mtx;
+        Heap*               all       = nullptr;
+        Heap*               abandoned = nullptr;
+        std::atomic<size_t> large_bytes{0};
+    };
+    static Global& global() {
+        static Global* g = new Global;
+        return *g;
+    }
+
+    // Ties a heap to a thread for the thread's lifetime.
+    struct Lease {
+        Lease() {
+            Global& g = global();
+            Heap* h;
+            {
+                std::lock_guard<std::mutex> lk(g.mtx);
+                if ((h = g.abandoned)) {
+                    g.abandoned = h->next_abandoned_;
+                } else {
+                    h = new Heap;
+                    h->next_all_ = g.all;
+                    g.all = h;
+                }
+            }
+            h->drain_remote();
+            tls_heap_ = h;
+        }
+        ~Lease() {
+            Heap* h = tls_heap_;
+            // From here on this thread's frees go through the remote
+            // stack like everyone else's.
+            tls_heap_   = nullptr;
+            tls_exited_ = true;
+            Global& g = global();
+            std::lock_guard<std::mutex> lk(g.mtx);
+            h->next_abandoned_ = g.abandoned;
+            g.abandoned = h;
+        }
+    };
+
+    static Heap* current_heap() {
+        if (tls_heap_)   return tls_heap_;
+        if (tls_exited_) return nullptr;
+        thread_local Lease lease;
+        return tls_heap_;
+    }
+
+    static inline thread_local Heap* tls_heap_   = nullptr;
+    static inline thread_local bool  tls_exited_ = false;
+};
+
+// ---- Heap internals ----
+
+inline void* Arena::Heap::alloc(size_t cls) {
+    drain_remote();
+    Block* b = free_[cls];
+    if (b) free_[cls] = b->next;
+    else   b = carve(cls);
+    b->owner = this;
+    b->cls   = static_cast<uint32_t>(cls);
+    add_in_use(block_size(cls), true);
+    return reinterpret_cast<char*>(b) + HEADER_SIZE;
+}
+
+inline void Arena::Heap::free_local(Block* b) {
+    b->next = free_[b->cls];
+    free_[b->cls] = b;
+    add_in_use(block_size(b->cls), false);
+}
+
+inline void Arena::Heap::free_remote(Block* b) {
+    Block* head = remote_.load(std::memory_order_relaxed);
+    do { b->next = head; }
+    while (!remote_.compare_exchange_weak(head, b,
+               std::memory_order_release, std::memory_order_relaxed));
+}
+
+inline void Arena::Heap::drain_remote() {
+    if (!remote_.load(std::memory_order_relaxed)) return;
+    Block* b = remote_.exchange(nullptr, std::memory_order_acquire);
+    // The stack is newest-first; reverse it so that, after pushing onto
+    // the free lists, the most recently freed (cache-warm) blocks are on top.
+    Block* oldest_first = nullptr;
+    while (b) {
+        Block* next = b->next;
+        b->next = oldest_first;
+        oldest_first = b;
+        b = next;
+    }
+    size_t   bytes = 0;
+    uint64_t n     = 0;
+    for (b = oldest_first; b;) {
+        Block* next = b->next;
+        b->next = free_[b->cls];
+        free_[b->cls] = b;
+        bytes += block_size(b->cls);
+        ++n;
+        b = next;
+    }
+    add_in_use(bytes, false);
+    remote_drained_.store(remote_drained_.load(std::memory_order_relaxed) + n,
+                          std::memory_order_relaxed);
+}
+
+inline Arena::Block* Arena::Heap::carve(size_t cls) {
+    const size_t bs = block_size(cls);
+    if (static_cast<size_t>(bump_end_ - bump_) < bs) {
+        // File the old slab's tail under the largest classes that fit
+        // rather than wasting it.
+        for (size_t c = NUM_CLASSES; c-- > 0;) {
+            while (static_cast<size_t>(bump_end_ - bump_) >= block_size(c)) {
+                Block* t = reinterpret_cast<Block*>(bump_);
+                t->cls  = static_cast<uint32_t>(c);
+                t->next = free_[c];
+                free_[c] = t;
+                bump_ += block_size(c);
+            }
+        }
+        bump_     = static_cast<char*>(::operator new(SLAB_SIZE));
+        bump_end_ = bump_ + SLAB_SIZE;
+        reserved_.store(reserved_.load(std::memory_order_relaxed) + SLAB_SIZE,
+                        std::memory_order_relaxed);
+    }
+    Block* b = reinterpret_cast<Block*>(bump_);
+    bump_ += bs;
+    return b;
+}
+
+/**
+ * ArenaAllocator — std-compatible allocator backed by Arena. Stateless,
+ * so any two instances compare equal and memory can be freed through
+ * any of them, on any thread. Over-aligned types bypass the arena.
+ */
+template<typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    ArenaAllocator() noexcept = default;
+    template<typename U> ArenaAllocator(const ArenaAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        if constexpr (alignof(T) > Arena::HEADER_SIZE)
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        else
+            return static_cast<T*>(Arena::allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t) noexcept {
+        if constexpr (alignof(T) > Arena::HEADER_SIZE)
+            ::operator delete(p, std::align_val_t(alignof(T)));
+        else
+            Arena::deallocate(p);
+    }
+
+    template<typename U> bool operator==(const ArenaAllocator<U>&) const noexcept { return true; }
+    template<typename U> bool operator!=(const ArenaAllocator<U>&) const noexcept { return false; }
+};
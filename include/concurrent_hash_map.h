@@ -0,0 +1,400 @@
+#pragma once
+
+/**
+ * concurrent_hash_map.h — Lock-free open-addressing hash map
+ * ==========================================================
+ *
+ * THE PROBLEM:
+ * ------------
+ * Result caches, in-flight request coalescing and labeled-metric lookup
+ * all need a map shared by every worker. std::unordered_map behind a
+ * mutex puts back exactly the lock this project removed from the queues:
+ * a 90%-read workload still serializes on every find().
+ *
+ * LAYOUT — one flat array, linear probing:
+ * ----------------------------------------
+ *
+ *   bucket = { atomic<u64> key, atomic<u64> value }    16 bytes, 4 per line
+ *
+ *   find(k):  i = mix(hash(k)) & mask;  walk i, i+1, i+2 ... until the key
+ *             or an EMPTY key. Loads only — readers never write a bucket.
+ *   insert:   CAS an EMPTY key word to k (a key, once claimed, stays in its
+ *             bucket for the table's lifetime), then CAS the value word.
+ *   erase:    CAS the value word to ERASED. The key stays as a tombstone
+ *             so probe chains through it remain intact.
+ *
+ * Keys and values live INSIDE the atomic words, so there is nothing to
+ * allocate or free per entry. That limits the types:
+ *   K — trivially copyable, ≤ 8 bytes, unique object representation
+ *       (compared bitwise). For 8-byte keys the all-ones pattern is
+ *       reserved (insert throws std::invalid_argument).
+ *   V — trivially copyable and ≤ 4 bytes (an index, an id, a small count)
+ *       OR a pointer to something aligned to ≥ 4 bytes. Larger values:
+ *       store them elsewhere and map to the index or pointer.
+ *
+ * VALUE WORD STATES — a 2-bit tag beside the payload:
+ *
+ *   LIVE v ──erase──► ERASED ──insert──► LIVE v'      normal operation
+ *   LIVE v ──freeze─► FROZEN v ──► MOVED             resize (see below)
+ *   EMPTY / ERASED ──────────────► MOVED              nothing to copy
+ *
+ *   small V: [ tag : 2 ][ payload : 32 ]    (tag in bits 32–33)
+ *   pointer: [ pointer bits ... | tag : 2 ]  (alignment frees the low bits)
+ *
+ * RESIZE BY INCREMENTAL MIGRATION (Cliff Click's scheme, simplified):
+ * -------------------------------------------------------------------
+ * When claimed keys pass 3/4 of the table (or a probe runs past the
+ * reprobe limit), a new table is hung off the old one's `next` — twice
+ * the size, or the same size if the old one is mostly tombstones. Then
+ * every bucket moves in three steps:
+ *
+ *   1. FREEZE   CAS value v → FROZEN v. From here on no write to the old
+ *               bucket can succeed, so every copier copies the same v.
+ *   2. COPY     put v into the new table only if the new bucket has
+ *               NEVER held a value (a newer write there must win).
+ *   3. MOVED    CAS FROZEN v → MOVED. Whoever wins counts the bucket.
+ *
+ * Writers that see a `next` table move their own bucket first, then help
+ * with a chunk of COPY_CHUNK others, then retry in the new table — the
+ * cost of a resize is spread over the writes that follow it instead of
+ * one giant rehash. Readers never help: a FROZEN value is still current,
+ * and MOVED just means "look in next". When every bucket is MOVED the
+ * new table becomes the top one.
+ *
+ * RECLAIMING OLD TABLES:
+ * ----------------------
+ * A reader may still be walking a table after it stops being the top.
+ * Every operation runs inside an Epoch::Guard (reclaim.h), and the
+ * thread that promotes past a table retires it to Epoch, which frees it
+ * once every operation that could have seen it has finished. Nobody
+ * waits: readers pay one store per operation, and the freeing happens
+ * during later retires or in pool workers' idle time. Insert/erase churn
+ * therefore cannot pile up dead tables.
+ *
+ * CONSISTENCY:
+ *   Every operation is linearizable for its key. size() is approximate.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "reclaim.h"
+
+template<typename K, typename V, typename Hash = std::hash<K>>
+class ConcurrentHashMap {
+    static_assert(std::is_trivially_copyable_v<K> && sizeof(K) <= 8,
+                  "ConcurrentHashMap: keys must be trivially copyable and at most 8 bytes");
+    static_assert(std::has_unique_object_representations_v<K>,
+                  "ConcurrentHashMap: keys are compared bitwise (no padding, no floats)");
+    static_assert(std::is_trivially_copyable_v<V> && (sizeof(V) <= 4 || std::is_pointer_v<V>),
+                  "ConcurrentHashMap: values must be <= 4 bytes or a pointer — map to an index or pointer");
+
+public:
+    static constexpr size_t COPY_CHUNK = 64;    // buckets a writer migrates per help
+
+    explicit ConcurrentHashMap(size_t initial_capacity = 64) {
+        size_t cap = 16;
+        while (cap < initial_capacity) cap <<= 1;
+        top_.store(new Table(cap), std::memory_order_relaxed);
+    }
+
+    ~ConcurrentHashMap() {
+        for (Table* t = top_.load(std::memory_order_relaxed); t;) {
+            Table* n = t->next.load(std::memory_order_relaxed);
+            delete t;
+            t = n;
+        }
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    // find — the value for `key`, if present. Loads only.
+    std::optional<V> find(const K& key) const {
+        const uint64_t kb = key_bits(key);
+        if (kb == EMPTY_KEY) return std::nullopt;
+        const size_t h = hash_of(key);
+        Epoch::Guard guard;
+
+        for (Table* t = top_.load(std::memory_order_seq_cst); t;) {
+            bool hit_limit = false;
+            Bucket* b = probe(t, kb, h, /*claim=*/false, hit_limit);
+            if (!b) {
+                if (!hit_limit) return std::nullopt;   // reached an EMPTY key
+                t = t->next.load(std::memory_order_acquire);
+                continue;
+            }
+            uint64_t w = b->val.load(std::memory_order_acquire);
+            if (w == MOVED) { t = t->next.load(std::memory_order_acquire); continue; }
+            if (w & SPECIAL) return std::nullopt;      // EMPTY or ERASED
+            return decode(w & ~FROZEN);                 // a frozen value is still current
+        }
+        return std::nullopt;
+    }
+
+    bool contains(const K& key) const { return find(key).has_value(); }
+
+    /**
+     * insert — add (key, value) if the key is absent. Returns the value now
+     * mapped to key and whether this call inserted it (std::map-like): the
+     * first of several racing inserters wins, the rest get its value —
+     * which is exactly what in-flight request coalescing needs.
+     */
+    std::pair<V, bool> insert(const K& key, V value) {
+        uint64_t prev = write(key, encode(value), Match::Absent);
+        if (prev & SPECIAL) return { value, true };
+        return { decode(prev & ~FROZEN), false };
+    }
+
+    // insert_or_assign — upsert; true if the key was absent.
+    bool insert_or_assign(const K& key, V value) {
+        return (write(key, encode(value), Match::Any) & SPECIAL) != 0;
+    }
+
+    // erase — true if a value was removed.
+    bool erase(const K& key) {
+        if (key_bits(key) == EMPTY_KEY) return false;
+        return (write(key, ERASED, Match::Any) & SPECIAL) == 0;
+    }
+
+    // Approximate number of live entries.
+    size_t size() const {
+        int64_t n = size_.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    bool empty() const { return size() == 0; }
+
+    // Bucket count of the current top table.
+    size_t capacity() const {
+        Epoch::Guard guard;   // a resize may retire the top table meanwhile
+        return top_.load(std::memory_order_seq_cst)->cap;
+    }
+
+    // Tables created by resizes over the map's lifetime (for tests/metrics).
+    size_t resizes() const { return resizes_.load(std::memory_order_relaxed); }
+
+private:
+    // ── Word encodings ────────────────────────────────────────
+    static constexpr bool PTR = std::is_pointer_v<V>;
+    static constexpr uint64_t FROZEN  = PTR ? 1ull : 1ull << 32;
+    static constexpr uint64_t SPECIAL = PTR ? 2ull : 1ull << 33;
+    static constexpr uint64_t EMPTY   = SPECIAL;
+    static constexpr uint64_t ERASED  = SPECIAL | (PTR ? 4ull : 1ull);
+    static constexpr uint64_t MOVED   = SPECIAL | (PTR ? 8ull : 2ull);
+    static constexpr uint64_t EMPTY_KEY = ~0ull;
+
+    static uint64_t encode(V v) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(V));
+        if constexpr (PTR) {
+            if (bits & 3)
+                throw std::invalid_argument("ConcurrentHashMap: pointer values must be 4-byte aligned");
+        }
+        return bits;
+    }
+    static V decode(uint64_t w) {
+        V v;
+        std::memcpy(&v, &w, sizeof(V));   // little-endian: payload is the low bytes
+        return v;
+    }
+
+    static uint64_t key_bits(const K& k) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &k, sizeof(K));
+        return bits;
+    }
+    static K key_from(uint64_t bits) {
+        K k;
+        std::memcpy(&k, &bits, sizeof(K));
+        return k;
+    }
+
+    static size_t hash_of(const K& k) {
+        // std::hash of an integer is the identity; fmix64 spreads it.
+        uint64_t x = static_cast<uint64_t>(Hash{}(k));
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return static_cast<size_t>(x);
+    }
+
+    // ── Tables ────────────────────────────────────────────────
+    struct Bucket {
+        std::atomic<uint64_t> key{EMPTY_KEY};
+        std::atomic<uint64_t> val{EMPTY};
+    };
+
+    struct Table {
+        explicit Table(size_t c) : cap(c), mask(c - 1), buckets(new Bucket[c]) {}
+        const size_t              cap;
+        const size_t              mask;
+        std::unique_ptr<Bucket[]> buckets;
+        std::atomic<size_t>       keys{0};          // claimed key slots (incl. tombstones)
+        std::atomic<Table*>       next{nullptr};    // migration target
+        std::atomic<size_t>       copy_idx{0};      // next chunk for helpers
+        std::atomic<size_t>       copy_done{0};     // buckets that reached MOVED
+    };
+
+    static size_t reprobe_limit(size_t cap) { return std::min(cap, 10 + cap / 4); }
+
+    // Find the bucket holding key bits `kb` in t — or, with `claim`, the
+    // first EMPTY one, claimed for it. nullptr if neither within the
+    // reprobe limit (hit_limit = true) or, without claim, at an EMPTY key.
+    Bucket* probe(Table* t, uint64_t kb, size_t h, bool claim, bool& hit_limit) const {
+        const size_t limit = reprobe_limit(t->cap);
+        size_t idx = h & t->mask;
+        for (size_t i = 0; i < limit; ++i, idx = (idx + 1) & t->mask) {
+            Bucket& b = t->buckets[idx];
+            uint64_t k = b.key.load(std::memory_order_acquire);
+            if (k == EMPTY_KEY) {
+                if (!claim) return nullptr;
+                if (b.key.compare_exchange_strong(k, kb, std::memory_order_acq_rel,
+                                                  std::memory_order_acquire)) {
+                    if (t->keys.fetch_add(1, std::memory_order_relaxed) + 1 > t->cap / 4 * 3)
+                        resize(t, /*grow=*/false);
+                    return &b;
+                }
+                // Lost the claim: k is now the winner's key.
+            }
+            if (k == kb) return &b;
+        }
+        hit_limit = true;
+        return nullptr;
+    }
+
+    Table* resize(Table* t, bool grow) const {
+        Table* nx = t->next.load(std::memory_order_acquire);
+        if (nx) return nx;
+        // Double if a quarter or more of the buckets hold live entries;
+        // otherwise the table is mostly tombstones and a same-size copy
+        // (which drops them) is enough.
+        size_t live = size();
+        size_t cap  = (grow || live >= t->cap / 4) ? t->cap * 2 : t->cap;
+        Table* fresh = new Table(cap);
+        if (t->next.compare_exchange_strong(nx, fresh, std::memory_order_acq_rel)) {
+            resizes_.fetch_add(1, std::memory_order_relaxed);
+            return fresh;
+        }
+        delete fresh;
+        return nx;
+    }
+
+    // ── Writes ────────────────────────────────────────────────
+    enum class Match { Any, Absent, NeverSet };
+
+    // Public write ops: help a migration in progress, then put().
+    uint64_t write(const K& key, uint64_t desired, Match m) {
+        const uint64_t kb = key_bits(key);
+        if (kb == EMPTY_KEY)
+            throw std::invalid_argument("ConcurrentHashMap: the all-ones key is reserved");
+        Epoch::Guard guard;
+        Table* t = top_.load(std::memory_order_seq_cst);
+        if (t->next.load(std::memory_order_acquire)) help_copy(t);
+        return put(t, kb, hash_of(key), desired, m);
+    }
+
+    /**
+     * put — set key kb's value word to `desired` in t (or a newer table)
+     * if its current value satisfies `m`. Returns the value word it saw
+     * (EMPTY/ERASED: the key was absent).
+     */
+    uint64_t put(Table* t, uint64_t kb, size_t h, uint64_t desired, Match m) {
+        while (true) {
+            bool hit_limit = false;
+            // Erasing a key that was never claimed needn't claim it.
+            Bucket* b = probe(t, kb, h, /*claim=*/desired != ERASED, hit_limit);
+            if (!b) {
+                if (!hit_limit) return EMPTY;             // erase of a missing key
+                if (desired == ERASED) {                  // not in t: maybe in next
+                    t = t->next.load(std::memory_order_acquire);
+                    if (!t) return EMPTY;
+                    continue;
+                }
+                t = resize(t, /*grow=*/true);             // kb can't be in t: go on
+                continue;
+            }
+
+            uint64_t w = b->val.load(std::memory_order_acquire);
+            Table* nx = t->next.load(std::memory_order_acquire);
+            if (nx || (w & FROZEN) || w == MOVED) {
+                // A migration is under way: move this bucket, then retry there.
+                copy_slot(t, *b);
+                t = t->next.load(std::memory_order_acquire);
+                continue;
+            }
+
+            while (true) {
+                if ((w & FROZEN) || w == MOVED) break;          // frozen under us
+                const bool absent = (w & SPECIAL) != 0;
+                if (m == Match::Absent && !absent) return w;
+                if (m == Match::NeverSet && w != EMPTY) return w;
+                if (desired == ERASED && absent) return w;
+                if (b->val.compare_exchange_weak(w, desired, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                    if (m != Match::NeverSet) {                 // copies don't change size
+                        if (absent && desired != ERASED)  size_.fetch_add(1, std::memory_order_relaxed);
+                        if (!absent && desired == ERASED) size_.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    return w;
+                }
+            }
+        }
+    }
+
+    // Move one bucket of t into t->next: freeze, copy, mark MOVED.
+    void copy_slot(Table* t, Bucket& b) {
+        uint64_t w = b.val.load(std::memory_order_acquire);
+        while (!(w & FROZEN) && w != MOVED) {
+            // EMPTY / ERASED have nothing to copy: straight to MOVED.
+            uint64_t to = (w & SPECIAL) ? MOVED : (w | FROZEN);
+            if (b.val.compare_exchange_weak(w, to, std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+                if (to == MOVED) { bucket_moved(t); return; }
+                w = to;
+            }
+        }
+        if (w == MOVED) return;
+
+        // Frozen: the key is set (values are only written after the claim).
+        uint64_t kb = b.key.load(std::memory_order_acquire);
+        put(t->next.load(std::memory_order_acquire), kb, hash_of(key_from(kb)),
+            w & ~FROZEN, Match::NeverSet);
+        if (b.val.compare_exchange_strong(w, MOVED, std::memory_order_acq_rel))
+            bucket_moved(t);
+    }
+
+    void help_copy(Table* t) {
+        size_t start = t->copy_idx.fetch_add(COPY_CHUNK, std::memory_order_relaxed);
+        if (start >= t->cap) return;
+        size_t end = std::min(t->cap, start + COPY_CHUNK);
+        for (size_t i = start; i < end; ++i) copy_slot(t, t->buckets[i]);
+    }
+
+    void bucket_moved(Table* t) {
+        if (t->copy_done.fetch_add(1, std::memory_order_acq_rel) + 1 == t->cap) promote();
+    }
+
+    // Advance top_ past every fully migrated table, retiring each.
+    void promote() {
+        Table* t = top_.load(std::memory_order_acquire);
+        while (t->copy_done.load(std::memory_order_acquire) == t->cap) {
+            Table* nx = t->next.load(std::memory_order_acquire);
+            if (top_.compare_exchange_strong(t, nx, std::memory_order_seq_cst)) {
+                Epoch::retire(t, &RetiredPtr::delete_as<Table>,
+                              sizeof(Table) + t->cap * sizeof(Bucket));
+                t = nx;
+            }
+        }
+    }
+
+    std::atomic<Table*>      top_{nullptr};
+    std::atomic<int64_t>     size_{0};
+    mutable std::atomic<size_t> resizes_{0};
+};
@@ -0,0 +1,222 @@
+#pragma once
+/**
+ * fast_clock.h — TSC-based monotonic clock for hot-path timing
+ * =============================================================
+ *
+ * WHY NOT steady_clock?
+ * ---------------------
+ * steady_clock::now() is clock_gettime(CLOCK_MONOTONIC) through the
+ * vDSO: no syscall, but still 20-40 ns (read the vvar page, read the
+ * TSC, check the sequence count, convert). ThreadPoolV3 takes three
+ * stamps per task, TaskServer two per request — for a sub-µs task that
+ * is a real share of the work. The TSC itself is one instruction.
+ *
+ * HOW:
+ * ----
+ *   ns = base_ns + ((tsc - base_tsc) · mult) >> 32      mult = ns/tick · 2^32
+ *
+ * The first now() calibrates: it samples the TSC and steady_clock over
+ * CALIBRATE_NS (each steady_clock read bracketed by two TSC reads and
+ * taken at the midpoint) and starts at base_ns = steady_clock's value,
+ * so FastClock and steady_clock share an epoch and can be compared.
+ *
+ * now() uses plain RDTSC, not RDTSCP/LFENCE+RDTSC: it is not ordered
+ * against surrounding instructions, so a stamp can be off by the few ns
+ * of work the CPU has in flight — noise for task and request timing,
+ * and serializing would cost ~10-30 cycles on every stamp.
+ *
+ * RECALIBRATION: once a reader sees more than RECALIBRATE_NS of ticks
+ * since the last calibration, it (one thread, by try-lock) re-measures
+ * the TSC rate over that whole interval and re-bases at the CURRENT
+ * fast time, steering mult by at most ±0.1% so the remaining offset
+ * to steady_clock is absorbed over the next interval instead of
+ * stepping. The clock never jumps: within one thread it never goes
+ * backwards; a reader racing the re-base can see another thread's
+ * stamp up to ~1 ns ahead of its own.
+ *
+ * Readers get (base_tsc, base_ns, mult) through a seqlock: two loads
+ * of the sequence word around three relaxed loads, no RMW.
+ *
+ * FALLBACK: the TSC is used only on x86 with an invariant TSC (CPUID
+ * 0x80000007 EDX[8]: constant rate, keeps ticking in deep C-states,
+ * synchronized across cores). Anywhere else — or if calibration sees
+ * the TSC stand still — FastClock::now() is steady_clock::now().
+ *
+ * FastClock is a std::chrono clock: FastClock::now() - start is a
+ * nanoseconds duration, and Histogram / HdrHistogram / Summary take a
+ * FastClock::time_point in observe_since().
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define FAST_CLOCK_X86 1
+#endif
+
+class FastClock {
+public:
+    using rep        = int64_t;
+    using period     = std::nano;
+    using duration   = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<FastClock>;
+    static constexpr bool is_steady = true;
+
+    static constexpr int64_t CALIBRATE_NS   = 5'000'000;       // first call: 5 ms
+    static constexpr int64_t RECALIBRATE_NS = 1'000'000'000;   // then every ~1 s
+
+    static time_point now() noexcept { return time_point(duration(now_ns())); }
+
+    // Nanoseconds in steady_clock's epoch.
+    static int64_t now_ns() noexcept {
+        State& s = state();
+        if (!s.tsc) return steady_ns();
+        const uint64_t tsc = read_tsc();
+        uint64_t base_tsc, mult;
+        int64_t  base_ns;
+        s.load(base_tsc, base_ns, mult);
+        const uint64_t ticks = tsc > base_tsc ? tsc - base_tsc : 0;
+        if (ticks > s.recal_ticks.load(std::memory_order_relaxed)) recalibrate(s, false);
+        return base_ns + static_cast<int64_t>((static_cast<u128>(ticks) * mult) >> 32);
+    }
+
+    // True if now() reads the TSC, false if it is steady_clock.
+    static bool uses_tsc() noexcept { return state().tsc; }
+
+    // Calibrated TSC rate (0 when not using the TSC).
+    static double ticks_per_ns() noexcept {
+        State& s = state();
+        if (!s.tsc) return 0.0;
+        uint64_t bt, mult;
+        int64_t  bn;
+        s.load(bt, bn, mult);
+        return 4294967296.0 / static_cast<double>(mult);
+    }
+
+    // Re-measure the TSC rate now instead of at the next interval.
+    static void recalibrate() noexcept {
+        State& s = state();
+        if (s.tsc) recalibrate(s, true);
+    }
+
+private:
+    __extension__ typedef unsigned __int128 u128;   // (ticks · mult) before >> 32
+
+    struct State {
+        bool                  tsc = false;
+        std::atomic<uint32_t> seq{0};
+        std::atomic<uint64_t> base_tsc{0}, mult{0};
+        std::atomic<int64_t>  base_ns{0};
+        std::atomic<uint64_t> recal_ticks{UINT64_MAX};
+        std::mutex            recal_mtx;
+        uint64_t              cal_tsc = 0;   // last calibration point (under recal_mtx)
+        int64_t               cal_ns  = 0;
+
+        State() { calibrate(*this); }
+
+        void load(uint64_t& bt, int64_t& bn, uint64_t& m) const noexcept {
+            for (;;) {
+                uint32_t s1 = seq.load(std::memory_order_acquire);
+                bt = base_tsc.load(std::memory_order_relaxed);
+                bn = base_ns.load(std::memory_order_relaxed);
+                m  = mult.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (!(s1 & 1) && seq.load(std::memory_order_relaxed) == s1) return;
+            }
+        }
+        void store(uint64_t bt, int64_t bn, uint64_t m) noexcept {
+            seq.fetch_add(1, std::memory_order_relaxed);            // odd: writing
+            std::atomic_thread_fence(std::memory_order_release);
+            base_tsc.store(bt, std::memory_order_relaxed);
+            base_ns.store(bn, std::memory_order_relaxed);
+            mult.store(m, std::memory_order_relaxed);
+            seq.fetch_add(1, std::memory_order_release);            // even: done
+        }
+    };
+
+    static int64_t steady_ns() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#ifdef FAST_CLOCK_X86
+    static uint64_t read_tsc() noexcept { return __rdtsc(); }
+    static bool invariant_tsc() noexcept {
+        unsigned a = 0, b = 0, c = 0, d = 0;
+        if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || a < 0x80000007) return false;
+        __get_cpuid(0x80000007, &a, &b, &c, &d);
+        return d & (1u << 8);
+    }
+#else
+    static uint64_t read_tsc() noexcept { return 0; }
+    static bool invariant_tsc() noexcept { return false; }
+#endif
+
+    // A (tsc, steady ns) pair read as close together as we can: the
+    // steady_clock read bracketed by two TSC reads, best of a few tries.
+    static void sample(uint64_t& tsc, int64_t& ns) noexcept {
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 5; ++i) {
+            uint64_t t0 = read_tsc();
+            int64_t  n  = steady_ns();
+            uint64_t t1 = read_tsc();
+            if (t1 - t0 < best) { best = t1 - t0; tsc = t0 + (t1 - t0) / 2; ns = n; }
+        }
+    }
+
+    static State& state() noexcept {
+        static State s;
+        return s;
+    }
+
+    static void calibrate(State& st) noexcept {
+        if (!invariant_tsc()) return;
+        uint64_t t0 = 0, t1 = 0;
+        int64_t  n0 = 0, n1 = 0;
+        sample(t0, n0);
+        do sample(t1, n1); while (n1 - n0 < CALIBRATE_NS);
+        if (t1 <= t0) return;                   // TSC not moving: stay on steady_clock
+        const double rate = static_cast<double>(n1 - n0) / static_cast<double>(t1 - t0);
+        const uint64_t mult = static_cast<uint64_t>(rate * 4294967296.0);
+        if (mult == 0) return;
+        st.base_tsc.store(t1, std::memory_order_relaxed);
+        st.base_ns.store(n1, std::memory_order_relaxed);
+        st.mult.store(mult, std::memory_order_relaxed);
+        st.cal_tsc = t1;
+        st.cal_ns  = n1;
+        st.recal_ticks.store(static_cast<uint64_t>(RECALIBRATE_NS / rate), std::memory_order_relaxed);
+        st.tsc = true;
+    }
+
+    static void recalibrate(State& s, bool force) noexcept {
+        std::unique_lock<std::mutex> lk(s.recal_mtx, std::try_to_lock);
+        if (!lk.owns_lock()) return;            // someone else is on it
+        uint64_t tsc = 0;
+        int64_t  steady = 0;
+        sample(tsc, steady);
+        uint64_t bt, old_mult;
+        int64_t  bn;
+        s.load(bt, bn, old_mult);
+        if (!force && tsc - bt <= s.recal_ticks.load(std::memory_order_relaxed)) return;
+        if (tsc <= s.cal_tsc || steady <= s.cal_ns) return;
+
+        // The rate over the whole interval, then steered to close the gap.
+        const int64_t fast  = bn + static_cast<int64_t>(
+            (static_cast<u128>(tsc > bt ? tsc - bt : 0) * old_mult) >> 32);
+        const double rate   = static_cast<double>(steady - s.cal_ns)
+                            / static_cast<double>(tsc - s.cal_tsc);       // ns per tick
+        double steer        = static_cast<double>(steady - fast) / RECALIBRATE_NS;
+        steer = steer > 1e-3 ? 1e-3 : (steer < -1e-3 ? -1e-3 : steer);
+        const uint64_t mult = static_cast<uint64_t>(rate * (1.0 + steer) * 4294967296.0);
+
+        s.store(tsc, std::max(fast, bn), mult);
+        s.cal_tsc = tsc;
+        s.cal_ns  = steady;
+        s.recal_ticks.store(static_cast<uint64_t>(RECALIBRATE_NS / rate), std::memory_order_relaxed);
+    }
+};
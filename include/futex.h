@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <chrono>
+#include <climits>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/**
+ * futex.h — park/unpark a thread on a 32-bit atomic word
+ * =======================================================
+ *
+ * WHY NOT std::condition_variable?
+ * --------------------------------
+ * A condvar needs a mutex, and the waker has to take it to avoid lost
+ * wakeups. For a lock-free queue that would put a lock back on the
+ * producer path we just removed. A futex is the kernel primitive
+ * underneath both: "sleep if *addr still equals v" and "wake n sleepers
+ * on addr". The compare happens inside the kernel, so a wake that lands
+ * between our check and our sleep is never lost — the wait simply
+ * returns immediately.
+ *
+ * USAGE PATTERN (epoch counter):
+ *
+ *   waiter:  e = word.load();  if (nothing to do) futex_wait(&word, e);
+ *   waker:   make work visible; word.fetch_add(1); futex_wake(&word, 1);
+ *
+ * `shared = true` selects the non-PRIVATE futex ops, which work on memory
+ * mapped into several processes (shm). Private futexes are a little
+ * cheaper and are the right choice inside one process.
+ *
+ * Non-Linux builds fall back to a short sleep — correct (callers always
+ * re-check their condition) but with coarser wake latency.
+ */
+inline void futex_wait(std::atomic<uint32_t>* word, uint32_t expected, bool shared = false) {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "futex needs a plain 32-bit word");
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+            shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE,
+            expected, nullptr, nullptr, 0);
+#else
+    if (word->load(std::memory_order_acquire) == expected)
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    (void)shared;
+#endif
+}
+
+// futex_wait with a relative timeout — for waiters that must wake up now
+// and then on their own (e.g. to check whether a peer process died).
+inline void futex_wait_for(std::atomic<uint32_t>* word, uint32_t expected,
+                           std::chrono::nanoseconds timeout, bool shared = false) {
+#if defined(__linux__)
+    if (timeout.count() <= 0) return;
+    struct timespec ts;
+    ts.tv_sec  = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+            shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE,
+            expected, &ts, nullptr, 0);
+#else
+    if (word->load(std::memory_order_acquire) == expected)
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(
+            timeout, std::chrono::microseconds(50)));
+    (void)shared;
+#endif
+}
+
+inline void futex_wake(std::atomic<uint32_t>* word, int count = 1, bool shared = false) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+            shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE,
+            count, nullptr, nullptr, 0);
+#else
+    (void)word; (void)count; (void)shared;
+#endif
+}
+
+inline void futex_wake_all(std::atomic<uint32_t>* word, bool shared = false) {
+    futex_wake(word, INT_MAX, shared);
+}
@@ -2,9 +2,12 @@
 
 #include <atomic>
 #include <array>
+#include <cstdint>
 #include <optional>
 #include <stdexcept>
-#include <new>  // std::hardware_destructive_interference_size
+#include <new>  // std::hardware_destructive_interference_size, placement new
+#include <type_traits>
+#include <utility>
 
 /**
  * LockFreeQueue<T, Capacity>
@@ -60,7 +63,30 @@
  *
  * alignas(CACHE_LINE) forces each to its own cache line.
  *
- * @tparam T        Element type (must be movable)
+ * SLOT STORAGE AND OBJECT LIFETIME:
+ * ---------------------------------
+ * Slots hold RAW aligned storage, not a T. The sequence protocol already
+ * says who owns a slot, so it also says whether a T lives there:
+ *
+ *   seq == pos          empty — the producer that claims it CONSTRUCTS
+ *                       a T in place, then publishes seq = pos + 1
+ *   seq == pos + 1      live T — the consumer that claims it moves/visits
+ *                       it, DESTROYS it, then frees seq = pos + Capacity
+ *
+ * So T need not be default-constructible, and nothing is default-built
+ * and then overwritten. The APIs avoid the remaining moves:
+ *
+ *   try_emplace(args...)   construct straight into the slot (0 moves)
+ *   try_enqueue(T&&)       one move-construct into the slot
+ *   try_consume(f)         run f(T&) on the slot itself (0 moves)
+ *   try_dequeue(T& out)    one move-assign into caller storage
+ *   try_dequeue()          std::optional<T> — one more move; convenience
+ *
+ * If T's constructor throws after a slot was claimed, the slot can't be
+ * given back (tail_ has moved on), so it is published as a TOMBSTONE that
+ * consumers skip, and the exception propagates to the producer.
+ *
+ * @tparam T        Element type (move-constructible)
  * @tparam Capacity Ring buffer size (must be power of 2)
  */
 template<typename T, size_t Capacity>
@@ -79,11 +105,27 @@ public:
         tail_.store(0, std::memory_order_relaxed);
     }
 
+    ~LockFreeQueue() {
+        // Single-threaded by now: destroy whatever was never dequeued.
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            for (size_t pos = head_.load(std::memory_order_relaxed); pos != tail; ++pos) {
+                Slot& slot = slots_[pos & MASK];
+                if (slot.sequence.load(std::memory_order_relaxed) == pos + 1 && !slot.skip)
+                    slot.ptr()->~T();
+            }
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
     /**
      * try_enqueue — attempt to add an item.
      *
      * Returns true on success, false if queue is full.
-     * Never blocks. Never throws. O(1) amortized.
+     * Never blocks. O(1) amortized. Only throws if T's copy/move
+     * constructor does (see SLOT STORAGE AND OBJECT LIFETIME).
      *
      * How it works:
      *  1. Load current tail position
@@ -91,84 +133,183 @@ public:
      *  3. CAS: atomically try to claim tail+1
      *     - If CAS succeeds: we own this slot, write data
      *     - If CAS fails: another thread grabbed it first, retry
+     *
+     * The item is only moved from once a slot is claimed, so a caller
+     * whose try_enqueue(std::move(x)) failed still owns an intact x and
+     * can retry with it (or try another queue).
      */
-    bool try_enqueue(T item) {
-        size_t tail = tail_.load(std::memory_order_relaxed);
+    bool try_enqueue(const T& item) { return enqueue_impl(item); }
+    bool try_enqueue(T&& item)      { return enqueue_impl(std::move(item)); }
 
-        while (true) {
-            Slot& slot = slots_[tail & MASK];
+    /**
+     * try_emplace — construct an item directly in its slot.
+     *
+     * Same contract as try_enqueue: false if full, and the arguments are
+     * only forwarded once a slot is claimed, so they are untouched on
+     * failure. Throws whatever T's constructor throws.
+     */
+    template<typename... Args>
+    bool try_emplace(Args&&... args) { return enqueue_impl(std::forward<Args>(args)...); }
 
-            // Load the slot's sequence with acquire ordering
-            // so we see any writes the previous owner made
+    /**
+     * try_consume — remove the oldest item by running f(T&) on it in place.
+     *
+     * Returns false (without calling f) if the queue is empty. The item
+     * is destroyed and its slot recycled after f returns — or throws, in
+     * which case the item is gone and the exception propagates.
+     */
+    template<typename F>
+    bool try_consume(F&& f) {
+        size_t head = head_.load(std::memory_order_relaxed);
+
+        while (true) {
+            Slot& slot = slots_[head & MASK];
             size_t seq = slot.sequence.load(std::memory_order_acquire);
-            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(tail);
+            intptr_t diff = static_cast<intptr_t>(seq)
+                          - static_cast<intptr_t>(head + 1);
 
             if (diff == 0) {
-                // Slot is ready. Try to claim it with CAS.
-                // memory_order_acq_rel: if we win the CAS, our subsequent
-                // write to slot.data is ordered after this.
-                if (tail_.compare_exchange_weak(
-                        tail, tail + 1,
+                // Slot has data. Try to claim it.
+                if (head_.compare_exchange_weak(
+                        head, head + 1,
                         std::memory_order_acq_rel,
                         std::memory_order_relaxed))
                 {
-                    // We own this slot. Write data.
-                    slot.data = std::move(item);
-
-                    // Signal that data is ready for dequeue
-                    // Release ordering: makes our slot.data write visible
-                    slot.sequence.store(tail + 1, std::memory_order_release);
+                    if (slot.skip) {           // tombstone: nothing to visit
+                        slot.skip = false;
+                        slot.sequence.store(head + Capacity, std::memory_order_release);
+                        head = head_.load(std::memory_order_relaxed);
+                        continue;
+                    }
+                    // We own this slot. Visit, then destroy and mark the
+                    // slot ready for the next enqueue cycle (even if f throws).
+                    Release done{slot, head + Capacity};
+                    f(*slot.ptr());
                     return true;
                 }
-                // CAS failed — another thread took our slot. Reload and retry.
+                // CAS failed — another thread grabbed this slot. Retry.
             } else if (diff < 0) {
-                // Queue is full (slot was enqueued but not yet dequeued)
+                // Queue is empty
                 return false;
             } else {
-                // Another enqueuer advanced tail; reload
-                tail = tail_.load(std::memory_order_relaxed);
+                // Another dequeuer advanced head; reload
+                head = head_.load(std::memory_order_relaxed);
             }
         }
     }
 
+    /**
+     * try_dequeue — attempt to remove an item into `out`.
+     *
+     * Returns false if empty. Never blocks. O(1) amortized.
+     */
+    bool try_dequeue(T& out) {
+        return try_consume([&out](T& item) { out = std::move(item); });
+    }
+
     /**
      * try_dequeue — attempt to remove an item.
      *
-     * Returns the item if available, std::nullopt if empty.
-     * Never blocks. Never throws. O(1) amortized.
+     * Returns the item if available, std::nullopt if empty. Costs one
+     * move more than try_dequeue(T&); prefer that or try_consume() on
+     * hot paths.
      */
     std::optional<T> try_dequeue() {
+        std::optional<T> out;
+        try_consume([&out](T& item) { out.emplace(std::move(item)); });
+        return out;
+    }
+
+    /**
+     * try_dequeue_bulk — remove up to `max` items with a single CAS on head_.
+     *
+     * Counts how many consecutive slots from head are already published,
+     * then claims all of them at once. One contended CAS buys k items
+     * instead of one, which is what makes batching worth it for tiny
+     * tasks. Items are move-assigned to *out, *(out+1), ...
+     * Returns the number of items taken (0 if empty).
+     *
+     * If a move-assignment (or the iterator) throws, the exception
+     * propagates and every slot the call claimed is still handed back:
+     * the throwing item is lost, as with try_dequeue(T&), and so are the
+     * claimed items after it. Items already written to `out` stay there.
+     */
+    template<typename OutIt>
+    size_t try_dequeue_bulk(OutIt out, size_t max) {
+        uint64_t retries = 0;
+        return try_dequeue_bulk(out, max, retries);
+    }
+
+    /**
+     * try_dequeue_bulk — as above, and adds one to `retries` for every
+     * race lost to another consumer (a failed CAS on head_, or head_
+     * moving while the ready slots were counted). The queue keeps no
+     * count of its own — a shared one would be a third contended line —
+     * so callers keep `retries` somewhere private, e.g. per worker.
+     */
+    template<typename OutIt>
+    size_t try_dequeue_bulk(OutIt out, size_t max, uint64_t& retries) {
+        if (max == 0) return 0;
+        if (max > Capacity) max = Capacity;
         size_t head = head_.load(std::memory_order_relaxed);
 
         while (true) {
-            Slot& slot = slots_[head & MASK];
-            size_t seq = slot.sequence.load(std::memory_order_acquire);
-            intptr_t diff = static_cast<intptr_t>(seq)
-                          - static_cast<intptr_t>(head + 1);
+            size_t ready = 0;
+            while (ready < max) {
+                size_t seq = slots_[(head + ready) & MASK].sequence.load(
+                                 std::memory_order_acquire);
+                if (seq != head + ready + 1) break;
+                ++ready;
+            }
 
-            if (diff == 0) {
-                // Slot has data. Try to claim it.
-                if (head_.compare_exchange_weak(
-                        head, head + 1,
-                        std::memory_order_acq_rel,
-                        std::memory_order_relaxed))
-                {
-                    // We own this slot. Read data.
-                    T item = std::move(slot.data);
+            if (ready == 0) {
+                size_t seq = slots_[head & MASK].sequence.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(head + 1) < 0)
+                    return 0;                                   // empty
+                ++retries;
+                head = head_.load(std::memory_order_relaxed);   // raced; reload
+                continue;
+            }
 
-                    // Mark slot as ready for next enqueue cycle
-                    slot.sequence.store(head + Capacity,
-                                        std::memory_order_release);
-                    return item;
+            // A slot can only be recycled after head_ passes it, so if the
+            // CAS succeeds every slot we counted is still published and ours.
+            if (head_.compare_exchange_weak(
+                    head, head + ready,
+                    std::memory_order_acq_rel,
+                    std::memory_order_relaxed))
+            {
+                size_t taken = 0, i = 0;
+                try {
+                    for (; i < ready; ++i) {
+                        Slot& slot = slots_[(head + i) & MASK];
+                        if (slot.skip) {
+                            slot.skip = false;
+                            slot.sequence.store(head + i + Capacity, std::memory_order_release);
+                            continue;
+                        }
+                        Release done{slot, head + i + Capacity};
+                        *out = std::move(*slot.ptr());
+                        ++out;
+                        ++taken;
+                    }
+                } catch (...) {
+                    // Slot i was released by its guard. The rest are ours
+                    // already (head_ is past them): drop their items and
+                    // hand the slots back, or the ring would jam.
+                    for (++i; i < ready; ++i) {
+                        Slot& slot = slots_[(head + i) & MASK];
+                        if (slot.skip) slot.skip = false;
+                        else           slot.ptr()->~T();
+                        slot.sequence.store(head + i + Capacity, std::memory_order_release);
+                    }
+                    throw;
                 }
-                // CAS failed — another thread grabbed this slot. Retry.
-            } else if (diff < 0) {
-                // Queue is empty
-                return std::nullopt;
-            } else {
-                // Another dequeuer advanced head; reload
-                head = head_.load(std::memory_order_relaxed);
+                if (taken) return taken;
+                head = head_.load(std::memory_order_relaxed);   // all tombstones
+                continue;
             }
+            // CAS failed — head was reloaded into `head`; recount.
+            ++retries;
         }
     }
 
@@ -199,6 +340,56 @@ private:
 
     static constexpr size_t MASK = Capacity - 1;  // fast modulo for power-of-2
 
+    template<typename... Args>
+    bool enqueue_impl(Args&&... args) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+
+        while (true) {
+            Slot& slot = slots_[tail & MASK];
+
+            // Load the slot's sequence with acquire ordering
+            // so we see any writes the previous owner made
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(tail);
+
+            if (diff == 0) {
+                // Slot is ready. Try to claim it with CAS.
+                // memory_order_acq_rel: if we win the CAS, our subsequent
+                // construction in the slot is ordered after this.
+                if (tail_.compare_exchange_weak(
+                        tail, tail + 1,
+                        std::memory_order_acq_rel,
+                        std::memory_order_relaxed))
+                {
+                    // We own this slot. Construct the item in place.
+                    if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+                        ::new (static_cast<void*>(slot.storage)) T(std::forward<Args>(args)...);
+                    } else {
+                        try {
+                            ::new (static_cast<void*>(slot.storage)) T(std::forward<Args>(args)...);
+                        } catch (...) {
+                            slot.skip = true;   // publish a tombstone
+                            slot.sequence.store(tail + 1, std::memory_order_release);
+                            throw;
+                        }
+                    }
+
+                    // Signal that data is ready for dequeue
+                    // Release ordering: makes the constructed item visible
+                    slot.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+                // CAS failed — another thread took our slot. Reload and retry.
+            } else if (diff < 0) {
+                // Queue is full (slot was enqueued but not yet dequeued)
+                return false;
+            } else {
+                // Another enqueuer advanced tail; reload
+                tail = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
     /**
      * Slot — one cell in the ring buffer.
      *
@@ -209,7 +400,20 @@ private:
      */
     struct alignas(CACHE_LINE) Slot {
         std::atomic<size_t> sequence{0};
-        T                   data{};
+        bool                skip = false;   // tombstone: constructor threw
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* ptr() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    // Destroys a consumed item and hands its slot back to producers.
+    struct Release {
+        Slot&  slot;
+        size_t next_seq;
+        ~Release() {
+            slot.ptr()->~T();
+            slot.sequence.store(next_seq, std::memory_order_release);
+        }
     };
 
     // The ring buffer of slots
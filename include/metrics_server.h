@@ -37,6 +37,10 @@
  * Each connection is handled inline (no thread per connection).
  * This is fine for a metrics endpoint with rare scrapes (~every 15s).
  * For production: use the thread pool to handle connections.
+ *
+ * The page is written into one MetricsBuffer owned by the serving
+ * thread and reused across scrapes, so after the first scrape a
+ * /metrics response costs no heap allocation for the body.
  */
 
 #include <string>
@@ -156,9 +160,13 @@ private:
         std::string response;
 
         if (request.rfind("GET /metrics", 0) == 0) {
-            // Prometheus scrape endpoint
-            std::string body = registry_.serialize();
-            response = http_response("200 OK", "text/plain; version=0.0.4", body);
+            // Prometheus scrape endpoint — header and page sent separately
+            page_.clear();
+            registry_.write(page_);
+            std::string head = http_header("200 OK", "text/plain; version=0.0.4", page_.size());
+            send_all(client_fd, head, MSG_MORE);
+            send_all(client_fd, page_.view(), 0);
+            return;
         } else if (request.rfind("GET /health", 0) == 0) {
             // Kubernetes liveness probe — always 200 if process is alive
             response = http_response("200 OK", "text/plain", "OK\n");
@@ -168,23 +176,38 @@ private:
                 "Endpoints: /metrics, /health\n");
         }
 
-        ::send(client_fd, response.c_str(), response.size(), 0);
+        send_all(client_fd, response, 0);
+    }
+
+    static std::string http_header(const std::string& status,
+                                   const std::string& content_type,
+                                   size_t content_length) {
+        MetricsBuffer out;
+        out << "HTTP/1.1 " << status << "\r\n"
+            << "Content-Type: " << content_type << "\r\n"
+            << "Content-Length: " << content_length << "\r\n"
+            << "Connection: close\r\n"
+            << "\r\n";
+        return out.str();
     }
 
     static std::string http_response(const std::string& status,
                                      const std::string& content_type,
                                      const std::string& body) {
-        std::ostringstream ss;
-        ss << "HTTP/1.1 " << status << "\r\n"
-           << "Content-Type: " << content_type << "\r\n"
-           << "Content-Length: " << body.size() << "\r\n"
-           << "Connection: close\r\n"
-           << "\r\n"
-           << body;
-        return ss.str();
+        return http_header(status, content_type, body.size()) + body;
+    }
+
+    // send() until all of `data` is out; a large page can take several.
+    static void send_all(int fd, std::string_view data, int flags) {
+        while (!data.empty()) {
+            ssize_t n = ::send(fd, data.data(), data.size(), flags | MSG_NOSIGNAL);
+            if (n <= 0) return;
+            data.remove_prefix(static_cast<size_t>(n));
+        }
     }
 
     MetricsRegistry& registry_;
+    MetricsBuffer    page_;        // serve thread only
     int              port_;
     std::atomic<bool> running_;
     int              server_fd_;
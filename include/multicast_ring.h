@@ -0,0 +1,249 @@
+#pragma once
+
+/**
+ * multicast_ring.h — Disruptor-style sequenced ring for event fan-out
+ * ====================================================================
+ *
+ * LockFreeQueue hands each item to exactly ONE consumer. Event fan-out
+ * (journal + replicate + business logic, all on the same stream) needs
+ * every consumer to see every event. Copying each event into N queues
+ * costs N enqueues and N copies; a multicast ring costs one write.
+ *
+ * THE MODEL (LMAX Disruptor):
+ * ---------------------------
+ * The ring never "removes" anything. Every event has a 64-bit SEQUENCE
+ * number and lives at slot seq & MASK until the producers lap it.
+ * Each consumer owns a CURSOR: the last sequence it has finished with.
+ *
+ *   producers ── claim(n) ──► [ ... | 41 | 42 | 43 | 44 | 45 | ... ]
+ *                                     ▲              ▲         ▲
+ *                               journal.cursor  replicate   next_
+ *                                 (slowest)      .cursor
+ *
+ *   • A producer may only claim seq when seq - Capacity <= the SLOWEST
+ *     cursor — otherwise it would overwrite an event someone still needs.
+ *     That is the only backpressure there is.
+ *   • A consumer may read seq once it is PUBLISHED and every consumer it
+ *     DEPENDS ON has moved past it. Dependencies form a DAG:
+ *
+ *                  ┌──► C1 ──┐
+ *        producer ─┤         ├──► C3      (diamond: C3 sees an event only
+ *                  └──► C2 ──┘            after both C1 and C2 are done)
+ *
+ * BATCHING, BOTH SIDES:
+ * ---------------------
+ *   claim(n)  one fetch_add reserves n consecutive sequences; the producer
+ *             fills them and publish()es the range.
+ *   poll(fn)  a consumer reads how far it may go ONCE, handles every
+ *             event up to there, then stores its cursor ONCE. A consumer
+ *             that falls behind catches up in big batches — the opposite
+ *             of a queue, where each item costs a CAS.
+ *
+ * PUBLICATION WITH MULTIPLE PRODUCERS:
+ * ------------------------------------
+ * Claims finish out of order (P1 claims 10-13, P2 claims 14-15, P2
+ * publishes first). Each slot therefore records the LAP in which it was
+ * last published (seq >> log2(Capacity)) — the same sequence-per-slot
+ * trick as LockFreeQueue. A root consumer scans forward from its cursor
+ * and stops at the first slot whose lap isn't the current one.
+ *
+ * THREADING:
+ *   Any number of producer threads.
+ *   Each Consumer is driven by ONE thread at a time (its cursor has a
+ *   single writer). Run more Consumers for more parallelism.
+ *   add_consumer() must be called before the first claim.
+ *
+ * Handlers get T& and may annotate the event for downstream consumers
+ * (that is how C1/C2 hand results to C3 without another queue).
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+template<typename T, size_t Capacity = 1024>
+class MulticastRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of 2 and >= 2");
+
+public:
+    class Consumer {
+    public:
+        // Last sequence this consumer has finished with (-1 = none yet).
+        int64_t cursor() const { return cursor_.load(std::memory_order_acquire); }
+
+        /**
+         * poll — handle every event currently available to this consumer.
+         * fn(T& event, int64_t seq, bool end_of_batch). Returns how many
+         * events were handled (0 if none were ready). Never blocks.
+         */
+        template<typename F>
+        size_t poll(F&& fn) {
+            const int64_t next  = cursor_.load(std::memory_order_relaxed) + 1;
+            const int64_t limit = ring_->available_to(*this, next);
+            if (limit < next) return 0;
+            for (int64_t s = next; s <= limit; ++s)
+                fn(ring_->slots_[static_cast<size_t>(s) & MASK].data, s, s == limit);
+            // Release: our writes to the events (and everything the
+            // handler did) are visible to dependents and to producers
+            // that reuse these slots.
+            cursor_.store(limit, std::memory_order_release);
+            return static_cast<size_t>(limit - next + 1);
+        }
+
+        // poll() in a spin-then-yield loop until `seq` has been handled.
+        template<typename F>
+        void drain_until(int64_t seq, F&& fn) {
+            int idle = 0;
+            while (cursor_.load(std::memory_order_relaxed) < seq) {
+                if (poll(fn)) { idle = 0; continue; }
+                if (++idle > 64) std::this_thread::yield();
+            }
+        }
+
+    private:
+        friend class MulticastRing;
+        explicit Consumer(MulticastRing* ring, std::vector<const Consumer*> deps)
+            : ring_(ring), deps_(std::move(deps)) {}
+
+        alignas(64) std::atomic<int64_t> cursor_{-1};
+        MulticastRing*                   ring_;
+        std::vector<const Consumer*>     deps_;   // empty = reads from producers
+    };
+
+    MulticastRing() = default;
+    MulticastRing(const MulticastRing&) = delete;
+    MulticastRing& operator=(const MulticastRing&) = delete;
+
+    /**
+     * add_consumer — register a consumer that sees every event after all
+     * of `after` have handled it. The ring owns the Consumer.
+     */
+    Consumer& add_consumer(std::vector<const Consumer*> after = {}) {
+        if (started_.load(std::memory_order_relaxed))
+            throw std::logic_error("MulticastRing: add_consumer after first claim");
+        for (const Consumer* d : after)
+            if (!d || d->ring_ != this)
+                throw std::invalid_argument("MulticastRing: dependency from another ring");
+        consumers_.push_back(std::unique_ptr<Consumer>(new Consumer(this, std::move(after))));
+        return *consumers_.back();
+    }
+
+    /**
+     * claim — reserve n consecutive sequences, waiting while the slowest
+     * consumer is less than a lap behind. Returns the FIRST sequence;
+     * fill (*this)[first] … (*this)[first+n-1], then publish(first, n).
+     */
+    int64_t claim(size_t n = 1) {
+        check_claim(n);
+        const int64_t first = next_.fetch_add(static_cast<int64_t>(n), std::memory_order_relaxed);
+        const int64_t wrap  = first + static_cast<int64_t>(n) - 1 - static_cast<int64_t>(Capacity);
+        // Scanning every cursor on every claim would put the producers on
+        // the consumers' cache lines; re-read them only when the cached
+        // minimum says we might lap someone.
+        if (wrap > gating_cache_.load(std::memory_order_acquire)) {
+            int64_t gate;
+            int idle = 0;
+            while (wrap > (gate = gating_sequence())) {
+                if (++idle > 64) std::this_thread::yield();
+            }
+            gating_cache_.store(gate, std::memory_order_release);
+        }
+        return first;
+    }
+
+    /**
+     * try_claim — like claim() but fails (returns -1) instead of waiting
+     * when the ring doesn't have n free slots.
+     */
+    int64_t try_claim(size_t n = 1) {
+        check_claim(n);
+        int64_t first = next_.load(std::memory_order_relaxed);
+        do {
+            int64_t wrap = first + static_cast<int64_t>(n) - 1 - static_cast<int64_t>(Capacity);
+            if (wrap > gating_sequence()) return -1;
+        } while (!next_.compare_exchange_weak(first, first + static_cast<int64_t>(n),
+                                              std::memory_order_relaxed));
+        return first;
+    }
+
+    T&       operator[](int64_t seq)       { return slots_[static_cast<size_t>(seq) & MASK].data; }
+    const T& operator[](int64_t seq) const { return slots_[static_cast<size_t>(seq) & MASK].data; }
+
+    // Make [first, first+n) visible to consumers.
+    void publish(int64_t first, size_t n = 1) {
+        for (int64_t s = first; s < first + static_cast<int64_t>(n); ++s)
+            slots_[static_cast<size_t>(s) & MASK].lap.store(lap_of(s), std::memory_order_release);
+    }
+
+    // Convenience: claim one slot, let fill(T&) write it, publish it.
+    template<typename F>
+    int64_t publish_event(F&& fill) {
+        int64_t seq = claim(1);
+        fill((*this)[seq]);
+        publish(seq, 1);
+        return seq;
+    }
+
+    // Highest sequence handed out so far (claimed, maybe not published).
+    int64_t claimed() const { return next_.load(std::memory_order_acquire) - 1; }
+
+    // Slowest consumer cursor — how far producers may advance.
+    int64_t gating_sequence() const {
+        int64_t min = next_.load(std::memory_order_relaxed) - 1;
+        for (const auto& c : consumers_)
+            min = std::min(min, c->cursor_.load(std::memory_order_acquire));
+        return min;
+    }
+
+    size_t consumer_count() const { return consumers_.size(); }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr int    SHIFT = [] { int k = 0; while ((size_t{1} << k) < Capacity) ++k; return k; }();
+
+    static int64_t lap_of(int64_t seq) { return seq >> SHIFT; }
+
+    void check_claim(size_t n) {
+        if (n == 0 || n > Capacity)
+            throw std::invalid_argument("MulticastRing: claim size must be 1..Capacity");
+        if (consumers_.empty())
+            throw std::logic_error("MulticastRing: no consumers — producers would never be gated");
+        started_.store(true, std::memory_order_relaxed);
+    }
+
+    // Highest sequence `c` may handle, given it wants `next`.
+    int64_t available_to(const Consumer& c, int64_t next) const {
+        if (!c.deps_.empty()) {
+            // Upstream consumers only advance over published events.
+            int64_t limit = INT64_MAX;
+            for (const Consumer* d : c.deps_)
+                limit = std::min(limit, d->cursor_.load(std::memory_order_acquire));
+            return limit;
+        }
+        int64_t hi = next_.load(std::memory_order_acquire) - 1;
+        int64_t s  = next;
+        while (s <= hi &&
+               slots_[static_cast<size_t>(s) & MASK].lap.load(std::memory_order_acquire) == lap_of(s))
+            ++s;
+        return s - 1;
+    }
+
+    // One cache line per slot keeps producers writing neighbouring
+    // sequences from invalidating each other.
+    struct alignas(64) Slot {
+        std::atomic<int64_t> lap{-1};
+        T                    data{};
+    };
+
+    std::unique_ptr<Slot[]>                slots_{new Slot[Capacity]};
+    std::vector<std::unique_ptr<Consumer>> consumers_;
+    alignas(64) std::atomic<int64_t>       next_{0};     // next sequence to claim
+    alignas(64) std::atomic<int64_t>       gating_cache_{-1};
+    std::atomic<bool>                      started_{false};
+};
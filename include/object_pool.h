@@ -0,0 +1,289 @@
+#pragma once
+
+/**
+ * object_pool.h — Lock-free object pool with per-thread magazines
+ * ================================================================
+ *
+ * THE PROBLEM:
+ * ------------
+ * A request that arrives, gets decoded into a std::vector<char>, answered
+ * and encoded into another vector pays malloc + free for every buffer —
+ * and free() of a block malloc'ed on another thread is the slow path of
+ * every general-purpose allocator. The objects are the same shape every
+ * time; recycling them (with their capacity) skips the allocator entirely.
+ *
+ * TWO LEVELS (Bonwick's magazine/depot design, as in Solaris kmem/umem):
+ * -----------------------------------------------------------------------
+ *
+ *   thread A                thread B
+ *   ┌──────────────┐       ┌──────────────┐
+ *   │ magazine     │       │ magazine     │   ← plain array, no atomics:
+ *   │ [o][o][o][ ] │       │ [o][ ][ ][ ] │     acquire/release is a push/pop
+ *   └──────┬───────┘       └──────┬───────┘
+ *          │ full: spill M        │ empty: refill M
+ *          ▼                      ▲
+ *        ┌──────────────────────────────┐
+ *        │ depot: Treiber stack of      │   ← one CAS moves M objects
+ *        │ CHAINS of M objects          │
+ *        └──────────────────────────────┘
+ *                     │ empty → new object (a "miss")
+ *
+ * Only 1 in M operations touches shared memory at all, and when it does a
+ * single CAS moves a whole chain.
+ *
+ * ABA AND TAGGED POINTERS:
+ * ------------------------
+ * Treiber pop reads head H and H->next, then CASes head from H to next.
+ * If, in between, another thread pops H, pops next, and pushes H back,
+ * the CAS still sees H and succeeds — installing a `next` that is in use.
+ * The fix: pack a 16-bit version TAG into the unused top bits of the
+ * 64-bit pointer (x86-64 and AArch64 user addresses fit in 48 bits) and
+ * bump it on every push. The recycled H now has a different tag, so the
+ * stale CAS fails. Nodes are never freed while the pool lives, so reading
+ * H->next after someone else took H is safe — the value is just stale.
+ *
+ * OWNERSHIP:
+ * ----------
+ *   acquire() returns a move-only Handle; its destructor puts the object
+ *   back in the CURRENT thread's magazine. Objects are never destroyed
+ *   on release — callers reset what they need (clear(), not shrink).
+ *   The pool must outlive every Handle.
+ *   Magazines flush back to the depot when their thread exits.
+ *
+ * METRICS (when a registry is given):
+ *   <name>_hits_total      acquires served from a magazine or the depot
+ *   <name>_misses_total    acquires that had to construct a new object
+ *   <name>_objects         objects ever created (live + cached)
+ *   <name>_bytes           objects × sizeof(node) (shallow footprint)
+ * Hit/miss counters are flushed once per magazine exchange, not per call.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "metrics.h"
+
+template<typename T, size_t MagazineSize = 32>
+class ObjectPool {
+    static_assert(sizeof(void*) == 8, "ObjectPool packs a tag into 64-bit pointers");
+    static_assert(MagazineSize >= 1, "MagazineSize must be >= 1");
+
+    struct Node {
+        T                  value{};
+        Node*              next = nullptr;        // next object in this chain
+        std::atomic<Node*> next_chain{nullptr};   // depot link (head only)
+        Node*              next_alloc = nullptr;  // every node, for teardown
+    };
+
+    // Shared part. Held by shared_ptr so a thread's magazine can still
+    // return its objects after the ObjectPool itself is gone.
+    struct Depot {
+        std::atomic<uint64_t> head{0};            // tagged Node* of first chain
+        std::atomic<Node*>    all{nullptr};       // every node ever created
+        std::atomic<size_t>   objects{0};
+        std::atomic<uint64_t> hits{0}, misses{0};
+        std::atomic<bool>     closed{false};
+
+        ~Depot() {
+            Node* n = all.load(std::memory_order_acquire);
+            while (n) { Node* next = n->next_alloc; delete n; n = next; }
+        }
+    };
+
+public:
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(Handle&& o) noexcept : pool_(o.pool_), node_(std::exchange(o.node_, nullptr)) {}
+        Handle& operator=(Handle&& o) noexcept {
+            if (this != &o) { reset(); pool_ = o.pool_; node_ = std::exchange(o.node_, nullptr); }
+            return *this;
+        }
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle() { reset(); }
+
+        T* get()        const { return node_ ? &node_->value : nullptr; }
+        T& operator*()  const { return node_->value; }
+        T* operator->() const { return &node_->value; }
+        explicit operator bool() const { return node_ != nullptr; }
+
+        // Return the object to the pool now.
+        void reset() { if (node_) pool_->release(std::exchange(node_, nullptr)); }
+
+    private:
+        friend class ObjectPool;
+        Handle(ObjectPool* pool, Node* node) : pool_(pool), node_(node) {}
+        ObjectPool* pool_ = nullptr;
+        Node*       node_ = nullptr;
+    };
+
+    explicit ObjectPool(MetricsRegistry* registry = nullptr,
+                        const std::string& name = "object_pool")
+        : depot_(std::make_shared<Depot>())
+    {
+        if (registry) {
+            hits_c_    = registry->add_counter(name + "_hits_total",
+                             "Acquires served from a cached object");
+            misses_c_  = registry->add_counter(name + "_misses_total",
+                             "Acquires that constructed a new object");
+            objects_g_ = registry->add_gauge(name + "_objects",
+                             "Objects created by the pool (live + cached)");
+            bytes_g_   = registry->add_gauge(name + "_bytes",
+                             "Shallow memory footprint of pooled objects");
+        }
+    }
+
+    ~ObjectPool() { depot_->closed.store(true, std::memory_order_release); }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    Handle acquire() {
+        Magazine& mag = magazine();
+        if (mag.items.empty()) refill(mag);
+        Node* n;
+        if (!mag.items.empty()) {
+            n = mag.items.back();
+            mag.items.pop_back();
+            ++mag.hits;
+        } else {
+            n = create();
+            ++mag.misses;
+        }
+        return Handle(this, n);
+    }
+
+    uint64_t hits()    const { return depot_->hits.load(std::memory_order_relaxed); }
+    uint64_t misses()  const { return depot_->misses.load(std::memory_order_relaxed); }
+    size_t   objects() const { return depot_->objects.load(std::memory_order_relaxed); }
+    size_t   bytes()   const { return objects() * sizeof(Node); }
+
+    // Push the calling thread's pending hit/miss counts to the totals
+    // (they are otherwise flushed once per magazine exchange).
+    void flush_stats() { flush_stats(magazine()); }
+
+private:
+    static constexpr uint64_t PTR_MASK = (uint64_t{1} << 48) - 1;
+
+    static uint64_t pack(Node* n, uint64_t tag) {
+        return (tag << 48) | reinterpret_cast<uint64_t>(n);
+    }
+    static Node*    ptr_of(uint64_t v) { return reinterpret_cast<Node*>(v & PTR_MASK); }
+    static uint64_t tag_of(uint64_t v) { return v >> 48; }
+
+    struct Magazine {
+        std::shared_ptr<Depot> depot;
+        std::vector<Node*>     items;     // capacity 2*MagazineSize
+        uint64_t               hits = 0, misses = 0;
+
+        ~Magazine() {
+            if (!depot) return;
+            depot->hits.fetch_add(hits, std::memory_order_relaxed);
+            depot->misses.fetch_add(misses, std::memory_order_relaxed);
+            while (!items.empty()) push_chain(*depot, items, items.size());
+        }
+        Magazine() = default;
+        Magazine(Magazine&&) = default;
+        Magazine& operator=(Magazine&&) = default;
+    };
+
+    // One small vector per thread, one entry per live pool it has used.
+    static inline thread_local std::vector<Magazine> tls_magazines_{};
+
+    Magazine& magazine() {
+        auto& mags = tls_magazines_;
+        for (size_t i = 0; i < mags.size(); ++i) {
+            if (mags[i].depot == depot_) return mags[i];
+            if (mags[i].depot->closed.load(std::memory_order_acquire)) {
+                // Pool is gone: drop our reference so the depot can die.
+                std::swap(mags[i], mags.back());
+                mags.pop_back();
+                --i;
+            }
+        }
+        mags.emplace_back();
+        mags.back().depot = depot_;
+        mags.back().items.reserve(2 * MagazineSize);
+        return mags.back();
+    }
+
+    void release(Node* n) {
+        Magazine& mag = magazine();
+        if (mag.items.size() >= 2 * MagazineSize) {
+            push_chain(*depot_, mag.items, MagazineSize);
+            flush_stats(mag);
+        }
+        mag.items.push_back(n);
+    }
+
+    void refill(Magazine& mag) {
+        uint64_t head = depot_->head.load(std::memory_order_acquire);
+        while (Node* chain = ptr_of(head)) {
+            Node* rest = chain->next_chain.load(std::memory_order_relaxed);
+            if (depot_->head.compare_exchange_weak(head, pack(rest, tag_of(head)),
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                for (Node* n = chain; n; n = n->next) mag.items.push_back(n);
+                break;
+            }
+        }
+        flush_stats(mag);
+    }
+
+    // Link the last `k` items into a chain and push it with one CAS.
+    static void push_chain(Depot& depot, std::vector<Node*>& items, size_t k) {
+        Node* first = nullptr;
+        for (size_t i = 0; i < k; ++i) {
+            Node* n = items.back();
+            items.pop_back();
+            n->next = first;
+            first = n;
+        }
+        uint64_t head = depot.head.load(std::memory_order_relaxed);
+        do {
+            first->next_chain.store(ptr_of(head), std::memory_order_relaxed);
+        } while (!depot.head.compare_exchange_weak(head, pack(first, tag_of(head) + 1),
+                     std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Node* create() {
+        Node* n = new Node;
+        if (reinterpret_cast<uint64_t>(n) & ~PTR_MASK) {
+            delete n;
+            throw std::runtime_error("ObjectPool: pointer does not fit in 48 bits");
+        }
+        Node* all = depot_->all.load(std::memory_order_relaxed);
+        do { n->next_alloc = all; }
+        while (!depot_->all.compare_exchange_weak(all, n,
+                   std::memory_order_release, std::memory_order_relaxed));
+        size_t objs = depot_->objects.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (objects_g_) {
+            objects_g_->set(static_cast<int64_t>(objs));
+            bytes_g_->set(static_cast<int64_t>(objs * sizeof(Node)));
+        }
+        return n;
+    }
+
+    void flush_stats(Magazine& mag) {
+        if (mag.hits) {
+            depot_->hits.fetch_add(mag.hits, std::memory_order_relaxed);
+            if (hits_c_) hits_c_->inc(mag.hits);
+        }
+        if (mag.misses) {
+            depot_->misses.fetch_add(mag.misses, std::memory_order_relaxed);
+            if (misses_c_) misses_c_->inc(mag.misses);
+        }
+        mag.hits = mag.misses = 0;
+    }
+
+    std::shared_ptr<Depot> depot_;
+    Counter* hits_c_{nullptr};
+    Counter* misses_c_{nullptr};
+    Gauge*   objects_g_{nullptr};
+    Gauge*   bytes_g_{nullptr};
+};
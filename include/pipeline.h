@@ -0,0 +1,401 @@
+#pragma once
+
+/**
+ * pipeline.h — Bounded multi-stage pipeline on the lock-free pool
+ * ================================================================
+ *
+ * THE PROBLEM WITH CHAINED FUTURES:
+ * ---------------------------------
+ *   auto a = pool.enqueue(decode, raw);      // worker 1 touches raw
+ *   auto b = pool.enqueue(transform, a.get()); // worker 3 — cold cache
+ *   auto c = pool.enqueue(encode, b.get());    // worker 2 — cold again
+ *
+ * Every stage is a separate submission: a packaged_task, a future, a
+ * round trip through the shared queue, and the data hops between cores.
+ * Nothing bounds how much work is in flight either — a fast producer
+ * fills memory with half-finished items.
+ *
+ * THE PIPELINE MODEL (same idea as TBB's parallel_pipeline):
+ * -----------------------------------------------------------
+ *
+ *   push(item) ──► [ token pool: MaxTokens ] ── empty? → backpressure
+ *                        │
+ *                        ▼
+ *                 stage 0 ──► stage 1 ──► stage 2 ──► retire token
+ *
+ * An item travels inside a TOKEN. There are exactly MaxTokens tokens, so
+ * at most MaxTokens items are ever in flight — push() waits (try_push()
+ * fails) until the last stage retires one.
+ *
+ * The worker that finishes stage k on a token CARRIES it straight into
+ * stage k+1 whenever that stage has room. The item stays in the same
+ * core's cache for the whole journey and costs no queue round trip.
+ * Only when stage k+1 is saturated does the token wait in that stage's
+ * LockFreeQueue, to be picked up by whichever worker frees a seat.
+ *
+ * STAGE MODES:
+ * ------------
+ *   Parallel(degree)   up to `degree` tokens inside the stage at once.
+ *   SerialInOrder      one token at a time, in push() order. Tokens that
+ *                      arrive early wait in a reorder window indexed by
+ *                      sequence number. Use for encoders/writers whose
+ *                      output must stay ordered.
+ *
+ * Stage functions take T& and transform the item in place. They should
+ * not throw: an exception is counted in <name>_<stage>_errors_total and
+ * the token continues to the next stage unchanged.
+ *
+ * POOL QUEUE BOUND:
+ * -----------------
+ * Stage hand-offs are post()s from worker threads, where a full pool
+ * queue would mean a throw and std::terminate. So the number of tasks
+ * queued at once is bounded by construction:
+ *   • a token is owned by at most one queued task (its dispatch or
+ *     forward) — ≤ MaxTokens;
+ *   • each stage has at most one pump queued and not yet started
+ *     (pump_posted) — ≤ stage count.
+ * MaxTokens + stages ≤ QueueCapacity is checked (static_assert for
+ * MaxTokens, add_stage() for the stages), so the queue never fills.
+ *
+ * METRICS (per stage, when a registry is given):
+ *   <name>_<stage>_tokens_total    tokens processed  (throughput = rate())
+ *   <name>_<stage>_active          tokens executing  (occupancy = active/degree)
+ *   <name>_<stage>_queued          tokens waiting to enter the stage
+ *   <name>_<stage>_errors_total    stage functions that threw
+ *   <name>_tokens_in_flight        admitted but not yet retired
+ */
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include "lockfree_queue.h"
+#include "threadpool_v2.h"
+#include "metrics.h"
+
+enum class StageMode {
+    SerialInOrder,
+    Parallel,
+};
+
+template<typename T, size_t MaxTokens = 256, size_t QueueCapacity = 4096>
+class Pipeline {
+    static_assert((MaxTokens & (MaxTokens - 1)) == 0 && MaxTokens >= 2,
+                  "MaxTokens must be a power of 2 and >= 2");
+    static_assert(MaxTokens < QueueCapacity,
+                  "QueueCapacity must exceed MaxTokens (see POOL QUEUE BOUND)");
+
+public:
+    using StageFn = std::function<void(T&)>;
+
+    explicit Pipeline(size_t num_threads = std::thread::hardware_concurrency(),
+                      MetricsRegistry* registry = nullptr,
+                      std::string name = "pipeline")
+        : name_(std::move(name))
+        , tokens_(new Token[MaxTokens])
+        , pool_(num_threads)
+    {
+        if (!registry) {
+            private_registry_ = std::make_unique<MetricsRegistry>();
+            registry = private_registry_.get();
+        }
+        registry_ = registry;
+
+        for (size_t i = 0; i < MaxTokens; ++i)
+            free_.try_enqueue(&tokens_[i]);
+
+        in_flight_ = registry_->add_gauge(
+            name_ + "_tokens_in_flight",
+            "Tokens admitted into the pipeline and not yet retired", /*sharded=*/true);
+    }
+
+    // ── Builder ─────────────────────────────────────────────────
+    Pipeline& add_serial_stage(std::string stage_name, StageFn fn) {
+        return add_stage(std::move(stage_name), StageMode::SerialInOrder, 1, std::move(fn));
+    }
+
+    Pipeline& add_parallel_stage(std::string stage_name, size_t degree, StageFn fn) {
+        if (degree == 0)
+            throw std::invalid_argument("Pipeline: parallel degree must be >= 1");
+        return add_stage(std::move(stage_name), StageMode::Parallel, degree, std::move(fn));
+    }
+
+    // ── Feeding ─────────────────────────────────────────────────
+    /**
+     * try_push — admit an item if a token is free.
+     * Returns false when MaxTokens items are already in flight.
+     */
+    bool try_push(T item) {
+        if (stages_.empty())
+            throw std::logic_error("Pipeline: add at least one stage before push");
+
+        auto tok = free_.try_dequeue();
+        if (!tok) return false;
+
+        Token* t = *tok;
+        t->value = std::move(item);
+        t->seq   = next_seq_.fetch_add(1, std::memory_order_relaxed);
+        started_.store(true, std::memory_order_relaxed);
+        in_flight_->inc();
+
+        // The producer thread does not run stages itself; hand the
+        // token to a worker, which then carries it as far as it can.
+        pool_.post([this, t] { dispatch(0, t); });
+        return true;
+    }
+
+    // push — like try_push, but waits for a free token (backpressure).
+    void push(T item) {
+        while (!try_push(item))
+            std::this_thread::yield();
+    }
+
+    // wait — block until every admitted item has left the last stage.
+    void wait() {
+        while (in_flight_->get() > 0)
+            std::this_thread::yield();
+        // Drain stray pump tasks so nothing touches stages after we return.
+        pool_.wait_all();
+    }
+
+    // ── Introspection ───────────────────────────────────────────
+    struct StageStats {
+        std::string name;
+        StageMode   mode;
+        size_t      degree;
+        uint64_t    processed;
+        int64_t     active;
+        int64_t     queued;
+    };
+
+    StageStats stage_stats(size_t i) const {
+        const Stage& s = *stages_.at(i);
+        return { s.name, s.mode, s.degree, s.processed->get(),
+                 s.active->get(), s.queued->get() };
+    }
+
+    size_t stage_count() const { return stages_.size(); }
+    size_t in_flight()   const { return static_cast<size_t>(in_flight_->get()); }
+    static constexpr size_t max_tokens() { return MaxTokens; }
+
+    ~Pipeline() { wait(); }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+private:
+    static constexpr size_t WINDOW_MASK = MaxTokens - 1;
+
+    struct Token {
+        T        value{};
+        uint64_t seq{0};
+    };
+
+    struct Stage {
+        std::string name;
+        StageMode   mode;
+        size_t      degree;
+        StageFn     fn;
+
+        // Parallel: tokens waiting for a seat.
+        LockFreeQueue<Token*, MaxTokens> input;
+        alignas(64) std::atomic<size_t>  running{0};
+        std::atomic<bool>                pump_posted{false};   // queued, not yet started
+
+        // SerialInOrder: reorder window indexed by seq, plus the
+        // "someone is draining" flag and the next seq to admit.
+        std::unique_ptr<std::atomic<Token*>[]> window;
+        alignas(64) std::atomic<bool>          busy{false};
+        std::atomic<uint64_t>                  next_seq{0};
+
+        Counter* processed{nullptr};
+        Counter* errors{nullptr};
+        Gauge*   active{nullptr};
+        Gauge*   queued{nullptr};
+    };
+
+    Pipeline& add_stage(std::string stage_name, StageMode mode, size_t degree, StageFn fn) {
+        if (started_.load(std::memory_order_relaxed))
+            throw std::logic_error("Pipeline: stages must be added before the first push");
+        if (MaxTokens + stages_.size() + 1 > QueueCapacity)
+            throw std::logic_error("Pipeline: MaxTokens + stages exceeds QueueCapacity");
+
+        auto s = std::make_unique<Stage>();
+        s->mode   = mode;
+        s->degree = degree;
+        s->fn     = std::move(fn);
+        if (mode == StageMode::SerialInOrder) {
+            s->window.reset(new std::atomic<Token*>[MaxTokens]);
+            for (size_t i = 0; i < MaxTokens; ++i)
+                s->window[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        std::string prefix = name_ + "_" + stage_name;
+        s->processed = registry_->add_counter(prefix + "_tokens_total",
+            "Tokens processed by pipeline stage " + stage_name);
+        s->errors = registry_->add_counter(prefix + "_errors_total",
+            "Stage function exceptions in pipeline stage " + stage_name);
+        s->active = registry_->add_gauge(prefix + "_active",
+            "Tokens currently executing in pipeline stage " + stage_name, /*sharded=*/true);
+        s->queued = registry_->add_gauge(prefix + "_queued",
+            "Tokens waiting to enter pipeline stage " + stage_name, /*sharded=*/true);
+        s->name = std::move(stage_name);
+
+        stages_.push_back(std::move(s));
+        return *this;
+    }
+
+    /**
+     * dispatch — carry token t from stage k to the end, as far as the
+     * current worker is allowed to. Returns when the token is retired or
+     * parked in a stage that has no free seat.
+     */
+    void dispatch(size_t k, Token* t) {
+        while (k < stages_.size()) {
+            Stage& s = *stages_[k];
+
+            if (s.mode == StageMode::Parallel) {
+                if (!try_enter(s)) {
+                    s.queued->inc();
+                    s.input.try_enqueue(t);   // never full: ≤ MaxTokens tokens exist
+                    kick(k);
+                    return;
+                }
+                run(s, t);
+                leave(s);
+                kick(k);
+            } else {
+                s.queued->inc();
+                s.window[t->seq & WINDOW_MASK].store(t, std::memory_order_release);
+                t = drain_serial(k);
+                if (!t) return;               // another worker owns the stage
+            }
+            ++k;
+        }
+        retire(t);
+    }
+
+    bool try_enter(Stage& s) {
+        size_t r = s.running.load(std::memory_order_relaxed);
+        while (r < s.degree) {
+            if (s.running.compare_exchange_weak(r, r + 1, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    void leave(Stage& s) { s.running.fetch_sub(1, std::memory_order_acq_rel); }
+
+    /**
+     * kick — if stage k has parked tokens and a free seat, post a pump,
+     * unless one is already queued (see POOL QUEUE BOUND).
+     *
+     * Called by BOTH sides of the race: the worker that parked a token
+     * (after enqueueing) and the worker that freed a seat (after leaving).
+     * The seq_cst fence makes sure at least one of them sees the other's
+     * write, so a parked token can never be stranded. A kick that finds a
+     * pump already queued can skip: that pump has not started, so its
+     * own try_enter and kick come after everything this kick saw.
+     */
+    void kick(size_t k) {
+        Stage& s = *stages_[k];
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (s.input.empty() || s.running.load(std::memory_order_relaxed) >= s.degree)
+            return;
+        if (!s.pump_posted.exchange(true, std::memory_order_seq_cst))
+            pool_.post([this, k] { pump(k); });
+    }
+
+    void pump(size_t k) {
+        Stage& s = *stages_[k];
+        s.pump_posted.store(false, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!try_enter(s)) return;            // the seat holder will kick again
+        auto t = s.input.try_dequeue();
+        if (!t) { leave(s); kick(k); return; }
+        s.queued->dec();
+        kick(k);                              // more parked tokens, more seats: next pump
+        run(s, *t);
+        leave(s);
+        kick(k);
+        dispatch(k + 1, *t);
+    }
+
+    /**
+     * drain_serial — process every token that is next in sequence.
+     *
+     * Whoever wins `busy` drains the window in order. All but the last
+     * drained token are forwarded as new pool tasks; the last one is
+     * returned so this worker carries it onward (locality for the common
+     * one-token case). Returns nullptr if another worker owns the stage.
+     */
+    Token* drain_serial(size_t k) {
+        Stage& s = *stages_[k];
+        Token* carry = nullptr;
+
+        while (true) {
+            bool expected = false;
+            if (!s.busy.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                break;
+
+            uint64_t next = s.next_seq.load(std::memory_order_relaxed);
+            while (Token* t = s.window[next & WINDOW_MASK].exchange(
+                       nullptr, std::memory_order_acq_rel)) {
+                s.queued->dec();
+                if (carry) forward(k + 1, carry);
+                run(s, t);
+                s.next_seq.store(++next, std::memory_order_relaxed);
+                carry = t;
+            }
+
+            s.busy.store(false, std::memory_order_release);
+            // Same Dekker pattern as kick(): a token stored into the window
+            // after our last exchange must be seen either by us here or by
+            // its owner's CAS on busy.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (s.window[next & WINDOW_MASK].load(std::memory_order_acquire) == nullptr)
+                break;
+        }
+        return carry;
+    }
+
+    void forward(size_t k, Token* t) {
+        pool_.post([this, k, t] { dispatch(k, t); });
+    }
+
+    void run(Stage& s, Token* t) {
+        s.active->inc();
+        try {
+            s.fn(t->value);
+        } catch (...) {
+            s.errors->inc();
+        }
+        s.active->dec();
+        s.processed->inc();
+    }
+
+    void retire(Token* t) {
+        free_.try_enqueue(t);
+        in_flight_->dec();
+    }
+
+    std::string                          name_;
+    std::unique_ptr<Token[]>             tokens_;
+    LockFreeQueue<Token*, MaxTokens>     free_;
+    std::vector<std::unique_ptr<Stage>>  stages_;
+    std::atomic<uint64_t>                next_seq_{0};
+    std::atomic<bool>                    started_{false};
+
+    std::unique_ptr<MetricsRegistry>     private_registry_;
+    MetricsRegistry*                     registry_{nullptr};
+    Gauge*                               in_flight_{nullptr};
+
+    // Declared last → destroyed first: workers are joined before the
+    // stages and tokens their tasks point at go away.
+    ThreadPoolV2<QueueCapacity>          pool_;
+};
@@ -47,6 +47,16 @@
  *   ERROR:    server → client  "something went wrong"
  *   PING:     client → server  "are you alive?"
  *   PONG:     server → client  "yes, I'm alive" (health check)
+ *
+ * BUFFER RECYCLING:
+ * -----------------
+ * A naive request costs four heap buffers: the received payload, the
+ * response payload and two encoded frames. send_message() encodes into a
+ * scratch vector from buffer_pool(), and PooledMessage borrows its payload
+ * vector from the same pool, so in steady state those buffers are reused
+ * — capacity included — and never reach malloc. Buffers that grew past
+ * MAX_POOLED_CAPACITY are shrunk before going back, so one 64 MB request
+ * doesn't pin 64 MB per thread forever.
  */
 
 #include <cstdint>
@@ -55,6 +65,8 @@
 #include <stdexcept>
 #include <cstring>
 
+#include "object_pool.h"
+
 // POSIX socket headers
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -113,11 +125,60 @@ struct Message {
 // ─────────────────────────────────────────────────────────────
 static constexpr size_t HEADER_SIZE = 9;  // 1 + 4 + 4
 
-// Serialize a Message into bytes ready to send over TCP
-inline std::vector<char> encode(const Message& msg) {
+// ─────────────────────────────────────────────────────────────
+// Buffer pools. TaskServer owns one (with metrics); everything
+// else defaults to the process-wide buffer_pool().
+// ─────────────────────────────────────────────────────────────
+using BufferPool = ObjectPool<std::vector<char>>;
+
+static constexpr size_t MAX_POOLED_CAPACITY = 1 << 20;  // 1 MB
+
+inline BufferPool& buffer_pool() {
+    static BufferPool pool;
+    return pool;
+}
+
+// Drop oversized buffers' memory before they go back to the pool.
+inline void recycle_buffer(std::vector<char>& buf) {
+    if (buf.capacity() > MAX_POOLED_CAPACITY) std::vector<char>().swap(buf);
+    else                                      buf.clear();
+}
+
+// ─────────────────────────────────────────────────────────────
+// PooledMessage — a Message whose payload vector is borrowed from
+// buffer_pool() and handed back (capacity intact) on destruction.
+// Reusing one PooledMessage across recv_message() calls is cheaper
+// still: its payload only ever grows.
+// ─────────────────────────────────────────────────────────────
+struct PooledMessage : Message {
+    explicit PooledMessage(BufferPool& pool = buffer_pool())
+        : buf_(pool.acquire()) { payload.swap(*buf_); }
+
+    PooledMessage(MessageType t, uint32_t i, const std::string& data,
+                  BufferPool& pool = buffer_pool())
+        : PooledMessage(pool) {
+        type = t;
+        id   = i;
+        payload.assign(data.begin(), data.end());
+    }
+
+    ~PooledMessage() {
+        recycle_buffer(payload);
+        payload.swap(*buf_);
+    }
+
+    PooledMessage(const PooledMessage&) = delete;
+    PooledMessage& operator=(const PooledMessage&) = delete;
+
+private:
+    BufferPool::Handle buf_;
+};
+
+// Serialize a Message into `buf` (resized to fit; capacity is reused)
+inline void encode_into(const Message& msg, std::vector<char>& buf) {
     uint32_t payload_len = static_cast<uint32_t>(msg.payload.size());
 
-    std::vector<char> buf(HEADER_SIZE + payload_len);
+    buf.resize(HEADER_SIZE + payload_len);
 
     // type (1 byte)
     buf[0] = static_cast<char>(msg.type);
@@ -133,7 +194,12 @@ inline std::vector<char> encode(const Message& msg) {
     // payload
     if (payload_len > 0)
         std::memcpy(&buf[HEADER_SIZE], msg.payload.data(), payload_len);
+}
 
+// Serialize a Message into bytes ready to send over TCP
+inline std::vector<char> encode(const Message& msg) {
+    std::vector<char> buf;
+    encode_into(msg, buf);
     return buf;
 }
 
@@ -164,10 +230,13 @@ inline bool recv_all(int fd, char* buf, size_t len) {
     return true;
 }
 
-// Send a Message over a socket
-inline bool send_message(int fd, const Message& msg) {
-    auto buf = encode(msg);
-    return send_all(fd, buf.data(), buf.size());
+// Send a Message over a socket (frame built in a pooled scratch buffer)
+inline bool send_message(int fd, const Message& msg, BufferPool& pool = buffer_pool()) {
+    auto buf = pool.acquire();
+    encode_into(msg, *buf);
+    bool ok = send_all(fd, buf->data(), buf->size());
+    recycle_buffer(*buf);
+    return ok;
 }
 
 // Receive a Message from a socket
@@ -0,0 +1,669 @@
+#pragma once
+
+/**
+ * reclaim.h — Safe memory reclamation: epochs and hazard pointers
+ * ================================================================
+ *
+ * THE PROBLEM:
+ * ------------
+ * A lock-free structure unlinks a node with one CAS — but another thread
+ * may have loaded the pointer a moment earlier and be about to read
+ * through it. `delete` right after the unlink is a use-after-free; never
+ * deleting is a leak. Something has to decide WHEN nobody can still hold
+ * the pointer. Every structure that frees memory while others read it
+ * (ConcurrentHashMap's old tables, list nodes, swapped-out configs)
+ * needs that decision, so it lives here once:
+ *
+ *   Epoch    epoch-based reclamation (EBR). Readers announce "I'm inside"
+ *            with one store; memory is freed in batches two epochs later.
+ *            Cheapest reads; garbage is unbounded if a reader stalls.
+ *   Hazard   hazard pointers. Readers publish the exact pointer they are
+ *            about to use; a retired node is freed as soon as no hazard
+ *            names it. A store + re-check per pointer; garbage bounded.
+ *
+ * EPOCH-BASED RECLAMATION (Fraser; the crossbeam-epoch design):
+ * ------------------------------------------------------------
+ *
+ *   global epoch G ─────────────── 7 ──────── 8 ──────── 9 ───▶
+ *
+ *   thread A   [Guard@7 .. reads .. ]            [Guard@9 ..]
+ *   thread B        retire(x) → bag[7]           free bag[7] (G ≥ 7+2)
+ *   thread C                   [Guard@8 ..  ]
+ *
+ *   • Guard (enter): record "active in epoch G" in the thread's record,
+ *     then a full fence. Leaving clears the active bit. Nested guards
+ *     are a counter bump.
+ *   • retire(p): file p in this thread's bag for the current epoch.
+ *     Nothing is freed yet.
+ *   • G advances from e to e+1 only when every ACTIVE record shows e.
+ *     So once G reaches r+2, no guard that started in epoch ≤ r is still
+ *     open — and only those could have seen a node retired in epoch r.
+ *
+ * Each thread keeps three bags (epochs e, e-1, e-2, indexed e % 3); a bag
+ * whose epoch is two behind G is freed wholesale. Reclamation is
+ * AMORTIZED: every COLLECT_EVERY retires the thread tries to advance G
+ * and frees its expired bags, and pool workers (threadpool_v2.h) call
+ * collect() when they go idle, so reclamation costs nothing on the
+ * request path of a busy server. Records are per thread, never shared
+ * for writing, and the reader fast path touches only its own line.
+ *
+ * Weakness: one thread stuck inside a Guard (preempted, blocked on I/O)
+ * pins G, and every thread's garbage piles up behind it.
+ *
+ * HAZARD POINTERS (Michael, 2004):
+ * --------------------------------
+ *
+ *   thread A:  Hazard::Pointer hp;  Node* n = hp.protect(head);
+ *              │ slot ← n, re-read head: still n? then n is safe to use
+ *   thread B:  unlink n; Hazard::retire(n);
+ *              │ retired list ≥ threshold → scan: snapshot every slot,
+ *              │ free each retired node no slot names, keep the rest
+ *
+ * Each thread owns SLOTS hazard slots. A scan runs once a thread has
+ * max(MIN_SCAN, 2 × all slots) nodes retired, so at most `all slots`
+ * survive it: the garbage per thread is BOUNDED no matter what readers
+ * do, and a scan frees at least half its list — O(1) amortized per
+ * retire. The price is paid by readers: a seq_cst store and a re-load
+ * for every pointer they traverse, against one store per Guard for EBR.
+ *
+ * CHOOSING:
+ *
+ *                         Epoch                 Hazard
+ *   read-side cost        1 store + fence       1 store + fence per node
+ *                         per critical section
+ *   unreclaimed memory    unbounded if a        ≤ threshold per thread
+ *                         reader stalls
+ *   traversal API         any pointers inside   must protect() each one
+ *                         the Guard
+ *
+ * Use Epoch by default; use Hazard when readers may block or run for a
+ * long time, or nodes are big enough that a stall must not pin them.
+ *
+ * THREADS:
+ * --------
+ * A thread gets a record on first use (or Epoch::register_thread(),
+ * which pool workers call on startup so their first Guard doesn't take
+ * the registry mutex). Like arena heaps (arena.h), records are never
+ * freed: an exiting thread ABANDONS its record — its retired nodes go to
+ * a shared orphan list that the next collect()/scan() frees — and the
+ * next new thread ADOPTS it. Records are bounded by peak live threads.
+ *
+ * Deleters run on whichever thread reclaims, possibly long after
+ * retire(); they may retire further nodes but must not block.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// A node waiting to be freed: what to free, how, and how big it was.
+struct RetiredPtr {
+    void*  ptr;
+    void (*deleter)(void*);
+    size_t bytes;
+
+    template<typename T>
+    static void delete_as(void* p) { delete static_cast<T*>(p); }
+};
+
+// ════════════════════════════════════════════════════════════════
+// Epoch — epoch-based reclamation
+// ════════════════════════════════════════════════════════════════
+
+class Epoch {
+    struct Record;
+
+public:
+    static constexpr uint32_t COLLECT_EVERY = 64;   // retires between amortized collections
+
+    /**
+     * Guard — pointers loaded from a lock-free structure while a Guard is
+     * alive stay valid until it is destroyed. Nestable; cheap enough to
+     * open per operation.
+     */
+    class Guard {
+    public:
+        Guard() : rec_(tls_rec_ ? tls_rec_ : attach()) { enter(*rec_); }
+        ~Guard() {
+            leave(*rec_);
+            if (owned_) detach(rec_);
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        // Only reached from thread_local destructors after this thread's
+        // record was abandoned: borrow one for the Guard's lifetime.
+        Record* attach() {
+            if (Record* r = current()) return r;
+            owned_ = true;
+            return acquire();
+        }
+        bool    owned_ = false;   // declared first: attach() sets it
+        Record* rec_;
+    };
+
+    // Free p (with delete) once no Guard that could have seen it is open.
+    // Call after p has been unlinked from every shared structure.
+    template<typename T>
+    static void retire(T* p) { retire(p, &RetiredPtr::delete_as<T>, sizeof(T)); }
+    static void retire(void* p, void (*deleter)(void*), size_t bytes = 0);
+
+    // Give the calling thread its record now rather than on first use.
+    static void register_thread() { (void)current(); }
+
+    // Try to advance the epoch (twice if needed) and free every expired
+    // bag of this thread, plus expired orphans. Returns nodes freed.
+    // Returns immediately when there is nothing to free — cheap enough
+    // to call on every idle transition.
+    static size_t collect();
+
+    static uint64_t epoch()         { return global().epoch.load(std::memory_order_relaxed); }
+    static size_t   local_pending() { return tls_rec_ ? tls_rec_->pending_items.load(std::memory_order_relaxed) : 0; }
+    static size_t   pending();         // retired, not yet freed (process-wide)
+    static size_t   pending_bytes();
+    static uint64_t reclaimed()     { return global().reclaimed.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint64_t ACTIVE = 1;   // state = epoch << 1 | ACTIVE
+
+    struct Bag {
+        uint64_t                epoch = 0;
+        std::vector<RetiredPtr> items;
+    };
+
+    struct alignas(64) Record {
+        // Read by every advancing thread; written only by the owner.
+        std::atomic<uint64_t> state{0};
+        std::atomic<size_t>   pending_items{0};
+        std::atomic<size_t>   pending_bytes{0};
+
+        // Owner-only.
+        uint32_t depth         = 0;
+        uint32_t since_collect = 0;
+        bool     collecting    = false;
+        Bag      bags[3];
+        std::vector<RetiredPtr> scratch;   // recycled buffer for freeing a bag
+
+        Record* next_all  = nullptr;       // registry; immutable once published
+        Record* next_free = nullptr;
+    };
+
+    // Never destroyed: nodes may be retired from static destructors.
+    struct Global {
+        alignas(64) std::atomic<uint64_t> epoch{0};
+        alignas(64) std::atomic<Record*>  all{nullptr};
+        std::atomic<uint64_t> reclaimed{0};
+        std::mutex            mtx;          // registry, free list, orphans
+        Record*               free_list = nullptr;
+        std::vector<Bag>      orphans;
+        std::atomic<size_t>   orphan_items{0};
+        std::atomic<size_t>   orphan_bytes{0};
+    };
+    static Global& global() {
+        static Global* g = new Global;
+        return *g;
+    }
+
+    static void enter(Record& r) {
+        if (r.depth++) return;
+        Global& g = global();
+        uint64_t e = g.epoch.load(std::memory_order_relaxed);
+        while (true) {
+            // release: orders the previous section's reads before this
+            // store for whoever sees it; the fence orders it before ours.
+            r.state.store(e << 1 | ACTIVE, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint64_t now = g.epoch.load(std::memory_order_relaxed);
+            if (now == e) return;
+            e = now;   // announced a stale epoch: re-announce
+        }
+    }
+
+    static void leave(Record& r) {
+        if (--r.depth) return;
+        r.state.store(0, std::memory_order_release);
+    }
+
+    // G → G+1 if every active record is in G.
+    static bool try_advance() {
+        Global& g = global();
+        uint64_t e = g.epoch.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Record* r = g.all.load(std::memory_order_acquire); r; r = r->next_all) {
+            uint64_t s = r->state.load(std::memory_order_acquire);
+            if ((s & ACTIVE) && (s >> 1) != e) return false;
+        }
+        // A failed CAS means another thread advanced it — just as good.
+        g.epoch.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel,
+                                        std::memory_order_relaxed);
+        return true;
+    }
+
+    static void add_pending(Record& r, size_t items, size_t bytes, bool up) {
+        size_t i = r.pending_items.load(std::memory_order_relaxed);
+        size_t b = r.pending_bytes.load(std::memory_order_relaxed);
+        r.pending_items.store(up ? i + items : i - items, std::memory_order_relaxed);
+        r.pending_bytes.store(up ? b + bytes : b - bytes, std::memory_order_relaxed);
+    }
+
+    static size_t free_all(std::vector<RetiredPtr>& items) {
+        for (const RetiredPtr& it : items) it.deleter(it.ptr);
+        size_t n = items.size();
+        global().reclaimed.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    // Free bag b of r. Deleters may retire more nodes into r's bags, so
+    // b's contents are moved out first.
+    static size_t release(Record& r, Bag& b) {
+        std::vector<RetiredPtr> items;
+        const bool outer = !r.collecting;
+        if (outer) items.swap(r.scratch);   // keep capacity across rounds
+        items.swap(b.items);
+        size_t bytes = 0;
+        for (const RetiredPtr& it : items) bytes += it.bytes;
+        add_pending(r, items.size(), bytes, false);
+        r.collecting = true;
+        size_t n = free_all(items);
+        r.collecting = !outer;
+        if (outer) {
+            items.clear();
+            r.scratch.swap(items);
+        }
+        return n;
+    }
+
+    static size_t collect_local(Record& r, int rounds) {
+        if (r.collecting) return 0;
+        Global& g = global();
+        size_t n = 0;
+        for (int i = 0; i < rounds && r.pending_items.load(std::memory_order_relaxed); ++i) {
+            if (!try_advance()) break;
+            uint64_t e = g.epoch.load(std::memory_order_acquire);
+            for (Bag& b : r.bags)
+                if (!b.items.empty() && b.epoch + 2 <= e) n += release(r, b);
+        }
+        if (g.orphan_items.load(std::memory_order_relaxed)) n += collect_orphans();
+        return n;
+    }
+
+    static size_t collect_orphans() {
+        Global& g = global();
+        std::vector<Bag> ready;
+        {
+            std::unique_lock<std::mutex> lk(g.mtx, std::try_to_lock);
+            if (!lk) return 0;
+            try_advance();
+            uint64_t e = g.epoch.load(std::memory_order_acquire);
+            auto split = std::partition(g.orphans.begin(), g.orphans.end(),
+                                        [e](const Bag& b) { return b.epoch + 2 > e; });
+            for (auto it = split; it != g.orphans.end(); ++it) {
+                size_t bytes = 0;
+                for (const RetiredPtr& p : it->items) bytes += p.bytes;
+                g.orphan_items.fetch_sub(it->items.size(), std::memory_order_relaxed);
+                g.orphan_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+                ready.push_back(std::move(*it));
+            }
+            g.orphans.erase(split, g.orphans.end());
+        }
+        size_t n = 0;
+        for (Bag& b : ready) n += free_all(b.items);
+        return n;
+    }
+
+    static void add_orphans(Bag&& b) {
+        Global& g = global();
+        size_t bytes = 0;
+        for (const RetiredPtr& p : b.items) bytes += p.bytes;
+        g.orphan_items.fetch_add(b.items.size(), std::memory_order_relaxed);
+        g.orphan_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        g.orphans.push_back(std::move(b));
+    }
+
+    // Take a free record or make a new one.
+    static Record* acquire() {
+        Global& g = global();
+        std::lock_guard<std::mutex> lk(g.mtx);
+        if (Record* r = g.free_list) {
+            g.free_list = r->next_free;
+            return r;
+        }
+        Record* r = new Record;
+        r->next_all = g.all.load(std::memory_order_relaxed);
+        g.all.store(r, std::memory_order_release);
+        return r;
+    }
+
+    // Abandon a record: its garbage becomes orphans, the record reusable.
+    static void detach(Record* r) {
+        r->state.store(0, std::memory_order_release);
+        r->depth = 0;
+        Global& g = global();
+        std::lock_guard<std::mutex> lk(g.mtx);
+        for (Bag& b : r->bags)
+            if (!b.items.empty()) {
+                add_orphans(std::move(b));
+                b = Bag{};
+            }
+        r->pending_items.store(0, std::memory_order_relaxed);
+        r->pending_bytes.store(0, std::memory_order_relaxed);
+        r->since_collect = 0;
+        r->next_free = g.free_list;
+        g.free_list = r;
+    }
+
+    // Ties a record to a thread for the thread's lifetime.
+    struct Lease {
+        Lease()  { tls_rec_ = acquire(); }
+        ~Lease() {
+            Record* r = tls_rec_;
+            tls_rec_    = nullptr;
+            tls_exited_ = true;
+            detach(r);
+        }
+    };
+
+    static Record* current() {
+        if (tls_rec_)    return tls_rec_;
+        if (tls_exited_) return nullptr;
+        thread_local Lease lease;
+        return tls_rec_;
+    }
+
+    static inline thread_local Record* tls_rec_    = nullptr;
+    static inline thread_local bool    tls_exited_ = false;
+};
+
+inline void Epoch::retire(void* p, void (*deleter)(void*), size_t bytes) {
+    Global& g = global();
+    // Order the caller's unlink before reading the epoch it is filed under.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t e = g.epoch.load(std::memory_order_acquire);
+
+    Record* r = current();
+    if (!r) {   // thread is exiting: straight to the orphan list
+        Bag b{e, {RetiredPtr{p, deleter, bytes}}};
+        std::lock_guard<std::mutex> lk(g.mtx);
+        add_orphans(std::move(b));
+        return;
+    }
+    Bag& b = r->bags[e % 3];
+    if (b.epoch != e) {
+        // Holds epoch e-3 or older: already safe to free.
+        if (!b.items.empty()) release(*r, b);
+        b.epoch = e;
+    }
+    b.items.push_back(RetiredPtr{p, deleter, bytes});
+    add_pending(*r, 1, bytes, true);
+    if (++r->since_collect >= COLLECT_EVERY) {
+        r->since_collect = 0;
+        collect_local(*r, 1);
+    }
+}
+
+inline size_t Epoch::collect() {
+    Record* r = tls_rec_;
+    Global& g = global();
+    if (r && r->pending_items.load(std::memory_order_relaxed)) return collect_local(*r, 2);
+    if (g.orphan_items.load(std::memory_order_relaxed)) return collect_orphans();
+    return 0;
+}
+
+inline size_t Epoch::pending() {
+    Global& g = global();
+    size_t n = g.orphan_items.load(std::memory_order_relaxed);
+    for (Record* r = g.all.load(std::memory_order_acquire); r; r = r->next_all)
+        n += r->pending_items.load(std::memory_order_relaxed);
+    return n;
+}
+
+inline size_t Epoch::pending_bytes() {
+    Global& g = global();
+    size_t n = g.orphan_bytes.load(std::memory_order_relaxed);
+    for (Record* r = g.all.load(std::memory_order_acquire); r; r = r->next_all)
+        n += r->pending_bytes.load(std::memory_order_relaxed);
+    return n;
+}
+
+// ════════════════════════════════════════════════════════════════
+// Hazard — hazard pointers
+// ════════════════════════════════════════════════════════════════
+
+class Hazard {
+    struct Record;
+
+public:
+    static constexpr size_t SLOTS    = 4;    // hazard pointers per thread
+    static constexpr size_t MIN_SCAN = 64;   // retired nodes before the first scan
+
+    /**
+     * Pointer — one of the calling thread's hazard slots. protect() makes
+     * the loaded pointer safe to dereference until reset(), the next
+     * protect(), or destruction. A thread may hold SLOTS at once (enough
+     * for hand-over-hand list traversal); one more throws.
+     */
+    class Pointer {
+    public:
+        Pointer() : rec_(current()) {
+            if (!rec_) throw std::logic_error("Hazard::Pointer: thread is exiting");
+            uint32_t freebits = ~rec_->used & ((1u << SLOTS) - 1);
+            if (!freebits) throw std::length_error("Hazard::Pointer: all hazard slots in use");
+            bit_ = freebits & (0u - freebits);
+            rec_->used |= bit_;
+            slot_ = &rec_->hp[__builtin_ctz(bit_)];
+        }
+        ~Pointer() {
+            reset();
+            rec_->used &= ~bit_;
+        }
+        Pointer(const Pointer&) = delete;
+        Pointer& operator=(const Pointer&) = delete;
+
+        // Load src and publish it until the published value is confirmed
+        // to still be in src — from then on it cannot be freed.
+        template<typename T>
+        T* protect(const std::atomic<T*>& src) {
+            T* p = src.load(std::memory_order_relaxed);
+            while (true) {
+                slot_->store(p, std::memory_order_seq_cst);
+                T* again = src.load(std::memory_order_seq_cst);
+                if (again == p) return p;
+                p = again;
+            }
+        }
+
+        // Publish a pointer the caller knows is still reachable (e.g.
+        // validated by other means). Prefer protect().
+        void set(const void* p) { slot_->store(p, std::memory_order_seq_cst); }
+        void reset()            { slot_->store(nullptr, std::memory_order_release); }
+
+    private:
+        Record*                   rec_;
+        std::atomic<const void*>* slot_ = nullptr;
+        uint32_t                  bit_  = 0;
+    };
+
+    template<typename T>
+    static void retire(T* p) { retire(p, &RetiredPtr::delete_as<T>, sizeof(T)); }
+    static void retire(void* p, void (*deleter)(void*), size_t bytes = 0);
+
+    // Free every node this thread retired that no hazard slot names (and
+    // adopt orphans). Returns nodes freed; 0 at once if nothing is pending.
+    static size_t scan() {
+        Record* r = tls_rec_;
+        bool orphans = global().orphan_items.load(std::memory_order_relaxed) != 0;
+        if (!orphans && (!r || r->retired.empty())) return 0;
+        if (!r && !(r = current())) return 0;
+        return scan_local(*r);
+    }
+
+    static size_t   local_pending() { return tls_rec_ ? tls_rec_->retired.size() : 0; }
+    static size_t   pending();
+    static size_t   pending_bytes();
+    static uint64_t reclaimed() { return global().reclaimed.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Record {
+        std::atomic<const void*> hp[SLOTS] = {};
+        std::atomic<size_t>      pending_items{0};
+        std::atomic<size_t>      pending_bytes{0};
+
+        // Owner-only.
+        uint32_t                 used     = 0;     // bitmask of claimed slots
+        bool                     scanning = false;
+        std::vector<RetiredPtr>  retired;
+        std::vector<RetiredPtr>  doomed;           // scratch for a scan
+        std::vector<const void*> snapshot;         // scratch for a scan
+
+        Record* next_all  = nullptr;
+        Record* next_free = nullptr;
+    };
+
+    struct Global {
+        alignas(64) std::atomic<Record*> all{nullptr};
+        std::atomic<size_t>     records{0};
+        std::atomic<uint64_t>   reclaimed{0};
+        std::mutex              mtx;
+        Record*                 free_list = nullptr;
+        std::vector<RetiredPtr> orphans;
+        std::atomic<size_t>     orphan_items{0};
+        std::atomic<size_t>     orphan_bytes{0};
+    };
+    static Global& global() {
+        static Global* g = new Global;
+        return *g;
+    }
+
+    static size_t threshold() {
+        return std::max(MIN_SCAN, 2 * SLOTS * global().records.load(std::memory_order_relaxed));
+    }
+
+    static void set_pending(Record& r) {
+        size_t bytes = 0;
+        for (const RetiredPtr& p : r.retired) bytes += p.bytes;
+        r.pending_items.store(r.retired.size(), std::memory_order_relaxed);
+        r.pending_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    static size_t scan_local(Record& r) {
+        if (r.scanning) return 0;
+        r.scanning = true;
+        Global& g = global();
+        if (g.orphan_items.load(std::memory_order_relaxed)) {
+            std::unique_lock<std::mutex> lk(g.mtx, std::try_to_lock);
+            if (lk) {
+                r.retired.insert(r.retired.end(), g.orphans.begin(), g.orphans.end());
+                g.orphans.clear();
+                g.orphan_items.store(0, std::memory_order_relaxed);
+                g.orphan_bytes.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Order the retirers' unlinks before reading the slots: a reader
+        // whose protect() we miss is bound to fail its re-check.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        r.snapshot.clear();
+        for (Record* rec = g.all.load(std::memory_order_acquire); rec; rec = rec->next_all)
+            for (auto& slot : rec->hp)
+                if (const void* p = slot.load(std::memory_order_acquire)) r.snapshot.push_back(p);
+        std::sort(r.snapshot.begin(), r.snapshot.end());
+
+        auto split = std::partition(r.retired.begin(), r.retired.end(), [&r](const RetiredPtr& p) {
+            return std::binary_search(r.snapshot.begin(), r.snapshot.end(), p.ptr);
+        });
+        r.doomed.assign(split, r.retired.end());
+        r.retired.erase(split, r.retired.end());
+        set_pending(r);
+        for (const RetiredPtr& p : r.doomed) p.deleter(p.ptr);   // may retire more
+        size_t n = r.doomed.size();
+        r.doomed.clear();
+        g.reclaimed.fetch_add(n, std::memory_order_relaxed);
+        r.scanning = false;
+        return n;
+    }
+
+    static Record* acquire() {
+        Global& g = global();
+        std::lock_guard<std::mutex> lk(g.mtx);
+        if (Record* r = g.free_list) {
+            g.free_list = r->next_free;
+            return r;
+        }
+        Record* r = new Record;
+        r->next_all = g.all.load(std::memory_order_relaxed);
+        g.all.store(r, std::memory_order_release);
+        g.records.fetch_add(1, std::memory_order_relaxed);
+        return r;
+    }
+
+    struct Lease {
+        Lease()  { tls_rec_ = acquire(); }
+        ~Lease() {
+            Record* r = tls_rec_;
+            tls_rec_    = nullptr;
+            tls_exited_ = true;
+            for (auto& slot : r->hp) slot.store(nullptr, std::memory_order_release);
+            r->used = 0;
+            Global& g = global();
+            std::lock_guard<std::mutex> lk(g.mtx);
+            size_t bytes = 0;
+            for (const RetiredPtr& p : r->retired) bytes += p.bytes;
+            g.orphans.insert(g.orphans.end(), r->retired.begin(), r->retired.end());
+            g.orphan_items.fetch_add(r->retired.size(), std::memory_order_relaxed);
+            g.orphan_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            r->retired.clear();
+            set_pending(*r);
+            r->next_free = g.free_list;
+            g.free_list = r;
+        }
+    };
+
+    static Record* current() {
+        if (tls_rec_)    return tls_rec_;
+        if (tls_exited_) return nullptr;
+        thread_local Lease lease;
+        return tls_rec_;
+    }
+
+    static inline thread_local Record* tls_rec_    = nullptr;
+    static inline thread_local bool    tls_exited_ = false;
+};
+
+inline void Hazard::retire(void* p, void (*deleter)(void*), size_t bytes) {
+    Record* r = current();
+    if (!r) {   // thread is exiting: hand it to whoever scans next
+        Global& g = global();
+        std::lock_guard<std::mutex> lk(g.mtx);
+        g.orphans.push_back(RetiredPtr{p, deleter, bytes});
+        g.orphan_items.fetch_add(1, std::memory_order_relaxed);
+        g.orphan_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        return;
+    }
+    r->retired.push_back(RetiredPtr{p, deleter, bytes});
+    r->pending_items.store(r->retired.size(), std::memory_order_relaxed);
+    r->pending_bytes.store(r->pending_bytes.load(std::memory_order_relaxed) + bytes,
+                           std::memory_order_relaxed);
+    if (r->retired.size() >= threshold()) scan_local(*r);
+}
+
+inline size_t Hazard::pending() {
+    Global& g = global();
+    size_t n = g.orphan_items.load(std::memory_order_relaxed);
+    for (Record* r = g.all.load(std::memory_order_acquire); r; r = r->next_all)
+        n += r->pending_items.load(std::memory_order_relaxed);
+    return n;
+}
+
+inline size_t Hazard::pending_bytes() {
+    Global& g = global();
+    size_t n = g.orphan_bytes.load(std::memory_order_relaxed);
+    for (Record* r = g.all.load(std::memory_order_acquire); r; r = r->next_all)
+        n += r->pending_bytes.load(std::memory_order_relaxed);
+    return n;
+}
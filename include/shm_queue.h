@@ -0,0 +1,584 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "futex.h"
+
+/**
+ * ShmQueue<T> — LockFreeQueue across processes, in POSIX shared memory
+ * ====================================================================
+ *
+ * Several front-end processes on one host hand work to one TaskServer.
+ * Over loopback TCP every message costs two syscalls plus a trip through
+ * the kernel's socket buffers. With the ring itself mapped into every
+ * process, a hand-off is the same handful of atomics LockFreeQueue uses —
+ * the kernel is only entered to put an idle consumer to sleep.
+ *
+ * REGION LAYOUT (shm_open + mmap, one region per queue):
+ *
+ *   offset 0              sizeof(Header)
+ *   ┌─────────────────────┬──────────┬──────────┬─────┬──────────┐
+ *   │ Header              │ Slot 0   │ Slot 1   │ ... │ Slot N-1 │
+ *   │ magic, version,     │ seq,skip │          │     │          │
+ *   │ sizeof(T), capacity │ T data   │          │     │          │
+ *   │ head, tail, epochs  │          │          │     │          │
+ *   │ peer table          │          │          │     │          │
+ *   └─────────────────────┴──────────┴──────────┴─────┴──────────┘
+ *
+ * Every process maps the region at a different address, so NOTHING in it
+ * is a pointer: slots are found as base + slots_offset + i * slot_size,
+ * and T must be trivially copyable (no pointers into one process's heap).
+ * The ring protocol is LockFreeQueue's, with the per-slot sequence word.
+ *
+ * CREATE / OPEN:
+ *   auto q = ShmQueue<Msg>::create("/tasks", 4096);   // consumer side
+ *   auto q = ShmQueue<Msg>::open("/tasks", 4096);     // each producer
+ *
+ * open() validates the header — magic, layout version, sizeof/alignof(T),
+ * slot size and capacity — and throws std::runtime_error on a mismatch,
+ * so a producer built against a different Msg can't scribble on the ring.
+ * create() replaces a region whose creator has died (a crashed server
+ * restarting) but refuses one whose creator is still alive. The creating
+ * handle unlinks the name when destroyed; mapped peers keep working.
+ *
+ * CRASHED PEERS:
+ * --------------
+ * A process can die between claiming a slot (the CAS on tail/head) and
+ * handing it back (the sequence store). In-process that can't happen;
+ * across processes it wedges the ring forever. So each handle takes an
+ * entry in the header's peer table { pid, producing, consuming } and
+ * writes the position it is claiming there BEFORE its CAS. recover():
+ *
+ *   dead producer held p, slot still unpublished → publish a tombstone
+ *                                                  (consumers skip it)
+ *   dead consumer held c, slot still unreleased  → release it (the item
+ *                                                  died with the consumer)
+ *
+ * A position is only touched if no LIVE peer also names it (a live peer
+ * naming it lost the CAS race and will move on, or won and will finish).
+ * One process recovers at a time (recover_lock; stolen if its holder is
+ * dead). The blocking enqueue()/dequeue() call recover() on their own
+ * every RECOVER_INTERVAL spent waiting. Liveness is kill(pid, 0) plus a
+ * zombie check, so a recycled PID can hide a death — the slot then stays
+ * stuck until that PID exits too.
+ *
+ * WAKEUPS:
+ * --------
+ * Shared futexes (futex.h with shared = true) on two epoch words in the
+ * header, not_empty and not_full. A waiter raises a "waiting" flag before
+ * its final re-check; a waker pays for the syscall only if it finds the
+ * flag up, and takes it down (exchange) while bumping the epoch, so a
+ * burst of items costs ONE wake however long the consumer takes to get
+ * scheduled. A busy queue makes no syscalls at all. A flag left up by a
+ * waiter that timed out or died costs one spurious wake.
+ *
+ * CONTRACT:
+ *   • One handle per thread: the peer entry records ONE position in
+ *     flight, so threads sharing a handle would overwrite each other's.
+ *   • Capacity is a power of two ≥ 2; at most MAX_PEERS handles attached.
+ */
+template<typename T>
+class ShmQueue {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+                  "ShmQueue<T>: T is copied between address spaces — make it trivially copyable and default-constructible");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+                  "ShmQueue needs address-free (lock-free) atomics");
+
+public:
+    static constexpr uint64_t MAGIC     = 0x3145555148535054ull;   // "TPSHQUE1"
+    static constexpr uint32_t VERSION   = 1;
+    static constexpr size_t   MAX_PEERS = 64;
+    static constexpr std::chrono::milliseconds RECOVER_INTERVAL{20};
+
+    /**
+     * create — make a fresh region named `name` ("/something") holding
+     * `capacity` slots, and attach to it.
+     */
+    static ShmQueue create(const std::string& name, size_t capacity) {
+        check_name(name);
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+            throw std::invalid_argument("ShmQueue: capacity must be a power of 2 >= 2");
+
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0 && errno == EEXIST) {
+            if (uint32_t pid = live_creator(name))
+                throw std::runtime_error("ShmQueue: " + name + " is in use by live pid "
+                                         + std::to_string(pid));
+            ::shm_unlink(name.c_str());   // left behind by a crashed creator
+            fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        }
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "ShmQueue: shm_open " + name);
+
+        const size_t size = region_size(capacity);
+        void* base = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+            base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            throw std::system_error(err, std::generic_category(), "ShmQueue: map " + name);
+        }
+
+        Header* h = ::new (base) Header{};
+        h->magic        = MAGIC;
+        h->version      = VERSION;
+        h->elem_size    = sizeof(T);
+        h->elem_align   = alignof(T);
+        h->slot_size    = sizeof(Slot);
+        h->capacity     = capacity;
+        h->slots_offset = sizeof(Header);
+        h->region_size  = size;
+        h->creator_pid  = static_cast<uint32_t>(::getpid());
+        Slot* slots = reinterpret_cast<Slot*>(static_cast<char*>(base) + sizeof(Header));
+        for (size_t i = 0; i < capacity; ++i) {
+            ::new (&slots[i]) Slot{};
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        h->ready.store(1, std::memory_order_release);   // header complete
+
+        return ShmQueue(name, base, size, /*owner=*/true);
+    }
+
+    /**
+     * open — attach to an existing region. `expected_capacity` of 0 accepts
+     * whatever the creator chose. Waits up to `init_wait` for a creator
+     * that is still initializing; throws if the name doesn't exist or the
+     * header doesn't match this T.
+     */
+    static ShmQueue open(const std::string& name, size_t expected_capacity = 0,
+                         std::chrono::milliseconds init_wait = std::chrono::milliseconds(1000)) {
+        check_name(name);
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "ShmQueue: shm_open " + name);
+
+        const auto deadline = std::chrono::steady_clock::now() + init_wait;
+        struct stat st{};
+        while (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < sizeof(Header)
+               && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("ShmQueue: " + name + ": region too small for a header");
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (base == MAP_FAILED)
+            throw std::system_error(err, std::generic_category(), "ShmQueue: map " + name);
+
+        const Header* h = static_cast<const Header*>(base);
+        while (h->ready.load(std::memory_order_acquire) == 0
+               && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        const char* problem = nullptr;
+        if (h->ready.load(std::memory_order_acquire) == 0) problem = "creator never finished initializing";
+        else if (h->magic != MAGIC)                        problem = "bad magic (not a ShmQueue region)";
+        else if (h->version != VERSION)                    problem = "layout version mismatch";
+        else if (h->elem_size != sizeof(T) || h->elem_align != alignof(T) || h->slot_size != sizeof(Slot))
+                                                           problem = "element type mismatch (sizeof/alignof T)";
+        else if (h->capacity < 2 || (h->capacity & (h->capacity - 1)) != 0)
+                                                           problem = "corrupt capacity";
+        else if (expected_capacity != 0 && h->capacity != expected_capacity)
+                                                           problem = "capacity mismatch";
+        else if (h->slots_offset != sizeof(Header) || h->region_size != region_size(h->capacity)
+                 || h->region_size > size)                 problem = "region size mismatch";
+        if (problem) {
+            ::munmap(base, size);
+            throw std::runtime_error("ShmQueue: " + name + ": " + problem);
+        }
+        return ShmQueue(name, base, size, /*owner=*/false);
+    }
+
+    ShmQueue(ShmQueue&& o) noexcept { swap(o); }
+    ShmQueue& operator=(ShmQueue&& o) noexcept {
+        if (this != &o) { ShmQueue tmp(std::move(o)); swap(tmp); }
+        return *this;
+    }
+    ShmQueue(const ShmQueue&) = delete;
+    ShmQueue& operator=(const ShmQueue&) = delete;
+
+    ~ShmQueue() {
+        if (!base_) return;
+        me_->producing.store(IDLE, std::memory_order_relaxed);
+        me_->consuming.store(IDLE, std::memory_order_relaxed);
+        me_->pid.store(0, std::memory_order_release);
+        ::munmap(base_, map_size_);
+        if (owner_) ::shm_unlink(name_.c_str());
+    }
+
+    /**
+     * try_produce — claim a slot and let fill(T&) write the item in place.
+     * false if the ring is full. If fill throws, the slot is published as
+     * a tombstone and the exception propagates.
+     */
+    template<typename F>
+    bool try_produce(F&& fill) {
+        uint64_t pos = h_->tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& s = slot(pos);
+            uint64_t seq = s.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq - pos);
+            if (diff == 0) {
+                // Announce the claim BEFORE making it: recover() must be
+                // able to name the owner of every claimed slot.
+                me_->producing.store(pos, std::memory_order_seq_cst);
+                if (h_->tail.compare_exchange_weak(pos, pos + 1,
+                        std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    try {
+                        fill(s.data);
+                    } catch (...) {
+                        publish(s, pos, /*skip=*/1);
+                        throw;
+                    }
+                    publish(s, pos, 0);
+                    return true;
+                }
+            } else if (diff < 0) {
+                me_->producing.store(IDLE, std::memory_order_relaxed);
+                return false;                                           // full
+            } else {
+                pos = h_->tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * try_consume — take the oldest item and run f(T&) on it where it
+     * lies in the region. false if empty. The slot is released after f
+     * returns or throws.
+     */
+    template<typename F>
+    bool try_consume(F&& f) {
+        uint64_t pos = h_->head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& s = slot(pos);
+            uint64_t seq = s.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq - (pos + 1));
+            if (diff == 0) {
+                me_->consuming.store(pos, std::memory_order_seq_cst);
+                if (h_->head.compare_exchange_weak(pos, pos + 1,
+                        std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    {
+                        Release done{*this, s, pos};
+                        if (!s.skip) { f(s.data); return true; }
+                    }
+                    pos = h_->head.load(std::memory_order_relaxed);     // tombstone
+                    continue;
+                }
+            } else if (diff < 0) {
+                me_->consuming.store(IDLE, std::memory_order_relaxed);
+                return false;                                           // empty
+            } else {
+                pos = h_->head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_enqueue(const T& item) { return try_produce([&item](T& slot) { slot = item; }); }
+    bool try_dequeue(T& out)        { return try_consume([&out](T& item) { out = item; }); }
+
+    /**
+     * enqueue / dequeue — block (on a shared futex) until there is room /
+     * an item, or until `timeout` passes. Return false on timeout.
+     */
+    bool enqueue(const T& item, std::chrono::nanoseconds timeout) {
+        return wait_for([&] { return try_enqueue(item); },
+                        h_->not_full, h_->producers_waiting, timeout);
+    }
+    bool dequeue(T& out, std::chrono::nanoseconds timeout) {
+        return wait_for([&] { return try_dequeue(out); },
+                        h_->not_empty, h_->consumers_waiting, timeout);
+    }
+
+    /**
+     * recover — free slots held by peers that died mid-operation (see
+     * CRASHED PEERS). Returns how many slots it fixed. Cheap enough to
+     * call from a watchdog; the blocking calls invoke it while waiting.
+     */
+    size_t recover() {
+        const uint32_t self = static_cast<uint32_t>(::getpid());
+        uint32_t holder = 0;
+        if (!h_->recover_lock.compare_exchange_strong(holder, self, std::memory_order_acquire)) {
+            if (holder == self || process_alive(holder)) return 0;
+            if (!h_->recover_lock.compare_exchange_strong(holder, self, std::memory_order_acquire))
+                return 0;
+        }
+
+        size_t fixed = 0;
+        for (Peer& p : h_->peers) {
+            uint32_t pid = p.pid.load(std::memory_order_acquire);
+            if (pid == 0 || process_alive(pid)) continue;
+
+            uint64_t pos = p.producing.load(std::memory_order_seq_cst);
+            if (pos != IDLE && pos < h_->tail.load(std::memory_order_seq_cst)
+                && !held_by_live_peer(&Peer::producing, pos)) {
+                Slot& s = slot(pos);
+                if (s.sequence.load(std::memory_order_acquire) == pos) {   // claimed, unpublished
+                    s.skip = 1;
+                    s.sequence.store(pos + 1, std::memory_order_release);
+                    ++fixed;
+                }
+            }
+            pos = p.consuming.load(std::memory_order_seq_cst);
+            if (pos != IDLE && pos < h_->head.load(std::memory_order_seq_cst)
+                && !held_by_live_peer(&Peer::consuming, pos)) {
+                Slot& s = slot(pos);
+                if (s.sequence.load(std::memory_order_acquire) == pos + 1) {   // claimed, unreleased
+                    s.sequence.store(pos + cap_, std::memory_order_release);
+                    ++fixed;
+                }
+            }
+            p.producing.store(IDLE, std::memory_order_relaxed);
+            p.consuming.store(IDLE, std::memory_order_relaxed);
+            p.pid.compare_exchange_strong(pid, 0, std::memory_order_release);
+        }
+        h_->recover_lock.store(0, std::memory_order_release);
+
+        if (fixed) {
+            h_->recovered.fetch_add(fixed, std::memory_order_relaxed);
+            wake_all(h_->not_empty);
+            wake_all(h_->not_full);
+        }
+        return fixed;
+    }
+
+    // Approximate, like LockFreeQueue::size().
+    size_t size() const {
+        uint64_t head = h_->head.load(std::memory_order_relaxed);
+        uint64_t tail = h_->tail.load(std::memory_order_relaxed);
+        return tail > head ? static_cast<size_t>(tail - head) : 0;
+    }
+    bool   empty()     const { return size() == 0; }
+    size_t capacity()  const { return cap_; }
+    const std::string& name() const { return name_; }
+    bool   is_owner()  const { return owner_; }
+    // Total slots recover() has fixed over the region's lifetime.
+    uint64_t recovered() const { return h_->recovered.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint64_t IDLE = ~uint64_t{0};
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        uint32_t              skip = 0;   // tombstone; written by the slot's producer
+        T                     data;
+    };
+
+    struct alignas(64) Peer {
+        std::atomic<uint32_t> pid{0};            // 0 = free entry
+        std::atomic<uint64_t> producing{IDLE};   // position being claimed/filled
+        std::atomic<uint64_t> consuming{IDLE};   // position being claimed/read
+    };
+
+    struct alignas(64) Header {
+        // Immutable after create(); validated by open().
+        uint64_t magic = 0;
+        uint32_t version = 0;
+        uint32_t elem_size = 0;
+        uint32_t elem_align = 0;
+        uint32_t slot_size = 0;
+        uint64_t capacity = 0;
+        uint64_t slots_offset = 0;
+        uint64_t region_size = 0;
+        uint32_t creator_pid = 0;
+        std::atomic<uint32_t> ready{0};
+
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+
+        alignas(64) std::atomic<uint32_t> not_empty{0};   // futex epochs
+        std::atomic<uint32_t> not_full{0};
+        std::atomic<uint32_t> consumers_waiting{0};     // flags, see WAKEUPS
+        std::atomic<uint32_t> producers_waiting{0};
+        std::atomic<uint32_t> recover_lock{0};            // pid of the recoverer
+        std::atomic<uint64_t> recovered{0};
+
+        Peer peers[MAX_PEERS];
+    };
+
+    // Hands a consumed slot back to producers (even if the visitor threw).
+    struct Release {
+        ShmQueue& q;
+        Slot&     s;
+        uint64_t  pos;
+        ~Release() {
+            s.sequence.store(pos + q.cap_, std::memory_order_release);
+            q.me_->consuming.store(IDLE, std::memory_order_release);
+            q.notify(q.h_->not_full, q.h_->producers_waiting);
+        }
+    };
+
+    ShmQueue(std::string name, void* base, size_t size, bool owner)
+        : name_(std::move(name)), base_(base), map_size_(size), owner_(owner),
+          h_(static_cast<Header*>(base)),
+          slots_(reinterpret_cast<Slot*>(static_cast<char*>(base) + sizeof(Header))),
+          cap_(h_->capacity)
+    {
+        try {
+            attach();
+        } catch (...) {
+            ::munmap(base_, map_size_);
+            if (owner_) ::shm_unlink(name_.c_str());
+            base_ = nullptr;
+            throw;
+        }
+    }
+
+    void swap(ShmQueue& o) noexcept {
+        std::swap(name_, o.name_);
+        std::swap(base_, o.base_);
+        std::swap(map_size_, o.map_size_);
+        std::swap(owner_, o.owner_);
+        std::swap(h_, o.h_);
+        std::swap(slots_, o.slots_);
+        std::swap(cap_, o.cap_);
+        std::swap(me_, o.me_);
+    }
+
+    void attach() {
+        const uint32_t self = static_cast<uint32_t>(::getpid());
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            for (Peer& p : h_->peers) {
+                uint32_t free_pid = 0;
+                if (p.pid.compare_exchange_strong(free_pid, self, std::memory_order_acq_rel)) {
+                    me_ = &p;
+                    return;
+                }
+            }
+            recover();   // frees entries of dead peers
+        }
+        throw std::runtime_error("ShmQueue: " + name_ + ": all "
+                                 + std::to_string(MAX_PEERS) + " peer entries in use");
+    }
+
+    Slot& slot(uint64_t pos) { return slots_[pos & (cap_ - 1)]; }
+
+    void publish(Slot& s, uint64_t pos, uint32_t skip) {
+        s.skip = skip;
+        s.sequence.store(pos + 1, std::memory_order_release);
+        me_->producing.store(IDLE, std::memory_order_release);
+        notify(h_->not_empty, h_->consumers_waiting);
+    }
+
+    // Waker side of the waiting-flag handshake: publish, full fence, then
+    // only pay for a syscall if someone announced they may sleep.
+    static void notify(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& waiting) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0
+            && waiting.exchange(0, std::memory_order_acq_rel) != 0)
+            wake_all(epoch);
+    }
+
+    static void wake_all(std::atomic<uint32_t>& epoch) {
+        epoch.fetch_add(1, std::memory_order_release);
+        futex_wake_all(&epoch, /*shared=*/true);
+    }
+
+    template<typename TryOp>
+    bool wait_for(TryOp&& op, std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& waiting,
+                  std::chrono::nanoseconds timeout) {
+        if (op()) return true;
+        using Clock = std::chrono::steady_clock;
+        const auto deadline = Clock::now() + timeout;
+        auto next_recover   = Clock::now() + RECOVER_INTERVAL;
+        while (true) {
+            uint32_t e = epoch.load(std::memory_order_acquire);
+            waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool done = op();                      // final re-check before sleeping
+            auto now = Clock::now();
+            if (!done && now < deadline)
+                futex_wait_for(&epoch, e, std::min(deadline, next_recover) - now,
+                               /*shared=*/true);
+            if (done || op()) return true;
+
+            now = Clock::now();
+            if (now >= next_recover) {             // a peer may have died holding the slot we need
+                recover();
+                next_recover = now + RECOVER_INTERVAL;
+            }
+            if (now >= deadline) return op();
+        }
+    }
+
+    bool held_by_live_peer(std::atomic<uint64_t> Peer::*field, uint64_t pos) const {
+        for (const Peer& p : h_->peers) {
+            uint32_t pid = p.pid.load(std::memory_order_acquire);
+            if (pid != 0 && (p.*field).load(std::memory_order_seq_cst) == pos && process_alive(pid))
+                return true;
+        }
+        return false;
+    }
+
+    static bool process_alive(uint32_t pid) {
+        if (pid == static_cast<uint32_t>(::getpid())) return true;
+        if (::kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH) return false;
+        // A zombie (exited, not yet reaped) still answers kill(pid, 0).
+        std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+        std::string line;
+        if (!std::getline(stat, line)) return true;
+        size_t paren = line.rfind(')');
+        char state = paren != std::string::npos && paren + 2 < line.size() ? line[paren + 2] : 'R';
+        return state != 'Z' && state != 'X';
+    }
+
+    // pid of a live creator of an existing region `name`, or 0.
+    static uint32_t live_creator(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return 0;
+        struct stat st{};
+        uint32_t pid = 0;
+        if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header)) {
+            void* base = ::mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+            if (base != MAP_FAILED) {
+                const Header* h = static_cast<const Header*>(base);
+                if (h->magic == MAGIC && process_alive(h->creator_pid)) pid = h->creator_pid;
+                ::munmap(base, sizeof(Header));
+            }
+        }
+        ::close(fd);
+        return pid;
+    }
+
+    static void check_name(const std::string& name) {
+        if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos)
+            throw std::invalid_argument("ShmQueue: name must look like \"/name\"");
+    }
+
+    static constexpr size_t region_size(size_t capacity) {
+        return sizeof(Header) + capacity * sizeof(Slot);
+    }
+
+    std::string name_;
+    void*       base_     = nullptr;
+    size_t      map_size_ = 0;
+    bool        owner_    = false;
+    Header*     h_        = nullptr;
+    Slot*       slots_    = nullptr;
+    uint64_t    cap_      = 0;
+    Peer*       me_       = nullptr;
+};
@@ -103,12 +103,12 @@ public:
             throw std::runtime_error("TaskClient: not connected");
 
         uint32_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
-        proto::Message req(proto::MessageType::REQUEST, id, payload);
+        proto::PooledMessage req(proto::MessageType::REQUEST, id, payload);
 
         if (!proto::send_message(fd_, req))
             throw std::runtime_error("TaskClient: send failed");
 
-        proto::Message resp;
+        proto::PooledMessage resp;
         if (!proto::recv_message(fd_, resp))
             throw std::runtime_error("TaskClient: recv failed");
 
@@ -131,9 +131,9 @@ public:
     bool ping() {
         if (!connected_) return false;
         uint32_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
-        proto::Message req(proto::MessageType::PING, id, "");
+        proto::PooledMessage req(proto::MessageType::PING, id, "");
         if (!proto::send_message(fd_, req)) return false;
-        proto::Message resp;
+        proto::PooledMessage resp;
         if (!proto::recv_message(fd_, resp)) return false;
         return resp.type == proto::MessageType::PONG;
     }
@@ -14,6 +14,12 @@
  * - Pass port=0 to let the OS assign a free ephemeral port.
  * - After start(), call port() to get the actual assigned port.
  * - This is the correct approach for tests — no hardcoded ports, no conflicts.
+ *
+ * BUFFERS:
+ * - Each connection reuses one request and one response PooledMessage, and
+ *   both (plus send scratch frames) come from the server's BufferPool, so
+ *   steady-state requests don't allocate wire buffers. Pool hit/miss and
+ *   footprint are exported as server_buffer_pool_*.
  */
 
 #include <functional>
@@ -43,6 +49,7 @@ public:
                size_t threads = std::thread::hardware_concurrency())
         : port_(port)
         , handler_(std::move(handler))
+        , buffers_(&registry, "server_buffer_pool")
         , pool_(threads, &registry)
         , running_(false)
         , server_fd_(-1)
@@ -52,14 +59,14 @@ public:
             "Total TCP connections accepted");
         conn_active_    = registry.add_gauge(
             "server_connections_active_current",
-            "Currently open TCP connections");
+            "Currently open TCP connections", /*sharded=*/true);
         requests_total_ = registry.add_counter(
             "server_requests_total",
             "Total task requests received");
         request_errors_ = registry.add_counter(
             "server_request_errors_total",
             "Total requests that resulted in errors");
-        request_latency_ = registry.add_histogram(
+        request_latency_ = registry.add_hdr_histogram(
             "server_request_latency_seconds",
             "End-to-end request latency from TCP receive to TCP send");
     }
@@ -87,6 +94,9 @@ public:
     // the OS-assigned ephemeral port — call this after start().
     int port() const { return port_; }
 
+    // Request latency so far (p50/p99/... via Snapshot::quantile).
+    HdrHistogram::Snapshot request_latency() const { return request_latency_->snapshot(); }
+
     ~TaskServer() { if (running_) stop(); }
 
     TaskServer(const TaskServer&) = delete;
@@ -153,26 +163,32 @@ private:
     }
 
     void handle_connection(int fd) {
+        proto::PooledMessage req(buffers_);
+        proto::PooledMessage resp(buffers_);
+        std::string          input;   // handler argument, capacity reused
+
         while (running_.load(std::memory_order_acquire)) {
-            proto::Message req;
             if (!proto::recv_message(fd, req)) break;
 
             if (req.type == proto::MessageType::PING) {
-                proto::Message pong(proto::MessageType::PONG, req.id, "");
-                proto::send_message(fd, pong);
+                resp.type = proto::MessageType::PONG;
+                resp.id   = req.id;
+                resp.payload.clear();
+                proto::send_message(fd, resp, buffers_);
                 continue;
             }
 
             if (req.type != proto::MessageType::REQUEST) break;
 
-            auto start = std::chrono::steady_clock::now();
+            auto start = FastClock::now();
             requests_total_->inc();
 
             std::string result;
             proto::MessageType resp_type = proto::MessageType::RESPONSE;
 
             try {
-                result = handler_(req.payload_str());
+                input.assign(req.payload.begin(), req.payload.end());
+                result = handler_(input);
             } catch (const std::exception& e) {
                 result    = std::string("ERROR: ") + e.what();
                 resp_type = proto::MessageType::ERROR;
@@ -183,8 +199,10 @@ private:
                 request_errors_->inc();
             }
 
-            proto::Message resp(resp_type, req.id, result);
-            if (!proto::send_message(fd, resp)) break;
+            resp.type = resp_type;
+            resp.id   = req.id;
+            resp.payload.assign(result.begin(), result.end());
+            if (!proto::send_message(fd, resp, buffers_)) break;
 
             request_latency_->observe_since(start);
         }
@@ -192,6 +210,7 @@ private:
 
     int                     port_;
     Handler                 handler_;
+    proto::BufferPool       buffers_;      // before pool_: outlives the workers
     ThreadPoolV3<1024>      pool_;
     std::atomic<bool>       running_;
     std::atomic<int>        server_fd_;    // atomic — eliminates TSan race with accept_loop
@@ -201,5 +220,5 @@ private:
     Gauge*     conn_active_{nullptr};
     Counter*   requests_total_{nullptr};
     Counter*   request_errors_{nullptr};
-    Histogram* request_latency_{nullptr};
+    HdrHistogram* request_latency_{nullptr};
 };
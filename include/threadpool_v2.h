@@ -7,8 +7,16 @@
 #include <atomic>
 #include <stdexcept>
 #include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
 
 #include "lockfree_queue.h"
+#include "unique_task.h"
+#include "futex.h"
+#include "metrics.h"
+#include "reclaim.h"
 
 /**
  * ThreadPoolV2 — Lock-Free Thread Pool
@@ -65,19 +73,284 @@
  * CORRECT ordering:
  *   ++active → dequeue → execute → --active
  *   Now active>0 as soon as we commit to running the task.
+ *   (If the dequeue comes up empty the worker just gives the unit back.)
+ *
+ * BATCH DEQUEUE (PoolOptions::max_batch):
+ * ---------------------------------------
+ * For nanosecond tasks the contended CAS on head_ costs more than the task.
+ * With max_batch > 1 a worker claims up to K ready tasks with ONE CAS
+ * (LockFreeQueue::try_dequeue_bulk) into a private buffer and runs them
+ * back to back. K adapts per worker:
+ *
+ *   got a full batch          → queue is deep:   K = min(2K, max_batch)
+ *   got fewer than K/2        → queue ran dry:   K = max(K/2, 1)
+ *   avg task > batch_max_task_ns → tasks are slow: K = 1
+ *
+ * so under light load K stays at 1 and nothing waits behind a sibling in
+ * someone's buffer. One active unit covers the whole batch: it is taken
+ * before the dequeue and returned after the last task, so wait_all() can
+ * never slip between "claimed from the ring" and "finished".
+ *
+ * Caveat: buffered tasks cannot be stolen. Keep batching off for tasks
+ * that block waiting on other tasks of the same pool.
+ *
+ * WAIT STRATEGIES (PoolOptions::wait_strategy):
+ * ---------------------------------------------
+ * What an idle worker does after a poll comes up empty. Same menu as the
+ * LMAX Disruptor — each trades wake latency against idle CPU:
+ *
+ *   strategy    idle loop                          wake latency   idle CPU
+ *   ─────────   ────────────────────────────────   ────────────   ────────
+ *   BusySpin    PAUSE forever                      ~100 ns        100%/core
+ *   Yielding    spin 64, yield() (the default)     ~1 µs          high
+ *   Sleeping    spin, yield, then sleep 1µs→1ms    ≤ backoff      low
+ *   Blocking    spin 64, futex wait                ~5-50 µs       ~0
+ *   Adaptive    spin a LEARNED budget, then futex  spin when busy ~0
+ *
+ * Adaptive doubles its spin budget whenever work shows up while it is
+ * still spinning (arrivals are closer together than the budget) and
+ * halves it whenever it has to park, so bursty traffic gets spin-level
+ * latency and a quiet pool goes to sleep.
+ *
+ * Blocking/Adaptive producers pay one fence + one load per push to see
+ * whether anyone is parked, and a futex wake only if someone is.
+ * Spin iterations and parks (yield/sleep/futex) are counted per worker,
+ * flushed to total_spins()/total_parks() — and to PoolOptions::
+ * spin_counter/park_counter if set — once per idle period.
+ *
+ * Idle time is also when workers pay for memory reclamation: every
+ * worker registers with Epoch (reclaim.h) on startup, and calls
+ * Epoch::collect() / Hazard::scan() on its first idle round and every
+ * 64th after, so nodes that tasks retired are freed off the request
+ * path. Both return at once when the worker has nothing pending.
+ *
+ * UTILIZATION (worker_stats(), utilization()):
+ * --------------------------------------------
+ * active_count() is an instant: sampled every 15 s it cannot tell a
+ * pool that is busy 90% of the time from one that is busy 10%. So each
+ * worker also keeps running totals in its own cache line (WorkerStats):
+ *
+ *   busy   from picking up work until the queues next come up empty
+ *   idle   the rest; of which
+ *     spin   spinning in the wait strategy
+ *     park   yielded, sleeping or blocked on the futex
+ *   tasks  tasks run;  dequeue_retries  dequeue races lost to siblings
+ *
+ * Time is stamped (FastClock) only when a worker switches between busy
+ * and idle and around each idle round — never per task while the pool
+ * is saturated — so the per-task cost is one add to a line no other
+ * core writes. busy / (busy + idle) is the utilization; a reader also
+ * gets the period in progress, so a long task shows up as busy while it
+ * runs. The totals outlive the pool (shared_worker_stats()), and
+ * PoolOptions::worker_stats = false turns the bookkeeping off.
+ *
+ * QUEUE MODES:
+ * ------------
+ *   Global   (default) — one shared LockFreeQueue. Strict FIFO, but every
+ *            worker CASes the same head_ and every producer the same
+ *            tail_; past ~8 cores those two cache lines are the bottleneck.
+ *
+ *   Sharded  — one LockFreeQueue per worker. A producer samples TWO random
+ *            shards and enqueues into the shorter one ("power of two
+ *            choices": the max load drops from O(log n / log log n) with
+ *            one random choice to O(log log n) with two). A worker drains
+ *            its own shard and scans its siblings only when that is empty.
+ *            FIFO holds per shard, not globally.
+ *
+ * Either way every worker owns a local queue. In Global mode it is the
+ * worker's AFFINITY INBOX: post_to()/enqueue_to() drop a task there so
+ * it usually runs on that worker (keeping its data in that core's cache),
+ * and an idle worker STEALS from a sibling's inbox after the shared ring
+ * comes up empty — imbalance degrades locality, never throughput.
+ *
+ * LIFO SLOT (PoolOptions::lifo_slot):
+ * -----------------------------------
+ * A task that spawns a follow-up (reply to a message, next pipeline step)
+ * normally sends it to the BACK of the shared ring, where it waits behind
+ * everything else and then runs on whichever core dequeues it — usually a
+ * cold one. With the slot on, a task posted FROM a worker goes into that
+ * worker's one-entry "next task" slot instead and runs as soon as the
+ * current task returns, on the same core, with its data still in L1/L2:
+ *
+ *   worker 2 runs A ── A posts B ──▶ slot[2] = B
+ *                                    (old occupant, if any ──▶ shared queue)
+ *   A returns ──▶ worker 2 runs B next (no CAS on the ring, cache hot)
+ *
+ * Two guards keep the slot from hurting fairness or liveness:
+ *   • lifo_budget — after that many consecutive slot runs the worker checks
+ *     the shared queue first, so a ping-pong pair can't starve it.
+ *   • idle workers STEAL from siblings' slots, so a task stuck behind a
+ *     long-running (or blocked) occupant still gets picked up.
+ *
+ * Same idea as Go's runnext and Tokio's LIFO slot. Only the slot occupant
+ * is LIFO; everything it displaces keeps normal FIFO order.
+ *
+ * TASK STORAGE:
+ * -------------
+ * Tasks are UniqueTask (unique_task.h), not std::function: move-only, so
+ * enqueue() moves its promise straight into the closure, and closures up
+ * to 40 bytes are stored inline in the ring slot. Bigger closures and the
+ * promise's shared state come from the per-thread Arena (arena.h); the
+ * worker's free of a producer's block is one CAS onto the producer's
+ * remote-free stack instead of a trip through malloc's cross-thread path.
+ * arena_bytes(i) reports what worker i's own heap has outstanding;
+ * shared_worker_heaps() hands the same slots to exporters that may
+ * outlive the pool. A worker clears its slot on exit, since its heap is
+ * then abandoned and may be adopted by another thread.
+ */
+/**
+ * WorkerStats — one worker's running totals (see UTILIZATION).
+ *
+ * Written only by its worker: the busy/idle split under a seqlock so a
+ * reader never pairs an old total with a new period start (which could
+ * make a counter step backwards), the rest as plain relaxed stores.
+ * Padded to its own cache lines so workers never share one.
  */
+class alignas(64) WorkerStats {
+public:
+    struct Snapshot {
+        uint64_t tasks = 0;
+        uint64_t busy_ns = 0, idle_ns = 0;   // idle includes spin and park
+        uint64_t spin_ns = 0, park_ns = 0;
+        uint64_t dequeue_retries = 0;
+
+        double utilization() const {
+            uint64_t total = busy_ns + idle_ns;
+            return total ? static_cast<double>(busy_ns) / static_cast<double>(total) : 0.0;
+        }
+    };
+
+    // Totals so far, including the busy or idle period in progress.
+    Snapshot read() const noexcept {
+        Snapshot s;
+        int64_t since;
+        bool    busy;
+        for (;;) {
+            uint32_t s1 = seq_.load(std::memory_order_acquire);
+            s.busy_ns = busy_ns_.load(std::memory_order_relaxed);
+            s.idle_ns = idle_ns_.load(std::memory_order_relaxed);
+            since     = since_.load(std::memory_order_relaxed);
+            busy      = busy_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!(s1 & 1) && seq_.load(std::memory_order_relaxed) == s1) break;
+        }
+        if (since >= 0) {
+            int64_t d = FastClock::now_ns() - since;
+            if (d > 0) (busy ? s.busy_ns : s.idle_ns) += static_cast<uint64_t>(d);
+        }
+        s.tasks           = tasks_.load(std::memory_order_relaxed);
+        s.spin_ns         = spin_ns_.load(std::memory_order_relaxed);
+        s.park_ns         = park_ns_.load(std::memory_order_relaxed);
+        s.dequeue_retries = retries_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // Σ busy / Σ (busy + idle) over `n` workers' stats.
+    static double utilization(const WorkerStats* stats, size_t n) noexcept {
+        Snapshot sum;
+        for (size_t i = 0; i < n; ++i) {
+            Snapshot s = stats[i].read();
+            sum.busy_ns += s.busy_ns;
+            sum.idle_ns += s.idle_ns;
+        }
+        return sum.utilization();
+    }
+
+    // ---- Owner (the worker thread) only ----
+
+    void start(int64_t now) noexcept { switch_to(now, false); }
+    void to_busy(int64_t now) noexcept { switch_to(now, true); }
+    void to_idle(int64_t now) noexcept { switch_to(now, false); }
+    void stop(int64_t now) noexcept { switch_to(now, false, -1); }
+
+    void add_tasks(uint64_t n) noexcept   { bump(tasks_, n); }
+    void add_spin(int64_t ns) noexcept    { if (ns > 0) bump(spin_ns_, static_cast<uint64_t>(ns)); }
+    void add_park(int64_t ns) noexcept    { if (ns > 0) bump(park_ns_, static_cast<uint64_t>(ns)); }
+    void add_retries(uint64_t n) noexcept { bump(retries_, n); }
+
+private:
+    // Single writer, so no RMW: load, add, store.
+    static void bump(std::atomic<uint64_t>& a, uint64_t n) noexcept {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // Close the current period into busy or idle and open the next one
+    // at `now` (or none, since = -1, once the worker has exited).
+    void switch_to(int64_t now, bool busy, int64_t next_since = 0) noexcept {
+        const uint32_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);           // odd: writing
+        std::atomic_thread_fence(std::memory_order_release);
+        const int64_t since = since_.load(std::memory_order_relaxed);
+        if (since >= 0 && now > since)
+            bump(busy_.load(std::memory_order_relaxed) ? busy_ns_ : idle_ns_,
+                 static_cast<uint64_t>(now - since));
+        since_.store(next_since < 0 ? -1 : now, std::memory_order_relaxed);
+        busy_.store(busy, std::memory_order_relaxed);
+        seq_.store(s + 2, std::memory_order_release);           // even: done
+    }
+
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<bool>     busy_{false};
+    std::atomic<int64_t>  since_{-1};   // start of the current period; -1: not running
+    std::atomic<uint64_t> busy_ns_{0}, idle_ns_{0};
+    std::atomic<uint64_t> tasks_{0}, spin_ns_{0}, park_ns_{0}, retries_{0};
+};
+
+enum class QueueMode {
+    Global,
+    Sharded,
+};
+
+enum class WaitStrategy {
+    BusySpin,
+    Yielding,
+    Sleeping,
+    Blocking,
+    Adaptive,
+};
+
+struct PoolOptions {
+    QueueMode queue_mode  = QueueMode::Global;
+    bool      lifo_slot   = false;  // run a worker's own follow-up task next
+    size_t    lifo_budget = 3;      // max consecutive slot runs before a FIFO check
+    size_t    max_batch   = 1;      // upper bound on tasks claimed per dequeue (1 = off)
+    uint64_t  batch_max_task_ns = 2000;  // tasks slower than this disable batching
+    WaitStrategy wait_strategy = WaitStrategy::Yielding;
+    Counter*  spin_counter = nullptr;   // optional: idle spin iterations
+    Counter*  park_counter = nullptr;   // optional: yields/sleeps/futex waits
+    bool      worker_stats = true;      // per-worker busy/idle/spin/park totals
+};
+
 template<size_t QueueCapacity = 1024>
 class ThreadPoolV2 {
 public:
-    explicit ThreadPoolV2(size_t num_threads = std::thread::hardware_concurrency())
-        : stop_(false), active_tasks_(0), total_enqueued_(0), total_completed_(0)
+    explicit ThreadPoolV2(size_t num_threads = std::thread::hardware_concurrency(),
+                          PoolOptions options = {})
+        : options_(options)
+        , stop_(false), active_tasks_(0)
     {
         if (num_threads == 0)
             throw std::invalid_argument("ThreadPoolV2: need at least 1 thread");
+        if (options_.max_batch == 0)
+            throw std::invalid_argument("ThreadPoolV2: max_batch must be >= 1");
+
+        // Local queues must exist before any worker starts scanning them.
+        local_queues_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i)
+            local_queues_.push_back(std::make_unique<Queue>());
+        slots_ = std::make_unique<LifoSlot[]>(num_threads);
+        heaps_ = WorkerHeaps(new std::atomic<const Arena::Heap*>[num_threads]);
+        for (size_t i = 0; i < num_threads; ++i) heaps_[i].store(nullptr, std::memory_order_relaxed);
+        stats_ = std::shared_ptr<WorkerStats[]>(new WorkerStats[num_threads]);
+        // FastClock calibrates (~5 ms) on first use; pay that here, not
+        // in a worker that already has tasks waiting.
+        if (options_.worker_stats) (void)FastClock::now_ns();
+        parking_ = options_.wait_strategy == WaitStrategy::Blocking
+                || options_.wait_strategy == WaitStrategy::Adaptive;
 
         workers_.reserve(num_threads);
         for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back([this] { worker_loop(); });
+            workers_.emplace_back([this, i] { worker_loop(i); });
         }
     }
 
@@ -96,29 +369,98 @@ public:
         if (stop_)
             throw std::runtime_error("ThreadPoolV2: enqueue on stopped pool");
 
-        auto task_ptr = std::make_shared<std::packaged_task<R()>>(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-        );
-        auto future = task_ptr->get_future();
+        std::promise<R> prom(std::allocator_arg, ArenaAllocator<R>{});
+        auto future = prom.get_future();
 
-        // Wrap in type-erased void() for the queue
-        Task task = [task_ptr]() { (*task_ptr)(); };
+        // Tasks are move-only, so the promise rides in the closure itself
+        // — no shared_ptr, and its shared state lives in the arena.
+        push_task([prom = std::move(prom),
+                   fn = std::bind(std::forward<F>(f), std::forward<Args>(args)...)]() mutable {
+            fulfil(prom, fn);
+        });
+        return future;
+    }
 
-        // Spin-retry if queue is temporarily full
-        // In production you'd expose this as backpressure to the caller
-        int retries = 0;
-        while (!queue_.try_enqueue(std::move(task))) {
-            if (stop_) throw std::runtime_error("Pool stopped during enqueue");
-            ++retries;
-            if (retries > 1000)
-                throw std::runtime_error("ThreadPoolV2: queue full after 1000 retries");
-            std::this_thread::yield();
-        }
+    /**
+     * post — submit a fire-and-forget callable (no future, no shared state).
+     *
+     * enqueue() pays for a promise, its shared state and a future on
+     * every call. Runtimes built on top of the pool (actors,
+     * pipelines) never wait on individual tasks, so they use post() and
+     * only pay for the task itself.
+     *
+     * An exception escaping f leaves the worker thread, so std::terminate
+     * ends the whole process — callers own error handling.
+     *
+     * Throws if the queues stay full for 1000 yields; use try_post() where
+     * a throw is not an option (on a worker thread it is std::terminate).
+     */
+    template<typename F>
+    void post(F&& f) {
+        if (stop_)
+            throw std::runtime_error("ThreadPoolV2: post on stopped pool");
+        push_task(Task(std::forward<F>(f)));
+    }
 
+    /**
+     * try_post — one placement attempt, no retry and no throw on a full
+     * queue: returns false and drops the task. Never uses the LIFO slot
+     * (displacing its occupant could itself meet a full queue).
+     */
+    template<typename F>
+    bool try_post(F&& f) {
+        if (stop_)
+            throw std::runtime_error("ThreadPoolV2: post on stopped pool");
+        Task task(std::forward<F>(f));
+        if (!try_push(task)) return false;
         ++total_enqueued_;
+        notify_work();
+        return true;
+    }
+
+    /**
+     * enqueue_to / post_to — submit to a specific worker's local queue.
+     *
+     * The task runs on `worker` unless that worker is busy long enough
+     * for an idle sibling to steal it. If the local queue is full the task
+     * falls back to normal placement. `worker` is taken modulo
+     * thread_count().
+     */
+    template<typename F, typename... Args>
+    auto enqueue_to(size_t worker, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type>
+    {
+        using R = typename std::invoke_result<F, Args...>::type;
+
+        if (stop_)
+            throw std::runtime_error("ThreadPoolV2: enqueue on stopped pool");
+
+        std::promise<R> prom(std::allocator_arg, ArenaAllocator<R>{});
+        auto future = prom.get_future();
+        push_task_to(worker, [prom = std::move(prom),
+                              fn = std::bind(std::forward<F>(f), std::forward<Args>(args)...)]() mutable {
+            fulfil(prom, fn);
+        });
         return future;
     }
 
+    template<typename F>
+    void post_to(size_t worker, F&& f) {
+        if (stop_)
+            throw std::runtime_error("ThreadPoolV2: post on stopped pool");
+        push_task_to(worker, Task(std::forward<F>(f)));
+    }
+
+    /**
+     * current_worker — index of the calling worker thread in THIS pool,
+     * or npos when called from any other thread.
+     */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    size_t current_worker() const {
+        return tls_worker_.pool == this ? tls_worker_.index : npos;
+    }
+
     /**
      * wait_all — block until queue is empty and no tasks are running.
      *
@@ -129,7 +471,15 @@ public:
      */
     void wait_all() {
         // Spin until queue is drained and no tasks are executing.
-        while (!queue_.empty() || active_tasks_.load(std::memory_order_acquire) > 0) {
+        while (true) {
+            bool queued = has_queued_work();
+            // Order the emptiness check before the active load. Workers
+            // take their active unit BEFORE dequeuing (seq_cst), so if the
+            // queues looked empty here, any task that left them is
+            // already counted below.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!queued && active_tasks_.load(std::memory_order_acquire) == 0)
+                break;
             std::this_thread::yield();
         }
         // Establish a happens-before edge with the last worker's fetch_sub.
@@ -149,25 +499,397 @@ public:
     }
 
     // --- Metrics (useful for SRE monitoring) ---
-    size_t queue_depth()      const { return queue_.size(); }
+    size_t queue_depth()      const {
+        size_t depth = queue_.size();
+        for (const auto& q : local_queues_) depth += q->size();
+        return depth;
+    }
     size_t active_count()     const { return active_tasks_.load(); }
-    size_t total_enqueued()   const { return total_enqueued_.load(); }
-    size_t total_completed()  const { return total_completed_.load(); }
+    size_t total_enqueued()   const { return static_cast<size_t>(total_enqueued_.load()); }
+    size_t total_completed()  const { return static_cast<size_t>(total_completed_.load()); }
     size_t thread_count()     const { return workers_.size(); }
+    QueueMode queue_mode()    const { return options_.queue_mode; }
+    WaitStrategy wait_strategy() const { return options_.wait_strategy; }
+    uint64_t total_spins()    const { return total_spins_.load(std::memory_order_relaxed); }
+    uint64_t total_parks()    const { return total_parks_.load(std::memory_order_relaxed); }
+
+    // Where `worker`'s time has gone so far (see UTILIZATION); all zero
+    // with PoolOptions::worker_stats off.
+    WorkerStats::Snapshot worker_stats(size_t worker) const {
+        return stats_[worker % workers_.size()].read();
+    }
+    // Fraction of all workers' time spent busy since they started.
+    double utilization() const { return WorkerStats::utilization(stats_.get(), workers_.size()); }
+    // The stats array (thread_count() entries), for exporters that may
+    // outlive the pool; after shutdown it holds the final totals.
+    std::shared_ptr<const WorkerStats[]> shared_worker_stats() const { return stats_; }
+
+    // Arena bytes in use by `worker`'s heap: task state that worker has
+    // allocated (follow-up tasks, closures it posted) and not yet freed.
+    size_t arena_bytes(size_t worker) const {
+        return arena_bytes(heaps_, worker % workers_.size());
+    }
+    // Each worker's heap slot (thread_count() entries), for exporters that
+    // may outlive the pool; read one with the static arena_bytes().
+    using WorkerHeaps = std::shared_ptr<std::atomic<const Arena::Heap*>[]>;
+    WorkerHeaps shared_worker_heaps() const { return heaps_; }
+    static size_t arena_bytes(const WorkerHeaps& heaps, size_t worker) {
+        const Arena::Heap* h = heaps[worker].load(std::memory_order_acquire);
+        return h ? h->bytes_in_use() : 0;   // null before start and after exit
+    }
 
     ~ThreadPoolV2() {
-        stop_.store(true, std::memory_order_release);
+        stop_.store(true, std::memory_order_seq_cst);
+        if (parking_) {
+            wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+            futex_wake_all(&wake_epoch_);
+        }
         // Drain any remaining tasks (graceful shutdown)
         // Workers will see stop_=true after draining
         for (auto& w : workers_)
             w.join();
+        // Workers drain the slots before exiting, so only the recycled
+        // spare boxes are normally left to free here.
+        for (size_t i = 0; i < local_queues_.size(); ++i) {
+            delete slots_[i].task.exchange(nullptr);
+            delete slots_[i].spare;
+        }
     }
 
     ThreadPoolV2(const ThreadPoolV2&) = delete;
     ThreadPoolV2& operator=(const ThreadPoolV2&) = delete;
 
 private:
-    using Task = std::function<void()>;
+    using Task  = UniqueTask;
+    using Queue = LockFreeQueue<Task, QueueCapacity>;
+
+    // Run fn and settle prom — what packaged_task::operator() does.
+    template<typename R, typename Fn>
+    static void fulfil(std::promise<R>& prom, Fn& fn) {
+        try {
+            if constexpr (std::is_void_v<R>) {
+                fn();
+                prom.set_value();
+            } else {
+                prom.set_value(fn());
+            }
+        } catch (...) {
+            prom.set_exception(std::current_exception());
+        }
+    }
+
+    // A slot task is heap-allocated so the slot itself is one atomic word
+    // that owners and thieves can exchange. Padded: the owner writes it on
+    // every spawn and should not bounce its neighbours' lines.
+    // `spare` is a recycled Task box, touched only by the slot's own worker,
+    // so a steady chain of hops allocates nothing.
+    struct alignas(64) LifoSlot {
+        std::atomic<Task*> task{nullptr};
+        Task*              spare = nullptr;
+    };
+
+    void push_task(Task task) {
+        if (options_.lifo_slot) {
+            size_t self = current_worker();
+            if (self != npos) { push_lifo(self, std::move(task)); return; }
+        }
+        place(task);
+        ++total_enqueued_;
+        notify_work();
+    }
+
+    // The slot occupant holds one unit of active_tasks_ from the moment it
+    // is published until it has run (or been moved back to a queue), so
+    // wait_all() never sees "no queued work, nothing active" while a task
+    // is in transit between the slot and a worker.
+    void push_lifo(size_t self, Task task) {
+        active_tasks_.fetch_add(1, std::memory_order_relaxed);
+        ++total_enqueued_;
+        LifoSlot& slot = slots_[self];
+        Task* box = slot.spare ? std::exchange(slot.spare, nullptr) : new Task;
+        *box = std::move(task);
+        Task* prev = slot.task.exchange(box, std::memory_order_acq_rel);
+        if (prev) demote(prev);
+        notify_work();   // a parked sibling may need to steal the slot
+    }
+
+    // Move a task out of a slot into the shared queue(s), releasing its
+    // active unit once it is visible there.
+    void demote(Task* t) {
+        std::unique_ptr<Task> owned(t);
+        try {
+            place(*owned);
+        } catch (...) {
+            active_tasks_.fetch_sub(1, std::memory_order_seq_cst);
+            throw;
+        }
+        active_tasks_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // Spin-retry if queue is temporarily full
+    // In production you'd expose this as backpressure to the caller
+    void place(Task& task) {
+        int retries = 0;
+        while (!try_push(task)) {
+            if (stop_) throw std::runtime_error("Pool stopped during enqueue");
+            ++retries;
+            if (retries > 1000)
+                throw std::runtime_error("ThreadPoolV2: queue full after 1000 retries");
+            std::this_thread::yield();
+        }
+    }
+
+    void push_task_to(size_t worker, Task task) {
+        if (local_queues_[worker % local_queues_.size()]->try_enqueue(std::move(task))) {
+            ++total_enqueued_;
+            notify_work();
+            return;
+        }
+        push_task(std::move(task));
+    }
+
+    // One placement attempt. Global: the shared ring. Sharded: the shorter
+    // of two random shards, then the other one, then any shard with room.
+    // A failed try_enqueue does not consume the task, so it can be
+    // offered to several shards in turn.
+    bool try_push(Task& task) {
+        if (options_.queue_mode == QueueMode::Global)
+            return queue_.try_enqueue(std::move(task));
+
+        const auto&  shards = local_queues_;
+        const size_t n      = shards.size();
+        uint64_t r = next_random();
+        size_t a = static_cast<size_t>(r % n);
+        size_t b = static_cast<size_t>((r >> 32) % n);
+        if (b == a) b = (a + 1) % n;
+        if (shards[b]->size() < shards[a]->size()) std::swap(a, b);
+
+        if (shards[a]->try_enqueue(std::move(task))) return true;
+        if (n > 1 && shards[b]->try_enqueue(std::move(task))) return true;
+        for (size_t i = 0; i < n; ++i)
+            if (shards[i]->try_enqueue(std::move(task))) return true;
+        return false;
+    }
+
+    // Worker side: own local queue, then the shared ring (Global mode),
+    // then siblings' local queues in ring order (stealing). Moves up to
+    // `max` tasks from the first non-empty queue into `out`.
+    // Lost dequeue races are added to `retries`.
+    size_t try_pop(size_t self, Task* out, size_t max, uint64_t& retries) {
+        const size_t n = local_queues_.size();
+        if (size_t got = local_queues_[self]->try_dequeue_bulk(out, max, retries))
+            return got;
+        if (options_.queue_mode == QueueMode::Global)
+            if (size_t got = queue_.try_dequeue_bulk(out, max, retries))
+                return got;
+        for (size_t k = 1; k < n; ++k)
+            if (size_t got = local_queues_[(self + k) % n]->try_dequeue_bulk(out, max, retries))
+                return got;
+        return 0;
+    }
+
+    // Next batch limit from what the last batch looked like (see BATCH
+    // DEQUEUE above).
+    size_t adapt_batch(size_t limit, size_t got, uint64_t elapsed_ns) const {
+        if (elapsed_ns > options_.batch_max_task_ns * got) return 1;
+        if (got == limit)     return std::min(limit * 2, options_.max_batch);
+        if (got < limit / 2)  return std::max<size_t>(limit / 2, 1);
+        return limit;
+    }
+
+    // Idle path: take a task parked in a sibling's LIFO slot.
+    Task* steal_slot(size_t self) {
+        const size_t n = local_queues_.size();
+        for (size_t k = 1; k < n; ++k) {
+            auto& slot = slots_[(self + k) % n].task;
+            if (slot.load(std::memory_order_relaxed))
+                if (Task* t = slot.exchange(nullptr, std::memory_order_acq_rel))
+                    return t;
+        }
+        return nullptr;
+    }
+
+    bool has_queued_work() const {
+        if (!queue_.empty()) return true;
+        for (const auto& q : local_queues_)
+            if (!q->empty()) return true;
+        if (options_.lifo_slot)
+            for (size_t i = 0; i < local_queues_.size(); ++i)
+                if (slots_[i].task.load(std::memory_order_acquire)) return true;
+        return false;
+    }
+
+    // ---- Idle handling (see WAIT STRATEGIES) ----
+
+    // Per-worker idle bookkeeping; lives on the worker's stack.
+    struct IdleState {
+        uint32_t rounds     = 0;    // consecutive empty polls
+        uint32_t spin_limit = 64;   // Adaptive: learned spin budget
+        bool     spun_into_work = false;
+        uint64_t spins = 0, parks = 0;  // not yet flushed
+        bool     busy  = false;         // ran work since the last idle round
+        WorkerStats* stats = nullptr;   // null with PoolOptions::worker_stats off
+        int64_t  mark  = 0;             // FastClock ns: start of the current lap
+    };
+
+    static constexpr int      SPIN_COUNT     = 64;   // spins per idle round
+    static constexpr uint32_t MIN_ADAPT_SPIN = 16;
+    static constexpr uint32_t MAX_ADAPT_SPIN = 1u << 14;
+
+    static void cpu_relax() {
+        // __builtin_ia32_pause() is the x86 PAUSE instruction.
+        // It hints to the CPU that we're spinning, reducing
+        // power consumption and memory contention.
+        // Falls back to nothing on non-x86.
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    // Spin up to `limit` times; true if work showed up.
+    bool spin_for_work(IdleState& st, uint32_t limit) {
+        bool found = false;
+        uint32_t i = 0;
+        while (i < limit) {
+            cpu_relax();
+            ++i;
+            if (has_queued_work()) { found = true; break; }
+        }
+        st.spins += i;
+        if (st.stats) st.stats->add_spin(lap(st));
+        return found;
+    }
+
+    // ns since st.mark, and restart the lap.
+    static int64_t lap(IdleState& st) {
+        int64_t now = FastClock::now_ns(), d = now - st.mark;
+        st.mark = now;
+        return d;
+    }
+
+    // Producer side of the futex handshake. The fence orders our publish
+    // (the enqueue) before the sleeper count load; park() orders its
+    // count increment before its queue check. One of the two must see
+    // the other, so a push can't slip past a worker going to sleep.
+    void notify_work() {
+        if (!parking_) return;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) == 0) return;
+        wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        futex_wake(&wake_epoch_, 1);
+    }
+
+    void park(IdleState& st) {
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t epoch = wake_epoch_.load(std::memory_order_seq_cst);
+        if (!stop_.load(std::memory_order_seq_cst) && !has_queued_work()) {
+            ++st.parks;
+            flush_idle(st);
+            futex_wait(&wake_epoch_, epoch);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void flush_idle(IdleState& st) {
+        if (st.spins) {
+            total_spins_.fetch_add(st.spins, std::memory_order_relaxed);
+            if (options_.spin_counter) options_.spin_counter->inc(st.spins);
+        }
+        if (st.parks) {
+            total_parks_.fetch_add(st.parks, std::memory_order_relaxed);
+            if (options_.park_counter) options_.park_counter->inc(st.parks);
+        }
+        st.spins = st.parks = 0;
+    }
+
+    // One idle round after an empty poll. With worker stats on it costs
+    // three FastClock reads: round start, after the spin, after the park.
+    void idle_wait(IdleState& st) {
+        if (st.stats) {
+            st.mark = FastClock::now_ns();
+            if (st.busy) st.stats->to_idle(st.mark);
+        }
+        st.busy = false;
+        if ((++st.rounds & 63) == 1) {
+            Epoch::collect();
+            Hazard::scan();
+            if (st.stats) st.mark = FastClock::now_ns();
+        }
+        switch (options_.wait_strategy) {
+        case WaitStrategy::BusySpin:
+            spin_for_work(st, SPIN_COUNT);
+            if (st.spins >= (1u << 20)) flush_idle(st);  // never parks
+            break;
+
+        case WaitStrategy::Yielding:
+            if (!spin_for_work(st, SPIN_COUNT)) {
+                // Still empty — yield the timeslice
+                ++st.parks;
+                std::this_thread::yield();
+            }
+            break;
+
+        case WaitStrategy::Sleeping:
+            if (spin_for_work(st, SPIN_COUNT)) break;
+            ++st.parks;
+            if (st.rounds < 16) {
+                std::this_thread::yield();
+            } else {
+                // 1µs, 2µs, 4µs … capped at ~1ms
+                uint32_t shift = std::min<uint32_t>(st.rounds - 16, 10);
+                std::this_thread::sleep_for(std::chrono::microseconds(1u << shift));
+            }
+            break;
+
+        case WaitStrategy::Blocking:
+            if (!spin_for_work(st, SPIN_COUNT)) park(st);
+            break;
+
+        case WaitStrategy::Adaptive:
+            if (spin_for_work(st, st.spin_limit)) {
+                st.spun_into_work = true;
+            } else {
+                st.spin_limit = std::max(st.spin_limit / 2, MIN_ADAPT_SPIN);
+                park(st);
+            }
+            break;
+        }
+        if (st.stats) st.stats->add_park(lap(st));   // ~0 if the spin found work
+    }
+
+    // Called when a poll succeeds after one or more idle rounds (or
+    // for the worker's first task).
+    void end_idle(IdleState& st) {
+        if (st.spun_into_work)
+            st.spin_limit = std::min(st.spin_limit * 2, MAX_ADAPT_SPIN);
+        st.spun_into_work = false;
+        st.rounds = 0;
+        st.busy = true;
+        if (st.stats) st.stats->to_busy(FastClock::now_ns());
+        flush_idle(st);
+    }
+
+    // Run a task taken from a slot. Its active unit was taken at push time.
+    void run_slot_task(size_t self, Task* t, IdleState& st) {
+        (*t)();
+        *t = nullptr;   // drop captures now, not when the box is reused
+        if (!slots_[self].spare) slots_[self].spare = t;
+        else                     delete t;
+        if (st.stats) st.stats->add_tasks(1);
+        ++total_completed_;
+        active_tasks_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // xorshift64 — per-thread, no shared state, a few cycles per call.
+    static uint64_t next_random() {
+        thread_local uint64_t state =
+            0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&state);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
 
     /**
      * worker_loop — each thread runs this forever.
@@ -175,62 +897,127 @@ private:
      * SPIN STRATEGY:
      *   1. Try to dequeue (lock-free CAS)
      *   2. If empty: spin a few times (cheap — stays in userspace)
-     *   3. If still empty: yield() — give up the CPU timeslice
+     *   3. If still empty: idle_wait() — by default yield() the
+     *      timeslice; see WAIT STRATEGIES for the alternatives
      *      (avoids wasting CPU when truly idle)
      *
-     * This is the same strategy used by the Linux kernel's
+     * The default is the same strategy used by the Linux kernel's
      * work queue and by the Go runtime scheduler.
      *
      * ACTIVE TASK ORDERING:
-     *   ++active_tasks_ happens BEFORE executing the task.
-     *   This closes the gap that would cause wait_all() to return
-     *   before all work is truly done.
+     *   ++active_tasks_ happens BEFORE the dequeue, and the unit is held
+     *   until the last task of the batch has run. This closes the gap
+     *   that would cause wait_all() to return before all work is truly
+     *   done.
      */
-    void worker_loop() {
-        constexpr int SPIN_COUNT = 64;  // spins before yielding
+    void worker_loop(size_t index) {
+        tls_worker_ = { this, index };
+        heaps_[index].store(&Arena::local_heap(), std::memory_order_release);
+        Epoch::register_thread();
+        IdleState idle;
+        if (options_.worker_stats) {
+            idle.stats = &stats_[index];
+            idle.stats->start(FastClock::now_ns());
+        }
+        auto&  own_slot = slots_[index].task;
+        size_t streak   = 0;  // consecutive tasks taken from own_slot
+        const bool batching = options_.max_batch > 1;
+        std::vector<Task> batch(options_.max_batch);  // private buffer
+        size_t limit = 1;     // current adaptive batch size
 
         while (true) {
-            // Try to get a task
-            if (auto task = queue_.try_dequeue()) {
-                // Increment BEFORE executing — closes the wait_all() gap.
-                // If we incremented after, wait_all() could observe
-                // queue.empty() && active==0 between dequeue and increment.
-                active_tasks_.fetch_add(1, std::memory_order_relaxed);
-                (*task)();              // execute
-                // seq_cst ensures all writes inside the task body are
+            // LIFO slot first — unless it has had its turn lately, in
+            // which case the FIFO queues get a look in before it.
+            if (streak < options_.lifo_budget && own_slot.load(std::memory_order_relaxed)) {
+                if (Task* t = own_slot.exchange(nullptr, std::memory_order_acq_rel)) {
+                    ++streak;
+                    run_slot_task(index, t, idle);
+                    continue;
+                }
+            }
+            streak = 0;
+
+            // Increment BEFORE dequeuing — closes the wait_all() gap.
+            // If we incremented after, wait_all() could observe
+            // queue.empty() && active==0 between dequeue and increment.
+            active_tasks_.fetch_add(1, std::memory_order_seq_cst);
+            uint64_t retries = 0;
+            size_t got = try_pop(index, batch.data(), limit, retries);
+            if (retries && idle.stats) idle.stats->add_retries(retries);
+            if (got) {
+                if (!idle.busy) end_idle(idle);
+                auto t0 = batching ? FastClock::now() : FastClock::time_point{};
+                for (size_t i = 0; i < got; ++i) {
+                    batch[i]();         // execute
+                    batch[i] = nullptr; // release captures promptly
+                }
+                // Count completion BEFORE dropping active_tasks_, so a
+                // caller returning from wait_all() sees the final total.
+                if (idle.stats) idle.stats->add_tasks(got);
+                total_completed_.fetch_add(got);
+                // seq_cst ensures all writes inside the task bodies are
                 // visible before active_tasks_ drops to zero.
                 // This pairs with the seq_cst fence in wait_all().
                 active_tasks_.fetch_sub(1, std::memory_order_seq_cst);
-                ++total_completed_;
+                if (batching) {
+                    auto ns = (FastClock::now() - t0).count();
+                    limit = adapt_batch(limit, got, static_cast<uint64_t>(ns));
+                }
                 continue;
             }
+            active_tasks_.fetch_sub(1, std::memory_order_relaxed);  // nothing taken
+
+            if (options_.lifo_slot) {
+                if (Task* t = own_slot.exchange(nullptr, std::memory_order_acq_rel)) {
+                    run_slot_task(index, t, idle);
+                    continue;
+                }
+                if (Task* t = steal_slot(index)) {
+                    if (!idle.busy) end_idle(idle);
+                    run_slot_task(index, t, idle);
+                    continue;
+                }
+            }
 
             // Queue was empty — should we stop?
-            if (stop_.load(std::memory_order_acquire) && queue_.empty())
+            if (stop_.load(std::memory_order_acquire) && !has_queued_work()) {
+                flush_idle(idle);
+                if (idle.stats) idle.stats->stop(FastClock::now_ns());
+                heaps_[index].store(nullptr, std::memory_order_release);   // abandoned from here
                 return;
-
-            // Spin a bit before yielding
-            for (int i = 0; i < SPIN_COUNT; ++i) {
-                // __builtin_ia32_pause() is the x86 PAUSE instruction.
-                // It hints to the CPU that we're spinning, reducing
-                // power consumption and memory contention.
-                // Falls back to nothing on non-x86.
-#if defined(__x86_64__) || defined(__i386__)
-                __builtin_ia32_pause();
-#endif
-                if (!queue_.empty()) break;
             }
 
-            // Still empty — yield the timeslice
-            std::this_thread::yield();
+            idle_wait(idle);
         }
     }
 
-    std::vector<std::thread>           workers_;
-    LockFreeQueue<Task, QueueCapacity> queue_;
+    PoolOptions                         options_;
+    std::vector<std::thread>            workers_;
+    Queue                               queue_;        // Global mode shared ring
+    std::vector<std::unique_ptr<Queue>> local_queues_; // one per worker: shard / inbox
+    std::unique_ptr<LifoSlot[]>         slots_;        // one per worker (lifo_slot)
+    WorkerHeaps                         heaps_;        // each worker's arena heap
+    std::shared_ptr<WorkerStats[]>      stats_;        // one per worker (see UTILIZATION)
+
+    // Which pool (if any) the current thread works for, and its index.
+    struct WorkerIdentity {
+        const ThreadPoolV2* pool  = nullptr;
+        size_t              index = npos;
+    };
+    static inline thread_local WorkerIdentity tls_worker_{};
 
     std::atomic<bool>   stop_;
     std::atomic<size_t> active_tasks_;
-    std::atomic<size_t> total_enqueued_;
-    std::atomic<size_t> total_completed_;
+    // Bumped on every task by every thread: sharded (metrics.h) so the
+    // totals don't become the one cache line all cores fight over.
+    ShardedAtomic<uint64_t> total_enqueued_;
+    ShardedAtomic<uint64_t> total_completed_;
+
+    // Blocking/Adaptive parking. sleepers_ lets producers skip the futex
+    // syscall entirely while every worker is awake.
+    bool                  parking_ = false;
+    std::atomic<uint32_t> wake_epoch_{0};
+    std::atomic<uint32_t> sleepers_{0};
+    std::atomic<uint64_t> total_spins_{0};
+    std::atomic<uint64_t> total_parks_{0};
 };
@@ -4,6 +4,9 @@
 #include "metrics.h"
 #include <chrono>
 #include <exception>
+#include <string>
+#include <vector>
+#include <time.h>
 
 /**
  * ThreadPoolV3 — Lock-Free Thread Pool with Prometheus Observability
@@ -24,88 +27,222 @@
  * The fix: after pool_.wait_all(), spin until
  *   tasks_completed + tasks_failed == tasks_submitted
  * This is the only signal that ALL V3 bookkeeping is finished.
+ *
+ * KEY AFFINITY:
+ * -------------
+ * enqueue_affine(key, f) hashes `key` to one worker and drops the task in
+ * that worker's inbox, so every task for a tenant/shard/session usually
+ * runs on the same core and finds its per-key data already in cache.
+ * Idle workers still steal from busy workers' inboxes, so a hot key
+ * costs locality, not throughput. Two counters show which one you got:
+ *   threadpool_affinity_hits_total    ran on the key's home worker
+ *   threadpool_affinity_steals_total  ran elsewhere (stolen under imbalance)
+ *
+ * IDLE BEHAVIOUR:
+ * ---------------
+ * The worker wait strategy (PoolOptions::wait_strategy) is reported as
+ *   threadpool_worker_spins_total     idle spin iterations
+ *   threadpool_worker_parks_total     yields / sleeps / futex waits
+ * A high park rate with a low task rate means the pool is oversized; a
+ * spin rate that dwarfs the task rate means BusySpin is burning cores.
+ *
+ * UTILIZATION:
+ * ------------
+ * threadpool_active_workers_current is an instant, and a scrape every
+ * 15 s samples it too rarely to size a pool by. The per-worker totals V2
+ * keeps (see UTILIZATION in threadpool_v2.h) are exported instead, read
+ * at scrape time (SampledMetric) so tasks pay nothing extra for them:
+ *
+ *   threadpool_worker_busy_seconds_total{worker="i"}     running tasks
+ *   threadpool_worker_idle_seconds_total{worker="i"}     not running tasks
+ *   threadpool_worker_spin_seconds_total{worker="i"}       of which spinning
+ *   threadpool_worker_park_seconds_total{worker="i"}       of which parked
+ *   threadpool_worker_tasks_total{worker="i"}
+ *   threadpool_worker_dequeue_retries_total{worker="i"}  lost dequeue races
+ *   threadpool_utilization_ratio                         Σ busy / Σ (busy + idle)
+ *
+ * The ratio is since start; for a window, divide rate()s of the busy
+ * and busy + idle counters. Utilization near 1 with a growing queue
+ * wait means too few workers; low utilization with a high park time
+ * means too many. Dequeue retries that rise with the worker count are
+ * contention on the shared ring — time for QueueMode::Sharded.
+ *
+ * LATENCY:
+ * --------
+ * threadpool_task_latency_seconds is an HdrHistogram (see metrics.h):
+ * ≤ 1% error from nanoseconds to an hour, so sub-100 µs tasks get real
+ * percentiles. /metrics shows it as _bucket series and as a _summary
+ * with p50/p90/p99/p999/max; task_latency() gives the Snapshot directly.
+ *
+ * A slow p99 is either queueing (add workers) or slow task bodies (fix
+ * the code), so the end-to-end time is also split at dequeue:
+ *
+ *   submit ──── queue wait ────▶ start ──── execution ────▶ end
+ *   t0                           t1                         t2
+ *
+ *   threadpool_task_queue_wait_seconds   t1 - t0    queue_wait()
+ *   threadpool_task_execution_seconds    t2 - t1    execution_time()
+ *   threadpool_task_latency_seconds      t2 - t0    task_latency()
+ *
+ * Three histograms from three timestamps: one now() more per task than
+ * the end-to-end histogram alone. The stamps come from FastClock (see
+ * fast_clock.h): a TSC read, not a steady_clock vDSO call.
+ *
+ * With metrics_policy::WithCpuTime<P>, threadpool_task_cpu_seconds
+ * adds the worker's CLOCK_THREAD_CPUTIME_ID
+ * delta across the body (cpu_time()); execution time far above CPU time
+ * means the task blocks. That clock is not vDSO-accelerated on most
+ * kernels (~100-300 ns per read), hence opt-in.
+ *
+ * ARENA:
+ * ------
+ * The promise and closure behind each task are allocated from the
+ * submitting thread's Arena heap (see arena.h). With gauges on, each
+ * worker's heap footprint is exported as
+ * threadpool_worker_arena_bytes{worker="<i>"}, read at scrape time, so
+ * tasks pay nothing for it; a value that only ever grows means something
+ * is leaking task state.
+ *
+ * METRICS POLICY:
+ * ---------------
+ * The second template parameter picks what is measured, at compile time
+ * (see metrics_policy below). Everything a policy turns off is removed
+ * by `if constexpr` — no clock reads, no queue_depth() loads, no metric
+ * registered — so ThreadPoolV3<N, metrics_policy::None> is the V3 API
+ * at V2 cost. Getters for metrics that are off return 0 / an empty
+ * snapshot.
+ *
+ *   policy        counters  gauges      latency     per task
+ *   Full          yes       every task  every task  3 now(), ~3 queue_depth()
+ *   Sampled<N>    yes       1 in N      1 in N      counters + 1/N of Full
+ *   CountersOnly  yes       no          no          3 sharded increments
+ *   None          no        no          no          nothing
  */
-template<size_t QueueCapacity = 1024>
+namespace metrics_policy {
+struct Full {
+    static constexpr bool     counters = true, gauges = true, latency = true, cpu_time = false;
+    static constexpr uint32_t sample_every = 1;
+};
+// Exact counters; queue depth and latency on every N-th
+// task each submitting thread makes. N must be a power of two.
+template<uint32_t N = 64>
+struct Sampled {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Sampled<N>: N must be a power of two");
+    static constexpr bool     counters = true, gauges = true, latency = true, cpu_time = false;
+    static constexpr uint32_t sample_every = N;
+};
+struct CountersOnly {
+    static constexpr bool     counters = true, gauges = false, latency = false, cpu_time = false;
+    static constexpr uint32_t sample_every = 1;
+};
+struct None {
+    static constexpr bool     counters = false, gauges = false, latency = false, cpu_time = false;
+    static constexpr uint32_t sample_every = 1;
+};
+// P plus per-task thread CPU time, on the tasks P times.
+template<typename P>
+struct WithCpuTime : P {
+    static_assert(P::latency, "WithCpuTime<P>: P must record latency");
+    static constexpr bool cpu_time = true;
+};
+} // namespace metrics_policy
+
+template<size_t QueueCapacity = 1024, typename Metrics = metrics_policy::Full>
 class ThreadPoolV3 {
+    static constexpr bool COUNTERS = Metrics::counters;
+    static constexpr bool GAUGES   = Metrics::gauges;
+    static constexpr bool LATENCY  = Metrics::latency;
+    static constexpr bool CPU_TIME = Metrics::cpu_time;
+    static constexpr bool ANY      = COUNTERS || GAUGES || LATENCY;
+
 public:
     explicit ThreadPoolV3(
         size_t num_threads = std::thread::hardware_concurrency(),
-        MetricsRegistry* registry = nullptr)
-        : pool_(num_threads)
+        MetricsRegistry* registry = nullptr,
+        PoolOptions options = {})
+        : private_registry_(registry || !ANY ? nullptr : std::make_unique<MetricsRegistry>())
+        , pool_(num_threads, with_wait_counters(
+              options, registry ? registry : private_registry_.get()))
     {
-        if (!registry) {
-            private_registry_ = std::make_unique<MetricsRegistry>();
-            registry = private_registry_.get();
-        }
+        if (!registry) registry = private_registry_.get();
 
-        tasks_submitted_ = registry->add_counter(
-            "threadpool_tasks_submitted_total",
-            "Total number of tasks submitted to the thread pool");
-        tasks_completed_ = registry->add_counter(
-            "threadpool_tasks_completed_total",
-            "Total number of tasks that completed successfully");
-        tasks_failed_ = registry->add_counter(
-            "threadpool_tasks_failed_total",
-            "Total number of tasks that threw an exception");
-        queue_depth_ = registry->add_gauge(
-            "threadpool_queue_depth_current",
-            "Current number of tasks waiting in the queue");
-        active_workers_ = registry->add_gauge(
-            "threadpool_active_workers_current",
-            "Current number of threads actively executing tasks");
-        thread_count_ = registry->add_gauge(
-            "threadpool_thread_count",
-            "Total number of worker threads in the pool");
-        thread_count_->set(static_cast<int64_t>(num_threads));
-        task_latency_ = registry->add_histogram(
-            "threadpool_task_latency_seconds",
-            "End-to-end task latency from submission to completion");
+        if constexpr (COUNTERS) {
+            tasks_submitted_ = registry->add_counter(
+                "threadpool_tasks_submitted_total",
+                "Total number of tasks submitted to the thread pool");
+            tasks_completed_ = registry->add_counter(
+                "threadpool_tasks_completed_total",
+                "Total number of tasks that completed successfully");
+            tasks_failed_ = registry->add_counter(
+                "threadpool_tasks_failed_total",
+                "Total number of tasks that threw an exception");
+            affinity_hits_ = registry->add_counter(
+                "threadpool_affinity_hits_total",
+                "Affine tasks that ran on their key's home worker");
+            affinity_steals_ = registry->add_counter(
+                "threadpool_affinity_steals_total",
+                "Affine tasks that were stolen by another worker");
+        }
+        if constexpr (GAUGES) {
+            queue_depth_ = registry->add_gauge(
+                "threadpool_queue_depth_current",
+                "Current number of tasks waiting in the queue");
+            active_workers_ = registry->add_gauge(
+                "threadpool_active_workers_current",
+                "Current number of threads actively executing tasks", /*sharded=*/true);
+            thread_count_ = registry->add_gauge(
+                "threadpool_thread_count",
+                "Total number of worker threads in the pool");
+            thread_count_->set(static_cast<int64_t>(num_threads));
+            register_worker_arenas(registry);
+        }
+        if constexpr (LATENCY) {
+            task_latency_ = registry->add_hdr_histogram(
+                "threadpool_task_latency_seconds",
+                "End-to-end task latency from submission to completion");
+            queue_wait_ = registry->add_hdr_histogram(
+                "threadpool_task_queue_wait_seconds",
+                "Time from submission until a worker started the task");
+            execution_ = registry->add_hdr_histogram(
+                "threadpool_task_execution_seconds",
+                "Wall time a worker spent running the task");
+        }
+        if constexpr (CPU_TIME)
+            cpu_time_ = registry->add_hdr_histogram(
+                "threadpool_task_cpu_seconds",
+                "Worker thread CPU time spent running the task");
+        if constexpr (COUNTERS)
+            if (options.worker_stats) register_worker_stats(registry);
     }
 
     template<typename F, typename... Args>
     auto enqueue(F&& f, Args&&... args)
         -> std::future<typename std::invoke_result<F, Args...>::type>
     {
-        using R = typename std::invoke_result<F, Args...>::type;
-
-        auto submit_time = std::chrono::steady_clock::now();
-        tasks_submitted_->inc();
-
-        auto prom = std::make_shared<std::promise<R>>();
-        auto future = prom->get_future();
-        auto fn = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
-
-        auto wrapper = [this, prom, fn=std::move(fn), submit_time]() mutable {
-            active_workers_->inc();
-            queue_depth_->set(static_cast<int64_t>(pool_.queue_depth()));
-
-            bool ok = true;
-            try {
-                if constexpr (std::is_void_v<R>) {
-                    fn();
-                    prom->set_value();
-                } else {
-                    prom->set_value(fn());
-                }
-            } catch (...) {
-                prom->set_exception(std::current_exception());
-                tasks_failed_->inc();
-                ok = false;
-            }
-
-            // Update metrics BEFORE decrementing active_workers_.
-            // wait_all() polls tasks_completed+tasks_failed==tasks_submitted
-            // so these must be committed before we signal "done".
-            task_latency_->observe_since(submit_time);
-            if (ok) tasks_completed_->inc();
+        return submit(NO_AFFINITY, std::forward<F>(f), std::forward<Args>(args)...);
+    }
 
-            active_workers_->dec();
-            queue_depth_->set(static_cast<int64_t>(pool_.queue_depth()));
-        };
+    /**
+     * enqueue_affine — like enqueue(), but tasks with equal keys prefer
+     * the same worker. K must be hashable with std::hash<K>.
+     */
+    template<typename K, typename F, typename... Args>
+    auto enqueue_affine(const K& key, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type>
+    {
+        return submit(home_worker(key), std::forward<F>(f), std::forward<Args>(args)...);
+    }
 
-        pool_.enqueue(std::move(wrapper));
-        queue_depth_->set(static_cast<int64_t>(pool_.queue_depth()));
-        return future;
+    // home_worker — the worker that tasks for `key` are routed to.
+    template<typename K>
+    size_t home_worker(const K& key) const {
+        // std::hash<int> is the identity on libstdc++; mix the bits
+        // (splitmix64 finalizer) so sequential keys spread evenly.
+        uint64_t h = static_cast<uint64_t>(std::hash<K>{}(key));
+        h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 27; h *= 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        return static_cast<size_t>(h % pool_.thread_count());
     }
 
     /**
@@ -127,29 +264,223 @@ public:
         pool_.wait_all();
 
         // Phase 2: ensure all V3 metric bookkeeping is complete.
-        size_t submitted = tasks_submitted_->get();
-        while (tasks_completed_->get() + tasks_failed_->get() < submitted) {
-            std::this_thread::yield();
+        if constexpr (COUNTERS) {
+            size_t submitted = tasks_submitted_->get();
+            while (tasks_completed_->get() + tasks_failed_->get() < submitted) {
+                std::this_thread::yield();
+            }
         }
 
-        queue_depth_->set(0);
-        active_workers_->set(0);
+        if constexpr (GAUGES) {
+            queue_depth_->set(0);
+            active_workers_->set(0);
+        }
     }
 
-    size_t tasks_submitted()  const { return tasks_submitted_->get(); }
-    size_t tasks_completed()  const { return tasks_completed_->get(); }
-    size_t tasks_failed()     const { return tasks_failed_->get(); }
+    size_t tasks_submitted()  const { return COUNTERS ? tasks_submitted_->get() : 0; }
+    size_t tasks_completed()  const { return COUNTERS ? tasks_completed_->get() : 0; }
+    size_t tasks_failed()     const { return COUNTERS ? tasks_failed_->get() : 0; }
     size_t queue_depth()      const { return pool_.queue_depth(); }
     size_t active_workers()   const { return pool_.active_count(); }
     size_t thread_count()     const { return pool_.thread_count(); }
+    size_t affinity_hits()    const { return COUNTERS ? affinity_hits_->get() : 0; }
+    size_t affinity_steals()  const { return COUNTERS ? affinity_steals_->get() : 0; }
+    size_t arena_bytes(size_t worker) const { return pool_.arena_bytes(worker); }
+    WorkerStats::Snapshot worker_stats(size_t worker) const { return pool_.worker_stats(worker); }
+    double utilization() const { return pool_.utilization(); }
+    HdrHistogram::Snapshot task_latency() const {
+        return LATENCY ? task_latency_->snapshot() : HdrHistogram::Snapshot{};
+    }
+    HdrHistogram::Snapshot queue_wait() const {
+        return LATENCY ? queue_wait_->snapshot() : HdrHistogram::Snapshot{};
+    }
+    HdrHistogram::Snapshot execution_time() const {
+        return LATENCY ? execution_->snapshot() : HdrHistogram::Snapshot{};
+    }
+    HdrHistogram::Snapshot cpu_time() const {
+        return CPU_TIME ? cpu_time_->snapshot() : HdrHistogram::Snapshot{};
+    }
 
     ~ThreadPoolV3() = default;
     ThreadPoolV3(const ThreadPoolV3&) = delete;
     ThreadPoolV3& operator=(const ThreadPoolV3&) = delete;
 
 private:
-    ThreadPoolV2<QueueCapacity>      pool_;
+    static constexpr size_t NO_AFFINITY = ThreadPoolV2<QueueCapacity>::npos;
+
+    // Stands in for the submit timestamp when latency is compiled out.
+    struct NoStamp {};
+    using Stamp = std::conditional_t<LATENCY, FastClock::time_point, NoStamp>;
+
+    static uint64_t ns_between(FastClock::time_point a, FastClock::time_point b) noexcept {
+        auto d = (b - a).count();
+        return d > 0 ? static_cast<uint64_t>(d) : 0;
+    }
+    static uint64_t thread_cpu_ns() noexcept {
+        timespec ts;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000 + uint64_t(ts.tv_nsec);
+    }
+
+    // Sampled<N>: true for every N-th task the calling thread submits.
+    // A thread-local count, so sampling adds no shared write.
+    static bool sample_this() noexcept {
+        if constexpr (Metrics::sample_every == 1) {
+            return true;
+        } else {
+            thread_local uint32_t n = 0;
+            return (n++ & (Metrics::sample_every - 1)) == 0;
+        }
+    }
+
+    // The spin/park counters have to exist before pool_ starts its workers.
+    static PoolOptions with_wait_counters(PoolOptions options, MetricsRegistry* registry) {
+        if constexpr (!COUNTERS) return options;
+        if (!options.spin_counter)
+            options.spin_counter = registry->add_counter(
+                "threadpool_worker_spins_total",
+                "Idle spin iterations across all workers");
+        if (!options.park_counter)
+            options.park_counter = registry->add_counter(
+                "threadpool_worker_parks_total",
+                "Times an idle worker yielded, slept or blocked");
+        return options;
+    }
+
+    // Per-worker totals, read from V2's stats at scrape time. The lambdas
+    // hold the stats array, not `this`, so a registry that outlives the
+    // pool keeps serving the final values.
+    void register_worker_stats(MetricsRegistry* registry) {
+        std::shared_ptr<const WorkerStats[]> stats = pool_.shared_worker_stats();
+        const size_t n = pool_.thread_count();
+        std::vector<std::string> ids;
+        for (size_t i = 0; i < n; ++i) ids.push_back(std::to_string(i));
+
+        using Field = uint64_t WorkerStats::Snapshot::*;
+        auto add = [&](const char* name, const char* help, Field field, double scale) {
+            registry->add_sampled_family(name, help, Counter::TYPE, "worker", ids,
+                [stats, field, scale](size_t i) {
+                    return static_cast<double>(stats[i].read().*field) * scale;
+                });
+        };
+        add("threadpool_worker_busy_seconds_total",
+            "Time this worker spent running tasks", &WorkerStats::Snapshot::busy_ns, 1e-9);
+        add("threadpool_worker_idle_seconds_total",
+            "Time this worker spent without a task (includes spin and park)",
+            &WorkerStats::Snapshot::idle_ns, 1e-9);
+        add("threadpool_worker_spin_seconds_total",
+            "Idle time this worker spent spinning", &WorkerStats::Snapshot::spin_ns, 1e-9);
+        add("threadpool_worker_park_seconds_total",
+            "Idle time this worker spent yielded, sleeping or blocked",
+            &WorkerStats::Snapshot::park_ns, 1e-9);
+        add("threadpool_worker_tasks_total",
+            "Tasks this worker ran", &WorkerStats::Snapshot::tasks, 1.0);
+        add("threadpool_worker_dequeue_retries_total",
+            "Dequeue attempts this worker lost to another worker",
+            &WorkerStats::Snapshot::dequeue_retries, 1.0);
+        registry->add_sampled("threadpool_utilization_ratio",
+            "Fraction of worker time spent running tasks since the pool started",
+            Gauge::TYPE, [stats, n] { return WorkerStats::utilization(stats.get(), n); });
+    }
+
+    // Each worker's arena footprint, also read at scrape time through
+    // V2's heap slots, which outlive the pool like the stats array does
+    // (a worker clears its slot when it exits, so the family reads 0).
+    void register_worker_arenas(MetricsRegistry* registry) {
+        auto heaps = pool_.shared_worker_heaps();
+        std::vector<std::string> ids;
+        for (size_t i = 0; i < pool_.thread_count(); ++i) ids.push_back(std::to_string(i));
+        registry->add_sampled_family("threadpool_worker_arena_bytes",
+            "Arena bytes in use by this worker's heap", Gauge::TYPE, "worker", ids,
+            [heaps](size_t i) {
+                return static_cast<double>(ThreadPoolV2<QueueCapacity>::arena_bytes(heaps, i));
+            });
+    }
+
+    template<typename F, typename... Args>
+    auto submit(size_t home, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type>
+    {
+        using R = typename std::invoke_result<F, Args...>::type;
+
+        // Gauges and latency are taken for sampled tasks only (all of
+        // them unless the policy is Sampled<N>).
+        const bool sampled = (GAUGES || LATENCY) && sample_this();
+        Stamp submit_time{};
+        if constexpr (LATENCY)
+            if (sampled) submit_time = FastClock::now();
+        if constexpr (COUNTERS) tasks_submitted_->inc();
+
+        std::promise<R> prom(std::allocator_arg, ArenaAllocator<R>{});
+        auto future = prom.get_future();
+        auto fn = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+
+        auto wrapper = [this, prom=std::move(prom), fn=std::move(fn), submit_time, home,
+                        sampled]() mutable {
+            if constexpr (COUNTERS)
+                if (home != NO_AFFINITY)
+                    (pool_.current_worker() == home ? affinity_hits_ : affinity_steals_)->inc();
+            if constexpr (GAUGES) {
+                active_workers_->inc();
+                if (sampled) queue_depth_->set(static_cast<int64_t>(pool_.queue_depth()));
+            }
+            Stamp start_time{};
+            uint64_t cpu_start = 0;
+            if constexpr (LATENCY)
+                if (sampled) start_time = FastClock::now();
+            if constexpr (CPU_TIME)
+                if (sampled) cpu_start = thread_cpu_ns();
+            (void)start_time; (void)cpu_start;
+
+            bool ok = true;
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    fn();
+                    prom.set_value();
+                } else {
+                    prom.set_value(fn());
+                }
+            } catch (...) {
+                prom.set_exception(std::current_exception());
+                if constexpr (COUNTERS) tasks_failed_->inc();
+                ok = false;
+            }
+            (void)ok;
+
+            // Update metrics BEFORE decrementing active_workers_.
+            // wait_all() polls tasks_completed+tasks_failed==tasks_submitted
+            // so these must be committed before we signal "done".
+            if constexpr (CPU_TIME)
+                if (sampled) cpu_time_->record_ns(thread_cpu_ns() - cpu_start);
+            if constexpr (LATENCY) {
+                if (sampled) {
+                    auto end_time = FastClock::now();
+                    queue_wait_->record_ns(ns_between(submit_time, start_time));
+                    execution_->record_ns(ns_between(start_time, end_time));
+                    task_latency_->record_ns(ns_between(submit_time, end_time));
+                }
+            }
+            if constexpr (COUNTERS)
+                if (ok) tasks_completed_->inc();
+
+            if constexpr (GAUGES) {
+                active_workers_->dec();
+                if (sampled) queue_depth_->set(static_cast<int64_t>(pool_.queue_depth()));
+            }
+        };
+
+        // post(), not enqueue(): the promise above already carries the
+        // result, so a second packaged_task + future per task is waste.
+        if (home == NO_AFFINITY) pool_.post(std::move(wrapper));
+        else                     pool_.post_to(home, std::move(wrapper));
+        if constexpr (GAUGES)
+            if (sampled) queue_depth_->set(static_cast<int64_t>(pool_.queue_depth()));
+        return future;
+    }
+
+    // Declared before pool_ so they outlive the workers that update them.
     std::unique_ptr<MetricsRegistry> private_registry_;
+    ThreadPoolV2<QueueCapacity>      pool_;
 
     Counter*   tasks_submitted_{nullptr};
     Counter*   tasks_completed_{nullptr};
@@ -157,5 +488,10 @@ private:
     Gauge*     queue_depth_{nullptr};
     Gauge*     active_workers_{nullptr};
     Gauge*     thread_count_{nullptr};
-    Histogram* task_latency_{nullptr};
+    HdrHistogram* task_latency_{nullptr};
+    HdrHistogram* queue_wait_{nullptr};
+    HdrHistogram* execution_{nullptr};
+    HdrHistogram* cpu_time_{nullptr};
+    Counter*   affinity_hits_{nullptr};
+    Counter*   affinity_steals_{nullptr};
 };
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lockfree_queue.h"
+
+/**
+ * TypedPool<Job, Handler> — homogeneous pool with no type erasure
+ * ================================================================
+ *
+ * ThreadPoolV2 accepts ANY callable, so every task goes through a
+ * type-erased box: an indirect call the compiler can't see through, and
+ * for captures over 40 bytes an arena block. When every task is the same
+ * kind of work — "handle this connection", "parse this buffer" — all of
+ * that is overhead.
+ *
+ *   ThreadPoolV2                       TypedPool<Job, Handler>
+ *   ───────────────────────────        ───────────────────────────────
+ *   slot: UniqueTask ─► closure        slot: Job (stored by value)
+ *   worker: ops->invoke(buf)           worker: handler_(job)
+ *           (indirect call)                    (direct call, inlinable)
+ *   big capture → arena block          no allocation at all
+ *
+ * The ring holds Job itself, and Handler is a template parameter, so the
+ * worker loop is compiled for exactly this job and this handler — the
+ * handler body is typically inlined straight into the dequeue loop.
+ *
+ * USAGE:
+ *   struct Job { int fd; std::array<char, 64> buf; };
+ *   struct Handle { void operator()(Job& j) const { ... } };
+ *   TypedPool<Job, Handle> pool(4);
+ *   pool.submit(Job{fd, buf});
+ *   pool.wait_all();
+ *
+ * CONTRACT:
+ *   • Job must be default-constructible and move-assignable (it lives in
+ *     the ring slots).
+ *   • ONE Handler instance is shared by all workers and called
+ *     concurrently — make it stateless or internally synchronized.
+ *   • Handler(Job&) should not throw; an escaping exception terminates
+ *     the worker, as with ThreadPoolV2::post().
+ *
+ * Workers claim up to max_batch jobs per CAS (LockFreeQueue::
+ * try_dequeue_bulk) and spin-then-yield when idle. The batch size is
+ * fixed, not adaptive — pass max_batch = 1 when jobs are slow enough
+ * that one worker hoarding 16 of them would idle its siblings.
+ * wait_all() uses the same active-before-dequeue protocol as ThreadPoolV2.
+ */
+template<typename Job, typename Handler, size_t QueueCapacity = 1024>
+class TypedPool {
+    static_assert(std::is_default_constructible_v<Job>, "Job must be default-constructible");
+    static_assert(std::is_move_assignable_v<Job>, "Job must be move-assignable");
+    static_assert(std::is_invocable_v<Handler&, Job&>, "Handler must be callable as handler(Job&)");
+
+public:
+    explicit TypedPool(size_t num_threads = std::thread::hardware_concurrency(),
+                       Handler handler = Handler{},
+                       size_t max_batch = 16)
+        : handler_(std::move(handler)), max_batch_(max_batch)
+    {
+        if (num_threads == 0)
+            throw std::invalid_argument("TypedPool: need at least 1 thread");
+        if (max_batch_ == 0)
+            throw std::invalid_argument("TypedPool: max_batch must be >= 1");
+        workers_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i)
+            workers_.emplace_back([this] { worker_loop(); });
+    }
+
+    ~TypedPool() {
+        stop_.store(true, std::memory_order_seq_cst);
+        for (auto& w : workers_) w.join();
+    }
+
+    TypedPool(const TypedPool&) = delete;
+    TypedPool& operator=(const TypedPool&) = delete;
+
+    /**
+     * try_submit — one attempt. On false the queue was full and `job`
+     * is untouched, so the caller still owns it.
+     */
+    bool try_submit(Job&& job) {
+        if (stop_.load(std::memory_order_relaxed))
+            throw std::runtime_error("TypedPool: submit on stopped pool");
+        if (!queue_.try_enqueue(std::move(job))) return false;
+        submitted_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // submit — retry while the queue is full (same policy as ThreadPoolV2).
+    void submit(Job job) {
+        int retries = 0;
+        while (!try_submit(std::move(job))) {
+            if (++retries > 1000)
+                throw std::runtime_error("TypedPool: queue full after 1000 retries");
+            std::this_thread::yield();
+        }
+    }
+
+    // Block until every submitted job has been handled.
+    void wait_all() {
+        while (true) {
+            bool queued = !queue_.empty();
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!queued && active_.load(std::memory_order_acquire) == 0) break;
+            std::this_thread::yield();
+        }
+        // Same TSan edge as ThreadPoolV2::wait_all().
+        (void)active_.load(std::memory_order_seq_cst);
+    }
+
+    size_t queue_depth()     const { return queue_.size(); }
+    size_t thread_count()    const { return workers_.size(); }
+    size_t total_submitted() const { return submitted_.load(std::memory_order_relaxed); }
+    size_t total_completed() const { return completed_.load(std::memory_order_relaxed); }
+
+    Handler&       handler()       { return handler_; }
+    const Handler& handler() const { return handler_; }
+
+private:
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    void worker_loop() {
+        std::vector<Job> batch(max_batch_);   // private buffer
+        int idle = 0;
+        while (true) {
+            // Increment BEFORE dequeuing — see ThreadPoolV2's
+            // ACTIVE TASK COUNTING note.
+            active_.fetch_add(1, std::memory_order_seq_cst);
+            if (size_t got = queue_.try_dequeue_bulk(batch.data(), max_batch_)) {
+                for (size_t i = 0; i < got; ++i) {
+                    handler_(batch[i]);
+                    // Release what the job owns now, not when the buffer
+                    // slot is next overwritten.
+                    if constexpr (!std::is_trivially_destructible_v<Job>) batch[i] = Job{};
+                }
+                completed_.fetch_add(got, std::memory_order_relaxed);
+                active_.fetch_sub(1, std::memory_order_seq_cst);
+                idle = 0;
+                continue;
+            }
+            active_.fetch_sub(1, std::memory_order_relaxed);
+
+            if (stop_.load(std::memory_order_acquire) && queue_.empty()) return;
+            if (++idle < 64) cpu_relax();
+            else             std::this_thread::yield();
+        }
+    }
+
+    Handler                     handler_;
+    const size_t                max_batch_;
+    LockFreeQueue<Job, QueueCapacity> queue_;
+    std::vector<std::thread>    workers_;
+
+    std::atomic<bool>   stop_{false};
+    std::atomic<size_t> active_{0};
+    std::atomic<size_t> submitted_{0};
+    std::atomic<size_t> completed_{0};
+};
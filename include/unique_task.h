@@ -0,0 +1,152 @@
+#pragma once
+
+/**
+ * unique_task.h — Move-only void() callable with inline storage
+ * ===============================================================
+ *
+ * WHY NOT std::function<void()>?
+ * ------------------------------
+ *   1. It must be COPYABLE, so a closure that owns a promise or a
+ *      unique_ptr has to be wrapped in a shared_ptr first — one more heap
+ *      allocation and an atomic refcount per task.
+ *   2. Its inline buffer is 16 bytes on libstdc++. Anything bigger
+ *      (this + a promise + a timestamp already is) goes to malloc on the
+ *      producer and back to free() on the worker.
+ *
+ * UniqueTask is move-only and keeps closures of up to INLINE_SIZE bytes
+ * inside itself. Bigger ones live in the Arena (arena.h), whose
+ * remote-free stacks make the producer→worker hand-off cheap.
+ *
+ *   ┌──────────────────────────────────────┬────────┐
+ *   │ 40-byte inline buffer (or F* → arena) │ ops*   │   48 bytes: with the
+ *   └──────────────────────────────────────┴────────┘   ring's sequence word
+ *                                                        a slot stays one line
+ *
+ * `ops` points at a per-type table of three functions (invoke, move,
+ * destroy) — the same thing a vtable would be, without requiring the
+ * closure to inherit from anything.
+ */
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "arena.h"
+
+class UniqueTask {
+public:
+    static constexpr size_t INLINE_SIZE = 40;
+
+    UniqueTask() noexcept = default;
+    UniqueTask(std::nullptr_t) noexcept {}
+
+    template<typename F,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, UniqueTask>>>
+    UniqueTask(F&& f) {
+        using Fn = std::decay_t<F>;
+        static_assert(std::is_invocable_v<Fn&>, "UniqueTask needs a void() callable");
+        if constexpr (fits_inline<Fn>()) {
+            ::new (static_cast<void*>(buf_)) Fn(std::forward<F>(f));
+            ops_ = &inline_ops<Fn>;
+        } else {
+            void* mem = allocate<Fn>();
+            try {
+                ::new (mem) Fn(std::forward<F>(f));
+            } catch (...) {
+                deallocate<Fn>(mem);
+                throw;
+            }
+            *reinterpret_cast<void**>(buf_) = mem;
+            ops_ = &boxed_ops<Fn>;
+        }
+    }
+
+    UniqueTask(UniqueTask&& o) noexcept : ops_(o.ops_) {
+        if (ops_) { ops_->move(buf_, o.buf_); o.ops_ = nullptr; }
+    }
+
+    UniqueTask& operator=(UniqueTask&& o) noexcept {
+        if (this != &o) {
+            reset();
+            if (o.ops_) { o.ops_->move(buf_, o.buf_); ops_ = std::exchange(o.ops_, nullptr); }
+        }
+        return *this;
+    }
+
+    UniqueTask& operator=(std::nullptr_t) noexcept { reset(); return *this; }
+
+    UniqueTask(const UniqueTask&) = delete;
+    UniqueTask& operator=(const UniqueTask&) = delete;
+
+    ~UniqueTask() { reset(); }
+
+    void operator()() { ops_->invoke(buf_); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    // True if the callable lives in the inline buffer (no arena block).
+    bool is_inline() const noexcept { return ops_ && ops_->is_inline; }
+
+    template<typename F>
+    static constexpr bool fits_inline() {
+        return sizeof(F) <= INLINE_SIZE
+            && alignof(F) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<F>;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* buf);
+        void (*move)(void* dst, void* src) noexcept;   // also destroys src
+        void (*destroy)(void* buf) noexcept;
+        bool is_inline;
+    };
+
+    void reset() noexcept {
+        if (ops_) { ops_->destroy(buf_); ops_ = nullptr; }
+    }
+
+    template<typename Fn>
+    static void* allocate() {
+        if constexpr (alignof(Fn) > Arena::HEADER_SIZE)
+            return ::operator new(sizeof(Fn), std::align_val_t(alignof(Fn)));
+        else
+            return Arena::allocate(sizeof(Fn));
+    }
+
+    template<typename Fn>
+    static void deallocate(void* p) noexcept {
+        if constexpr (alignof(Fn) > Arena::HEADER_SIZE)
+            ::operator delete(p, std::align_val_t(alignof(Fn)));
+        else
+            Arena::deallocate(p);
+    }
+
+    template<typename Fn>
+    static constexpr Ops inline_ops = {
+        [](void* b) { (*std::launder(static_cast<Fn*>(b)))(); },
+        [](void* d, void* s) noexcept {
+            Fn* src = std::launder(static_cast<Fn*>(s));
+            ::new (d) Fn(std::move(*src));
+            src->~Fn();
+        },
+        [](void* b) noexcept { std::launder(static_cast<Fn*>(b))->~Fn(); },
+        true,
+    };
+
+    template<typename Fn>
+    static constexpr Ops boxed_ops = {
+        [](void* b) { (*static_cast<Fn*>(*static_cast<void**>(b)))(); },
+        [](void* d, void* s) noexcept { *static_cast<void**>(d) = *static_cast<void**>(s); },
+        [](void* b) noexcept {
+            Fn* f = static_cast<Fn*>(*static_cast<void**>(b));
+            f->~Fn();
+            deallocate<Fn>(f);
+        },
+        false,
+    };
+
+    alignas(std::max_align_t) unsigned char buf_[INLINE_SIZE];
+    const Ops* ops_ = nullptr;
+};
@@ -0,0 +1,132 @@
+/**
+ * test_arena.cpp — Arena heaps, remote frees, UniqueTask storage
+ */
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "arena.h"
+#include "unique_task.h"
+#include "threadpool_v3.h"
+
+TEST(Arena, FreedBlockIsReusedByItsOwner) {
+    Arena::Heap& heap = Arena::local_heap();
+    size_t before = heap.bytes_in_use();
+
+    void* a = Arena::allocate(112);   // 128-byte class
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % 16, 0u);
+    EXPECT_EQ(heap.bytes_in_use(), before + 128);
+    Arena::deallocate(a);
+    EXPECT_EQ(heap.bytes_in_use(), before);
+
+    void* b = Arena::allocate(100);   // same class → same block back
+    EXPECT_EQ(a, b);
+    Arena::deallocate(b);
+
+    void* big = Arena::allocate(Arena::MAX_SMALL + 1);   // operator new path
+    std::memset(big, 0xAB, Arena::MAX_SMALL + 1);
+    Arena::deallocate(big);
+}
+
+TEST(Arena, CrossThreadFreeGoesBackToOwner) {
+    Arena::Heap& heap = Arena::local_heap();
+    uint64_t remote_before = heap.remote_frees();
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 100; ++i) blocks.push_back(Arena::allocate(48));
+    size_t in_use = heap.bytes_in_use();
+
+    std::thread([&] { for (void* p : blocks) Arena::deallocate(p); }).join();
+
+    // Remote frees wait on the owner's stack until it needs a block.
+    EXPECT_EQ(heap.bytes_in_use(), in_use);
+    std::vector<void*> again;
+    for (int i = 0; i < 300; ++i) again.push_back(Arena::allocate(48));
+    EXPECT_EQ(heap.remote_frees(), remote_before + 100);
+    for (void* p : again) Arena::deallocate(p);
+}
+
+TEST(Arena, AbandonedHeapIsAdoptedAndDrained) {
+    // A thread allocates and exits; its blocks are freed afterwards.
+    std::vector<void*> orphans;
+    std::thread([&] { for (int i = 0; i < 64; ++i) orphans.push_back(Arena::allocate(200)); }).join();
+    for (void* p : orphans) Arena::deallocate(p);
+
+    // Later threads reuse abandoned heaps instead of creating new ones.
+    size_t heaps = Arena::heap_count();
+    for (int round = 0; round < 8; ++round)
+        std::thread([] { Arena::deallocate(Arena::allocate(64)); }).join();
+    EXPECT_EQ(Arena::heap_count(), heaps);
+}
+
+TEST(UniqueTask, SmallClosuresStayInlineLargeOnesUseTheArena) {
+    int hits = 0;
+    UniqueTask small([&hits] { ++hits; });
+    EXPECT_TRUE(small.is_inline());
+
+    std::array<char, 256> blob{};
+    blob[0] = 7;
+    UniqueTask large([&hits, blob] { hits += blob[0]; });
+    EXPECT_FALSE(large.is_inline());
+
+    // Move-only captures work, and moving keeps the callable intact.
+    auto owned = std::make_unique<int>(100);
+    UniqueTask mover([&hits, p = std::move(owned)] { hits += *p; });
+    UniqueTask moved = std::move(mover);
+    EXPECT_FALSE(static_cast<bool>(mover));
+
+    small();
+    large();
+    moved();
+    EXPECT_EQ(hits, 108);
+
+    moved = nullptr;
+    EXPECT_FALSE(static_cast<bool>(moved));
+}
+
+TEST(UniqueTask, PoolRunsLargeClosuresAndReportsWorkerArena) {
+    MetricsRegistry registry;
+    ThreadPoolV3<> pool(2, &registry);
+
+    // 256-byte captures: every closure lives in the arena.
+    std::atomic<int> sum{0};
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 200; ++i) {
+        std::array<int, 64> payload{};
+        payload[0] = i;
+        futures.push_back(pool.enqueue([&sum, payload] {
+            sum += payload[0];
+        }));
+    }
+    for (auto& f : futures) f.get();
+    pool.wait_all();
+    EXPECT_EQ(sum.load(), 199 * 200 / 2);
+
+    auto fut = pool.enqueue([] { return 42; });
+    EXPECT_EQ(fut.get(), 42);
+
+    auto err = pool.enqueue([]() -> int { throw std::runtime_error("x"); });
+    EXPECT_THROW(err.get(), std::runtime_error);
+    pool.wait_all();
+
+    std::string page = registry.serialize();
+    EXPECT_NE(page.find("# TYPE threadpool_worker_arena_bytes gauge"), std::string::npos);
+    EXPECT_NE(page.find("threadpool_worker_arena_bytes{worker=\"1\"} "), std::string::npos);
+}
+
+TEST(UniqueTask, WorkerArenaFamilyOutlivesThePool) {
+    // the family reads V2's shared heap slots, not the pool: a registry
+    // scraped after the pool is gone reports 0, not freed memory
+    MetricsRegistry registry;
+    {
+        ThreadPoolV3<> pool(2, &registry);
+        pool.enqueue([] {}).get();
+    }
+    std::string page = registry.serialize();
+    EXPECT_NE(page.find("threadpool_worker_arena_bytes{worker=\"0\"} 0\n"), std::string::npos);
+    EXPECT_NE(page.find("threadpool_worker_arena_bytes{worker=\"1\"} 0\n"), std::string::npos);
+}
@@ -0,0 +1,126 @@
+/**
+ * test_concurrent_hash_map.cpp — ConcurrentHashMap: basic ops, racing
+ * inserts, growth during concurrent reads, tombstone churn, pointer values
+ */
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "concurrent_hash_map.h"
+
+TEST(ConcurrentHashMap, InsertFindEraseSingleThread) {
+    ConcurrentHashMap<uint64_t, uint32_t> m(16);
+    EXPECT_TRUE(m.empty());
+    EXPECT_FALSE(m.find(1).has_value());
+
+    auto [v, inserted] = m.insert(1, 100);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(v, 100u);
+    auto [v2, inserted2] = m.insert(1, 200);   // first insert wins
+    EXPECT_FALSE(inserted2);
+    EXPECT_EQ(v2, 100u);
+
+    EXPECT_FALSE(m.insert_or_assign(1, 300));
+    EXPECT_EQ(*m.find(1), 300u);
+    EXPECT_TRUE(m.insert_or_assign(0, 7));     // key 0 and value 0xFFFFFFFF are ordinary
+    EXPECT_TRUE(m.insert_or_assign(2, 0xFFFFFFFFu));
+    EXPECT_EQ(*m.find(2), 0xFFFFFFFFu);
+    EXPECT_EQ(m.size(), 3u);
+
+    EXPECT_TRUE(m.erase(1));
+    EXPECT_FALSE(m.erase(1));
+    EXPECT_FALSE(m.erase(12345));
+    EXPECT_FALSE(m.contains(1));
+    EXPECT_TRUE(m.insert(1, 9).second);        // reinsert into the tombstone
+    EXPECT_EQ(m.size(), 3u);
+
+    EXPECT_THROW(m.insert(~0ull, 1), std::invalid_argument);
+}
+
+TEST(ConcurrentHashMap, RacingInsertsHaveExactlyOneWinnerPerKey) {
+    ConcurrentHashMap<uint32_t, uint32_t> m(16);   // forces resizes mid-race
+    const uint32_t KEYS = 20000;
+    const int THREADS = 4;
+    std::atomic<uint32_t> wins{0};
+    std::vector<std::vector<uint32_t>> seen(THREADS, std::vector<uint32_t>(KEYS));
+
+    std::vector<std::thread> ts;
+    for (int t = 0; t < THREADS; ++t)
+        ts.emplace_back([&, t] {
+            for (uint32_t k = 0; k < KEYS; ++k) {
+                auto [v, inserted] = m.insert(k, static_cast<uint32_t>(t));
+                if (inserted) wins.fetch_add(1, std::memory_order_relaxed);
+                seen[t][k] = v;
+            }
+        });
+    for (auto& th : ts) th.join();
+
+    EXPECT_EQ(wins.load(), KEYS);
+    EXPECT_EQ(m.size(), KEYS);
+    for (uint32_t k = 0; k < KEYS; ++k) {
+        uint32_t winner = *m.find(k);
+        for (int t = 0; t < THREADS; ++t) ASSERT_EQ(seen[t][k], winner) << "key " << k;
+    }
+    EXPECT_GT(m.resizes(), 5u);
+}
+
+TEST(ConcurrentHashMap, ReadersSeeStableKeysWhileTableGrows) {
+    ConcurrentHashMap<uint64_t, uint32_t> m(16);
+    for (uint64_t k = 0; k < 64; ++k) m.insert(k, static_cast<uint32_t>(k * 3));
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> misses{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r)
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed))
+                for (uint64_t k = 0; k < 64; ++k) {
+                    auto v = m.find(k);
+                    if (!v || *v != k * 3) misses.fetch_add(1);
+                }
+        });
+
+    for (uint64_t k = 1000; k < 60000; ++k) m.insert(k, 1);   // many migrations
+    stop = true;
+    for (auto& r : readers) r.join();
+
+    EXPECT_EQ(misses.load(), 0u);
+    EXPECT_GE(m.capacity(), 65536u);
+    for (uint64_t k = 1000; k < 60000; ++k) ASSERT_TRUE(m.contains(k)) << k;
+}
+
+TEST(ConcurrentHashMap, InsertEraseChurnDoesNotGrowTheTable) {
+    // Request-dedup pattern: every id is inserted once and erased soon
+    // after. Tombstones fill the table; same-size migrations drop them.
+    ConcurrentHashMap<uint64_t, uint32_t> m(256);
+    std::vector<std::thread> ts;
+    for (int t = 0; t < 4; ++t)
+        ts.emplace_back([&, t] {
+            for (uint64_t i = 0; i < 50000; ++i) {
+                uint64_t id = (i << 2) | static_cast<uint64_t>(t);
+                ASSERT_TRUE(m.insert(id, 1).second);
+                ASSERT_TRUE(m.erase(id));
+            }
+        });
+    for (auto& th : ts) th.join();
+
+    EXPECT_EQ(m.size(), 0u);
+    EXPECT_LE(m.capacity(), 1024u);
+    EXPECT_GT(m.resizes(), 10u);
+}
+
+TEST(ConcurrentHashMap, PointerValues) {
+    struct Entry { int id; };
+    Entry a{1}, b{2};
+    ConcurrentHashMap<uint64_t, Entry*> m;
+    EXPECT_TRUE(m.insert(10, &a).second);
+    EXPECT_EQ(m.insert(10, &b).first, &a);
+    EXPECT_TRUE(m.insert_or_assign(11, nullptr));
+    ASSERT_TRUE(m.find(11).has_value());
+    EXPECT_EQ(*m.find(11), nullptr);
+    EXPECT_EQ((*m.find(10))->id, 1);
+    EXPECT_THROW(m.insert(12, reinterpret_cast<Entry*>(reinterpret_cast<uintptr_t>(&a) + 1)),
+                 std::invalid_argument);
+}
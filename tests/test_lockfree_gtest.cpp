@@ -5,6 +5,9 @@
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <string>
+#include <iterator>
+#include <stdexcept>
 #include "lockfree_queue.h"
 #include "threadpool_v2.h"
 
@@ -143,3 +146,339 @@ TEST(ThreadPoolV2Test, MetricsAfterCompletion) {
     EXPECT_EQ(pool.total_completed(), 50u);
     EXPECT_EQ(pool.queue_depth(), 0u);
 }
+
+TEST(ThreadPoolV2Test, ShardedModeRunsAllTasks) {
+    PoolOptions opts;
+    opts.queue_mode = QueueMode::Sharded;
+    ThreadPoolV2<256> pool(4, opts);
+    EXPECT_EQ(pool.queue_mode(), QueueMode::Sharded);
+
+    std::atomic<int> count{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p)
+        producers.emplace_back([&] {
+            for (int i = 0; i < 500; ++i) pool.post([&count] { ++count; });
+        });
+    for (auto& t : producers) t.join();
+    auto f = pool.enqueue([](int x) { return x + 1; }, 41);
+    EXPECT_EQ(f.get(), 42);
+
+    pool.wait_all();
+    EXPECT_EQ(count, 2000);
+    EXPECT_EQ(pool.queue_depth(), 0u);
+    EXPECT_EQ(pool.total_completed(), 2001u);
+}
+
+TEST(LockFreeQueueTest, FailedEnqueueKeepsItem) {
+    LockFreeQueue<std::string, 2> q;
+    ASSERT_TRUE(q.try_enqueue(std::string("a")));
+    ASSERT_TRUE(q.try_enqueue(std::string("b")));
+    std::string item = "keep me";
+    EXPECT_FALSE(q.try_enqueue(std::move(item)));
+    EXPECT_EQ(item, "keep me") << "A rejected item must not be moved from";
+}
+
+TEST(ThreadPoolV2Test, PostToRunsTasksAndReportsWorkerIndex) {
+    ThreadPoolV2<256> pool(2);
+    EXPECT_EQ(pool.current_worker(), ThreadPoolV2<256>::npos);
+
+    std::atomic<int> count{0};
+    std::atomic<bool> bad_index{false};
+    for (int i = 0; i < 100; ++i)
+        pool.post_to(i, [&] {
+            if (pool.current_worker() >= pool.thread_count()) bad_index = true;
+            ++count;
+        });
+    auto f = pool.enqueue_to(1, [&] { return pool.current_worker(); });
+    EXPECT_LT(f.get(), 2u);
+
+    pool.wait_all();
+    EXPECT_EQ(count, 100);
+    EXPECT_FALSE(bad_index);
+}
+
+TEST(ThreadPoolV2Test, LifoSlotRunsChainsAndWaitAllSeesThem) {
+    PoolOptions opts;
+    opts.lifo_slot = true;
+    ThreadPoolV2<256> pool(4, opts);
+
+    // Each chain re-posts itself from inside a worker, so every hop goes
+    // through a LIFO slot (and displaces whatever was there).
+    std::atomic<int> hops{0};
+    std::function<void(int)> step = [&](int left) {
+        ++hops;
+        if (left > 0) pool.post([&, left] { step(left - 1); });
+    };
+    for (int c = 0; c < 8; ++c)
+        pool.post([&] { step(999); });
+
+    pool.wait_all();
+    EXPECT_EQ(hops, 8000);
+    EXPECT_EQ(pool.active_count(), 0u);
+    EXPECT_EQ(pool.total_completed(), pool.total_enqueued());
+}
+
+TEST(ThreadPoolV2Test, LifoSlotTaskIsStolenWhileOwnerBlocks) {
+    PoolOptions opts;
+    opts.lifo_slot = true;
+    ThreadPoolV2<256> pool(2, opts);
+
+    // The child lands in the parent's slot; the parent then blocks on it,
+    // so only the other worker stealing the slot can make progress.
+    auto parent = pool.enqueue([&] {
+        auto child = pool.enqueue([] { return 7; });
+        return child.get() * 6;
+    });
+    EXPECT_EQ(parent.get(), 42);
+    pool.wait_all();
+}
+
+TEST(LockFreeQueueTest, BulkDequeueKeepsFifoOrder) {
+    LockFreeQueue<int, 16> q;
+    for (int i = 0; i < 10; ++i) ASSERT_TRUE(q.try_enqueue(i));
+
+    int out[16];
+    EXPECT_EQ(q.try_dequeue_bulk(out, 4), 4u);
+    for (int i = 0; i < 4; ++i) EXPECT_EQ(out[i], i);
+    EXPECT_EQ(q.try_dequeue_bulk(out, 16), 6u);
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(out[i], i + 4);
+    EXPECT_EQ(q.try_dequeue_bulk(out, 16), 0u);
+
+    // Slots freed by a bulk dequeue are reusable across the wrap-around.
+    for (int i = 0; i < 16; ++i) ASSERT_TRUE(q.try_enqueue(100 + i));
+    EXPECT_FALSE(q.try_enqueue(0));
+    EXPECT_EQ(q.try_dequeue_bulk(out, 16), 16u);
+    EXPECT_EQ(out[15], 115);
+}
+
+TEST(ThreadPoolV2Test, BatchedWorkersKeepWaitAllExact) {
+    PoolOptions opts;
+    opts.max_batch = 32;
+    ThreadPoolV2<4096> pool(4, opts);
+
+    std::atomic<int> count{0};
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 2000; ++i)
+            pool.post([&count] { count.fetch_add(1, std::memory_order_relaxed); });
+        pool.wait_all();
+        ASSERT_EQ(count.load(), (round + 1) * 2000);
+        ASSERT_EQ(pool.total_completed(), pool.total_enqueued());
+        ASSERT_EQ(pool.active_count(), 0u);
+    }
+    EXPECT_THROW(ThreadPoolV2<16>(1, PoolOptions{QueueMode::Global, false, 3, 0}),
+                 std::invalid_argument);
+}
+
+TEST(ThreadPoolV2Test, EveryWaitStrategyWakesForWorkAfterIdling) {
+    for (auto ws : {WaitStrategy::BusySpin, WaitStrategy::Yielding, WaitStrategy::Sleeping,
+                    WaitStrategy::Blocking, WaitStrategy::Adaptive}) {
+        PoolOptions opts;
+        opts.wait_strategy = ws;
+        ThreadPoolV2<256> pool(3, opts);
+        EXPECT_EQ(pool.wait_strategy(), ws);
+
+        std::atomic<int> count{0};
+        for (int burst = 0; burst < 3; ++burst) {
+            for (int i = 0; i < 100; ++i) pool.post([&count] { ++count; });
+            pool.wait_all();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));  // go idle
+        }
+        // A future wait from outside the pool must be woken too.
+        EXPECT_EQ(pool.enqueue([] { return 9; }).get(), 9);
+        pool.wait_all();
+        EXPECT_EQ(count, 300);
+        if (ws != WaitStrategy::BusySpin) {
+            EXPECT_GT(pool.total_parks(), 0u);
+        }
+    }
+}
+
+namespace {
+// No default constructor; counts live instances and copies/moves.
+struct Tracked {
+    static inline int live = 0, copies = 0, moves = 0;
+    int         id;
+    std::string tag;
+    Tracked(int i, std::string t) : id(i), tag(std::move(t)) { ++live; }
+    Tracked(const Tracked& o) : id(o.id), tag(o.tag) { ++live; ++copies; }
+    Tracked(Tracked&& o) noexcept : id(o.id), tag(std::move(o.tag)) { ++live; ++moves; }
+    Tracked& operator=(Tracked&& o) noexcept { id = o.id; tag = std::move(o.tag); ++moves; return *this; }
+    ~Tracked() { --live; }
+    static void reset() { live = copies = moves = 0; }
+};
+}  // namespace
+
+TEST(LockFreeQueueTest, EmplaceAndConsumeNeedNoCopiesOrMoves) {
+    Tracked::reset();
+    {
+        LockFreeQueue<Tracked, 8> q;
+        EXPECT_EQ(Tracked::live, 0);               // slots are raw storage
+        for (int i = 0; i < 8; ++i) ASSERT_TRUE(q.try_emplace(i, "job" + std::to_string(i)));
+        EXPECT_FALSE(q.try_emplace(99, "full"));
+        EXPECT_EQ(Tracked::live, 8);
+
+        int seen = -1;
+        ASSERT_TRUE(q.try_consume([&](Tracked& t) { seen = t.id; EXPECT_EQ(t.tag, "job0"); }));
+        EXPECT_EQ(seen, 0);
+        EXPECT_EQ(Tracked::live, 7);               // consumed item destroyed in its slot
+
+        Tracked out(-1, "");
+        ASSERT_TRUE(q.try_dequeue(out));
+        EXPECT_EQ(out.id, 1);
+        EXPECT_EQ(out.tag, "job1");
+
+        EXPECT_EQ(Tracked::copies, 0);
+        EXPECT_EQ(Tracked::moves, 1);              // only the move-assign into `out`
+    }
+    // out plus the 6 never-dequeued items were all destroyed.
+    EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(LockFreeQueueTest, ThrowingConstructorLeavesSkippedSlot) {
+    struct Picky {
+        int v;
+        explicit Picky(int x) : v(x) { if (x < 0) throw std::invalid_argument("negative"); }
+    };
+    LockFreeQueue<Picky, 4> q;
+    ASSERT_TRUE(q.try_emplace(1));
+    EXPECT_THROW(q.try_emplace(-1), std::invalid_argument);
+    ASSERT_TRUE(q.try_emplace(2));
+
+    // The tombstone is skipped by both single and bulk consumers.
+    int first = 0;
+    ASSERT_TRUE(q.try_consume([&](Picky& p) { first = p.v; }));
+    EXPECT_EQ(first, 1);
+    Picky out(0);
+    ASSERT_TRUE(q.try_dequeue(out));
+    EXPECT_EQ(out.v, 2);
+    EXPECT_FALSE(q.try_dequeue(out));
+
+    // Wrap around past the tombstoned slot: it is reusable.
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(q.try_emplace(10 + i));
+    EXPECT_THROW(q.try_consume([](Picky&) { throw std::runtime_error("visitor"); }),
+                 std::runtime_error);
+    std::vector<Picky> rest;
+    EXPECT_EQ(q.try_dequeue_bulk(std::back_inserter(rest), 4), 3u);
+    EXPECT_EQ(rest.front().v, 11);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(LockFreeQueueTest, ThrowingMoveInBulkDequeueFreesClaimedSlots) {
+    struct Fragile {
+        int v = 0;
+        Fragile() = default;
+        explicit Fragile(int x) : v(x) {}
+        Fragile(Fragile&&) = default;
+        Fragile& operator=(Fragile&& o) {
+            if (o.v == 2) throw std::runtime_error("move");
+            v = o.v;
+            return *this;
+        }
+    };
+    LockFreeQueue<Fragile, 8> q;
+    for (int i = 0; i < 6; ++i) ASSERT_TRUE(q.try_emplace(i));
+
+    Fragile out[8];
+    EXPECT_THROW(q.try_dequeue_bulk(out, 8), std::runtime_error);
+    EXPECT_EQ(out[1].v, 1);   // taken before the throw
+    EXPECT_TRUE(q.empty());   // items 2..5 were claimed and dropped
+
+    // Every slot came back: the ring fills and drains all the way round.
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 8; ++i) ASSERT_TRUE(q.try_emplace(10 + i));
+        EXPECT_FALSE(q.try_emplace(0));
+        EXPECT_EQ(q.try_dequeue_bulk(out, 8), 8u);
+        EXPECT_EQ(out[7].v, 17);
+    }
+}
+
+TEST(LockFreeQueueTest, BulkDequeueCountsOnlyLostRaces) {
+    LockFreeQueue<int, 1024> q;
+    int out[8];
+    uint64_t retries = 0;
+    for (int i = 0; i < 100; ++i) ASSERT_TRUE(q.try_enqueue(i));
+    while (q.try_dequeue_bulk(out, 8, retries)) {}
+    EXPECT_EQ(retries, 0u);   // nobody to race with
+
+    // Competing consumers: every item still delivered exactly once.
+    constexpr int N = 20000;
+    std::atomic<int> consumed{0};
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> ts;
+    ts.emplace_back([&] {
+        for (int i = 1; i <= N; ++i)
+            while (!q.try_enqueue(i)) std::this_thread::yield();
+    });
+    for (int c = 0; c < 4; ++c)
+        ts.emplace_back([&] {
+            int buf[4];
+            uint64_t lost = 0;
+            while (consumed.load() < N) {
+                size_t got = q.try_dequeue_bulk(buf, 4, lost);
+                for (size_t i = 0; i < got; ++i) sum += buf[i];
+                consumed += static_cast<int>(got);
+            }
+        });
+    for (auto& t : ts) t.join();
+    EXPECT_EQ(consumed, N);
+    EXPECT_EQ(sum, static_cast<long long>(N) * (N + 1) / 2);
+}
+
+TEST(ThreadPoolV2Test, WorkerStatsSplitBusyAndIdleTime) {
+    PoolOptions opts;
+    opts.wait_strategy = WaitStrategy::Blocking;
+    std::shared_ptr<const WorkerStats[]> shared;
+    {
+        ThreadPoolV2<256> pool(2, opts);
+        auto total = [&pool] {
+            WorkerStats::Snapshot sum;
+            for (size_t i = 0; i < pool.thread_count(); ++i) {
+                WorkerStats::Snapshot s = pool.worker_stats(i);
+                sum.tasks += s.tasks;
+                sum.busy_ns += s.busy_ns;
+                sum.idle_ns += s.idle_ns;
+                sum.park_ns += s.park_ns;
+            }
+            return sum;
+        };
+
+        // A running task counts as busy before it finishes.
+        std::atomic<bool> release{false};
+        pool.post([&release] { while (!release) std::this_thread::sleep_for(1ms); });
+        std::this_thread::sleep_for(10ms);
+        uint64_t busy0 = total().busy_ns;
+        std::this_thread::sleep_for(30ms);
+        EXPECT_GE(total().busy_ns - busy0, 20'000'000u);
+        release = true;
+        pool.wait_all();
+
+        for (int i = 0; i < 2; ++i) pool.post([] { std::this_thread::sleep_for(40ms); });
+        pool.wait_all();
+        std::this_thread::sleep_for(60ms);   // both workers idle, parked on the futex
+
+        WorkerStats::Snapshot s = total();
+        EXPECT_EQ(s.tasks, 3u);
+        EXPECT_GE(s.busy_ns, 110'000'000u);   // 30 + 40 + 40 ms of task time at least
+        EXPECT_GE(s.idle_ns, 100'000'000u);   // 2 × 60 ms, minus wake-up slack
+        EXPECT_GT(s.park_ns, 0u);
+        EXPECT_LE(s.park_ns, s.idle_ns);
+        double u = pool.utilization();
+        EXPECT_GT(u, 0.0);
+        EXPECT_LT(u, 1.0);
+        shared = pool.shared_worker_stats();
+    }
+    // After shutdown the totals are final.
+    WorkerStats::Snapshot a = shared[0].read();
+    std::this_thread::sleep_for(10ms);
+    WorkerStats::Snapshot b = shared[0].read();
+    EXPECT_EQ(a.busy_ns + a.idle_ns, b.busy_ns + b.idle_ns);
+
+    opts.worker_stats = false;
+    ThreadPoolV2<256> off(2, opts);
+    std::atomic<int> count{0};
+    for (int i = 0; i < 50; ++i) off.post([&count] { ++count; });
+    off.wait_all();
+    EXPECT_EQ(count, 50);
+    EXPECT_EQ(off.worker_stats(0).tasks + off.worker_stats(1).tasks, 0u);
+    EXPECT_EQ(off.utilization(), 0.0);
+}
@@ -22,6 +22,11 @@
 #include <atomic>
 #include <vector>
 #include <stdexcept>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <algorithm>
+#include <sstream>
 
 #include "metrics.h"
 #include "threadpool_v3.h"
@@ -101,6 +106,45 @@ TEST(GaugeTest, IncDec) {
     EXPECT_EQ(g.get(), 2);
 }
 
+TEST(GaugeTest, ConcurrentIncDecThenSet) {
+    // inc/dec land in per-thread cells; set() must still override them all
+    Gauge g("inflight", "In-flight requests", /*sharded=*/true);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+        threads.emplace_back([&g]{
+            for (int j = 0; j < 10000; ++j) g.inc();
+            for (int j = 0; j < 5000; ++j)  g.dec();
+        });
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(g.get(), 8 * 5000);
+
+    g.set(10);
+    EXPECT_EQ(g.get(), 10);
+    std::thread([&g]{ g.inc(); g.inc(); g.dec(); }).join();
+    EXPECT_EQ(g.get(), 11);
+}
+
+TEST(GaugeTest, UnshardedByDefault) {
+    // gauges keep one atomic unless asked: set() is a store, concurrent
+    // set()s leave one of the written values, inc()/dec() still work
+    MetricsRegistry reg;
+    Gauge* g = reg.add_gauge("depth", "Queue depth");
+    EXPECT_FALSE(g->sharded());
+    EXPECT_TRUE(reg.add_gauge("inflight", "In flight", /*sharded=*/true)->sharded());
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i <= 4; ++i)
+        threads.emplace_back([g, i]{ for (int j = 0; j < 10000; ++j) g->set(i); });
+    for (auto& t : threads) t.join();
+    EXPECT_GE(g->get(), 1);
+    EXPECT_LE(g->get(), 4);
+
+    g->set(5);
+    g->inc(); g->inc(); g->dec();
+    EXPECT_EQ(g->get(), 6);
+    EXPECT_NE(reg.serialize().find("depth 6\n"), std::string::npos);
+}
+
 TEST(GaugeTest, SerializeFormat) {
     Gauge g("queue_depth_current", "Queue depth");
     g.set(7);
@@ -132,6 +176,46 @@ TEST(HistogramTest, SerializeContainsBuckets) {
     EXPECT_NE(s.find("+Inf"), std::string::npos);
 }
 
+TEST(HistogramTest, BucketSearchMatchesLinearScan) {
+    Histogram h("h", "h", {0.001, 0.002, 0.005, 0.01, 0.1, 1.0, 2.5});
+    const std::vector<double> bounds = {0.001, 0.002, 0.005, 0.01, 0.1, 1.0, 2.5};
+    std::vector<double> probes = {0.0, -1.0, 1e9, std::numeric_limits<double>::quiet_NaN()};
+    for (double b : bounds) {   // exactly on, just below and just above every bound
+        probes.push_back(b);
+        probes.push_back(std::nextafter(b, 0.0));
+        probes.push_back(std::nextafter(b, 10.0));
+    }
+    for (double v : probes) {
+        size_t expect = bounds.size();   // +Inf
+        for (size_t i = 0; i < bounds.size(); ++i)
+            if (v <= bounds[i]) { expect = i; break; }
+        EXPECT_EQ(h.bucket_index(v), expect) << "v=" << v;
+    }
+    Histogram none("none", "no finite buckets", {});
+    EXPECT_EQ(none.bucket_index(3.0), 0u);
+}
+
+TEST(HistogramTest, ConcurrentObservesAreExactAndCumulative) {
+    Histogram h("lat", "Latency", {0.25, 0.5, 1.0});
+    constexpr int THREADS = 8, PER_THREAD = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.emplace_back([&h]{
+            // one observation per bucket, in quarters so the sum is exact
+            for (int i = 0; i < PER_THREAD; ++i)
+                for (double v : {0.25, 0.5, 0.75, 2.0}) h.observe(v);
+        });
+    for (auto& t : threads) t.join();
+
+    const uint64_t n = uint64_t(THREADS) * PER_THREAD;
+    EXPECT_EQ(h.cumulative_counts(), (std::vector<uint64_t>{n, 2 * n, 3 * n, 4 * n}));
+    EXPECT_EQ(h.count(), 4 * n);
+    EXPECT_DOUBLE_EQ(h.sum(), 3.5 * n);
+    std::string s = h.serialize();
+    EXPECT_NE(s.find("lat_bucket{le=\"0.5\"} " + std::to_string(2 * n)), std::string::npos);
+    EXPECT_NE(s.find("lat_count " + std::to_string(4 * n)), std::string::npos);
+}
+
 TEST(HistogramTest, ObserveSince) {
     Histogram h("latency", "Latency");
     auto start = std::chrono::steady_clock::now();
@@ -142,6 +226,251 @@ TEST(HistogramTest, ObserveSince) {
     EXPECT_NE(s.find("latency_count 1"), std::string::npos);
 }
 
+// ─────────────────────────────────────────────────────────────
+// HdrHistogram Tests
+// ─────────────────────────────────────────────────────────────
+TEST(HdrHistogramTest, QuantilesWithinRelativeErrorFromNanosToMinutes) {
+    HdrHistogram h("lat", "Latency");   // 2 significant digits
+    std::vector<uint64_t> values;
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 200000; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        double u = static_cast<double>(x >> 11) / 9007199254740992.0;
+        values.push_back(static_cast<uint64_t>(std::pow(10.0, 11.8 * u)));  // 1 ns .. ~10 min
+    }
+    for (uint64_t v : values) h.record_ns(v);
+    std::sort(values.begin(), values.end());
+
+    HdrHistogram::Snapshot s = h.snapshot();
+    ASSERT_EQ(s.count(), values.size());
+    EXPECT_LT(h.relative_error(), 0.01);
+    for (double q : {0.0001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999, 0.9999}) {
+        size_t rank = static_cast<size_t>(std::ceil(q * values.size()));
+        double exact = values[rank - 1] * 1e-9;
+        double est = s.quantile(q);
+        EXPECT_GE(est, exact * (1 - 1e-12)) << "q=" << q;
+        EXPECT_LE(est, exact * (1 + h.relative_error()) + 1e-9) << "q=" << q;
+    }
+    EXPECT_DOUBLE_EQ(s.quantile(1.0), values.back() * 1e-9);
+    EXPECT_DOUBLE_EQ(s.min(), values.front() * 1e-9);
+}
+
+TEST(HdrHistogramTest, SnapshotsMergeLikeOneHistogram) {
+    HdrHistogram a("a", "a", 2, 1.0), b("b", "b", 2, 600.0), both("c", "c");
+    for (int i = 1; i <= 1000; ++i) {
+        double v = i * 1e-4;   // 0.1 ms .. 100 ms
+        (i % 3 ? a : b).observe(v);
+        both.observe(v);
+    }
+    b.observe(120.0);
+    both.observe(120.0);
+
+    HdrHistogram::Snapshot merged = a.snapshot();
+    merged.merge(b.snapshot());
+    HdrHistogram::Snapshot whole = both.snapshot();
+    EXPECT_EQ(merged.count(), whole.count());
+    EXPECT_DOUBLE_EQ(merged.sum(), whole.sum());
+    EXPECT_DOUBLE_EQ(merged.min(), whole.min());
+    EXPECT_DOUBLE_EQ(merged.max(), 120.0);
+    for (double q : {0.5, 0.9, 0.99, 0.999, 1.0})
+        EXPECT_DOUBLE_EQ(merged.quantile(q), whole.quantile(q)) << "q=" << q;
+
+    HdrHistogram coarse("d", "d", 1);
+    EXPECT_THROW(merged.merge(coarse.snapshot()), std::invalid_argument);
+    EXPECT_THROW(HdrHistogram("e", "e", 0), std::invalid_argument);
+}
+
+TEST(HdrHistogramTest, SerializesBucketsAndSummary) {
+    MetricsRegistry reg;
+    auto* h = reg.add_hdr_histogram("rpc_seconds", "RPC latency");
+    for (int i = 0; i < 90; ++i) h->observe(50e-6);   // 50 µs
+    for (int i = 0; i < 10; ++i) h->observe(0.2);     // 200 ms
+
+    std::string s = reg.serialize();
+    EXPECT_NE(s.find("# TYPE rpc_seconds histogram"), std::string::npos);
+    EXPECT_NE(s.find("rpc_seconds_bucket{le=\"2.5e-05\"} 0\n"), std::string::npos);
+    EXPECT_NE(s.find("rpc_seconds_bucket{le=\"5e-05\"} 90\n"), std::string::npos);
+    EXPECT_NE(s.find("rpc_seconds_bucket{le=\"+Inf\"} 100\n"), std::string::npos);
+    EXPECT_NE(s.find("rpc_seconds_count 100"), std::string::npos);
+    EXPECT_NE(s.find("# TYPE rpc_seconds_summary summary"), std::string::npos);
+    EXPECT_NE(s.find("rpc_seconds_summary{quantile=\"0.5\"} "), std::string::npos);
+    EXPECT_NEAR(h->quantile(0.5), 50e-6, 50e-6 * h->relative_error());
+    EXPECT_NE(s.find("rpc_seconds_summary{quantile=\"0.99\"} 0.2\n"), std::string::npos);
+}
+
+// ─────────────────────────────────────────────────────────────
+// Summary / DDSketch Tests
+// ─────────────────────────────────────────────────────────────
+TEST(SummaryTest, QuantilesWithinRelativeAccuracyOfExact) {
+    Summary s("rpc", "RPC latency");   // α = 1%
+    constexpr int THREADS = 4, PER_THREAD = 50000;
+    std::vector<std::vector<double>> per(THREADS);
+    for (int t = 0; t < THREADS; ++t) {
+        uint64_t x = 0x9E3779B97F4A7C15ull * (t + 1);
+        for (int i = 0; i < PER_THREAD; ++i) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            double u = static_cast<double>(x >> 11) / 9007199254740992.0;
+            per[t].push_back(std::pow(10.0, -9.0 + 13.0 * u));   // 1 ns .. ~3 h
+        }
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.emplace_back([&s, &per, t]{ for (double v : per[t]) s.observe(v); });
+    for (auto& th : threads) th.join();
+
+    std::vector<double> all;
+    for (auto& v : per) all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+
+    DDSketch sk = s.window(0);
+    ASSERT_EQ(sk.count(), all.size());
+    EXPECT_EQ(s.count(), all.size());
+    for (double q : {0.001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999, 0.9999, 1.0}) {
+        double exact = all[static_cast<size_t>(std::ceil(q * all.size())) - 1];
+        EXPECT_NEAR(sk.quantile(q), exact, exact * 0.01 * (1 + 1e-9)) << "q=" << q;
+    }
+}
+
+TEST(SummaryTest, SketchesMergeAndStayBounded) {
+    DDSketch a, b, both, small(0.01, 64);
+    for (int i = 1; i <= 20000; ++i) {
+        double v = i * 1e-6;
+        (i % 2 ? a : b).add(v);
+        both.add(v);
+        small.add(v);
+    }
+    a.merge(b);
+    EXPECT_EQ(a.count(), both.count());
+    for (double q : {0.01, 0.5, 0.99})
+        EXPECT_DOUBLE_EQ(a.quantile(q), both.quantile(q));
+
+    // 64 bins cannot cover 1 µs..20 ms at 1%: the low keys are folded,
+    // the tail is still within α.
+    EXPECT_LE(small.bins(), 64u);
+    EXPECT_NEAR(small.quantile(0.99), 0.0198, 0.0198 * 0.01);
+    EXPECT_NEAR(small.quantile(0.999), 0.01998, 0.01998 * 0.01);
+    EXPECT_THROW(a.merge(DDSketch(0.02)), std::invalid_argument);
+}
+
+TEST(SummaryTest, OldObservationsAgeOutOfTheWindow) {
+    Summary s("job", "Job latency", {0.5}, {std::chrono::milliseconds(120)});
+    for (int i = 0; i < 100; ++i) s.observe(0.5);
+    EXPECT_EQ(s.window().count(), 100u);
+    EXPECT_NEAR(s.quantile(0.5), 0.5, 0.005);
+
+    std::this_thread::sleep_for(250ms);   // > window + one slice
+    for (int i = 0; i < 10; ++i) s.observe(2.0);
+    EXPECT_EQ(s.window().count(), 10u);
+    EXPECT_NEAR(s.quantile(0.5), 2.0, 0.02);
+    EXPECT_EQ(s.count(), 110u);           // _count is cumulative
+}
+
+TEST(SummaryTest, ScrapesRacingObserversLoseNothing) {
+    // collect() swaps each shard's sketches out while writers keep
+    // folding full buffers in; every value must land exactly once
+    Summary s("rpc", "RPC latency");
+    constexpr int THREADS = 4, PER_THREAD = 100000;
+    std::atomic<bool> done{false};
+    std::thread scraper([&]{
+        while (!done.load()) { (void)s.serialize(); std::this_thread::yield(); }
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.emplace_back([&s, t]{
+            for (int i = 0; i < PER_THREAD; ++i) s.observe((t + 1) * 1e-3);
+        });
+    for (auto& th : threads) th.join();
+    done = true;
+    scraper.join();
+
+    const uint64_t total = uint64_t(THREADS) * PER_THREAD;
+    EXPECT_EQ(s.count(), total);
+    EXPECT_NEAR(s.sum(), PER_THREAD * (1 + 2 + 3 + 4) * 1e-3, 1e-6);
+    DDSketch sk = s.window(0);
+    EXPECT_EQ(sk.count(), total);
+    EXPECT_NEAR(sk.quantile(1.0), 4e-3, 4e-3 * 0.01);
+}
+
+TEST(SummaryTest, SerializesPrometheusSummaryPerWindow) {
+    MetricsRegistry reg;
+    auto* s = reg.add_summary("req_seconds", "Request latency");
+    for (int i = 0; i < 100; ++i) s->observe(0.25);
+
+    std::string out = reg.serialize();
+    EXPECT_NE(out.find("# TYPE req_seconds summary"), std::string::npos);
+    EXPECT_NE(out.find("req_seconds{window=\"1m\",quantile=\"0.99\"} "), std::string::npos);
+    EXPECT_NE(out.find("req_seconds{window=\"5m\",quantile=\"0.5\"} "), std::string::npos);
+    EXPECT_NE(out.find("req_seconds_sum 25\n"), std::string::npos);
+    EXPECT_NE(out.find("req_seconds_count 100\n"), std::string::npos);
+}
+
+// ─────────────────────────────────────────────────────────────
+// Labeled family Tests
+// ─────────────────────────────────────────────────────────────
+TEST(FamilyTest, WithLabelsReturnsTheSameChild) {
+    MetricsRegistry reg;
+    auto* req = reg.add_counter_family("http_requests_total", "Requests", {"handler", "code"});
+    Counter* ok = req->with_labels("get_user", "200");
+    EXPECT_EQ(req->with_labels("get_user", "200"), ok);
+    EXPECT_EQ(req->with_labels(std::vector<std::string>{"get_user", "200"}), ok);
+    EXPECT_NE(req->with_labels("get_user", "500"), ok);
+    EXPECT_NE(req->with_labels("get_use", "r200"), ok);
+    ok->inc(3);
+    req->with_labels("say \"hi\"\\", "200")->inc();
+
+    std::string s = reg.serialize();
+    EXPECT_NE(s.find("# TYPE http_requests_total counter"), std::string::npos);
+    EXPECT_NE(s.find("http_requests_total{handler=\"get_user\",code=\"200\"} 3\n"), std::string::npos);
+    EXPECT_NE(s.find("http_requests_total{handler=\"get_user\",code=\"500\"} 0\n"), std::string::npos);
+    EXPECT_NE(s.find("{handler=\"say \\\"hi\\\"\\\\\",code=\"200\"} 1\n"), std::string::npos);
+    EXPECT_EQ(req->size(), 4u);
+
+    EXPECT_THROW(req->with_labels("only_one"), std::invalid_argument);
+    EXPECT_THROW(reg.add_gauge_family("g", "g", {"bad-name"}), std::invalid_argument);
+    EXPECT_THROW(reg.add_histogram_family("h", "h", {"le"}), std::invalid_argument);
+}
+
+TEST(FamilyTest, HistogramChildrenCarryLabelsAndLe) {
+    MetricsRegistry reg;
+    auto* lat = reg.add_histogram_family("rpc_seconds", "RPC latency", {"priority"}, {0.01, 0.1});
+    lat->with_labels("high")->observe(0.005);
+    lat->with_labels("low")->observe(0.05);
+
+    std::string s = reg.serialize();
+    EXPECT_NE(s.find("rpc_seconds_bucket{priority=\"high\",le=\"0.01\"} 1\n"), std::string::npos);
+    EXPECT_NE(s.find("rpc_seconds_bucket{priority=\"low\",le=\"0.01\"} 0\n"), std::string::npos);
+    EXPECT_NE(s.find("rpc_seconds_bucket{priority=\"low\",le=\"+Inf\"} 1\n"), std::string::npos);
+    EXPECT_NE(s.find("rpc_seconds_count{priority=\"high\"} 1\n"), std::string::npos);
+    EXPECT_EQ(s.find("# TYPE rpc_seconds histogram"), s.rfind("# TYPE rpc_seconds histogram"));
+}
+
+TEST(FamilyTest, CardinalityLimitRoutesToOverflowChild) {
+    CounterFamily f("jobs_total", "Jobs", {"tenant"}, 3);
+    for (int i = 0; i < 10; ++i) f.with_labels("t" + std::to_string(i))->inc();
+    EXPECT_EQ(f.size(), 3u);
+    EXPECT_EQ(f.overflowed(), 7u);
+    EXPECT_EQ(f.with_labels("t1")->get(), 1u);   // existing children still resolve
+
+    std::string s = f.serialize();
+    EXPECT_NE(s.find("jobs_total{tenant=\"__overflow__\"} 7\n"), std::string::npos);
+}
+
+TEST(FamilyTest, ConcurrentFirstLookupsCreateOneChild) {
+    GaugeFamily f("inflight", "In flight", {"worker"});
+    constexpr int THREADS = 8, KEYS = 50, ROUNDS = 200;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.emplace_back([&f]{
+            for (int r = 0; r < ROUNDS; ++r)
+                for (int k = 0; k < KEYS; ++k) f.with_labels(std::to_string(k))->inc();
+        });
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(f.size(), static_cast<size_t>(KEYS));
+    for (int k = 0; k < KEYS; ++k)
+        EXPECT_EQ(f.with_labels(std::to_string(k))->get(), THREADS * ROUNDS);
+}
+
 // ─────────────────────────────────────────────────────────────
 // MetricsRegistry Tests
 // ─────────────────────────────────────────────────────────────
@@ -161,6 +490,82 @@ TEST(RegistryTest, SerializeContainsAllMetrics) {
     EXPECT_NE(s.find("latency_seconds_count 1"), std::string::npos);
 }
 
+TEST(RegistryTest, BufferFormatsNumbersLikeOstream) {
+    for (double v : {0.0, 1.0, -2.5, 0.0001, 1e-6, 2.5e-05, 123456.0, 1234567.0, 0.1 + 0.2, 3.14159265}) {
+        std::ostringstream ss;
+        ss << v;
+        MetricsBuffer b;
+        b << v;
+        EXPECT_EQ(b.str(), ss.str());
+    }
+    MetricsBuffer b;
+    b << uint64_t{18446744073709551615ull} << ' ' << int64_t{-42} << ' '
+      << std::numeric_limits<double>::infinity() << ' ' << std::nan("");
+    EXPECT_EQ(b.str(), "18446744073709551615 -42 +Inf NaN");
+}
+
+TEST(RegistryTest, ReusedBufferMatchesSerializeWithoutGrowing) {
+    MetricsRegistry reg;
+    reg.add_counter("c_total", "C")->inc(7);
+    reg.add_histogram("h_seconds", "H")->observe(0.02);
+    reg.add_counter_family("f_total", "F", {"k"})->with_labels("a")->inc();
+
+    MetricsBuffer buf;
+    reg.write(buf);
+    EXPECT_EQ(buf.str(), reg.serialize());
+    const size_t cap = buf.capacity();
+    for (int i = 0; i < 10; ++i) { buf.clear(); reg.write(buf); }
+    EXPECT_EQ(buf.capacity(), cap);
+    EXPECT_EQ(buf.str(), reg.serialize());
+}
+
+TEST(RegistryTest, ScrapesSeeWholeMetricsWhileRegistering) {
+    MetricsRegistry reg;
+    constexpr int N = 3000;
+    std::atomic<bool> done{false};
+    std::thread writer([&]{
+        for (int i = 0; i < N; ++i) reg.add_counter("c" + std::to_string(i), "C")->inc(1);
+        done.store(true);
+    });
+    MetricsBuffer buf;
+    size_t last = 0;
+    while (!done.load()) {
+        buf.clear();
+        reg.write(buf);
+        std::string_view s = buf.view();
+        size_t helps = 0, types = 0;
+        for (size_t p = 0; (p = s.find("# HELP ", p)) != s.npos; ++p) ++helps;
+        for (size_t p = 0; (p = s.find("# TYPE ", p)) != s.npos; ++p) ++types;
+        EXPECT_EQ(helps, types);
+        EXPECT_GE(helps, last);   // the page only ever grows
+        last = helps;
+    }
+    writer.join();
+    buf.clear();
+    reg.write(buf);
+    EXPECT_NE(buf.view().find("c2999 1\n"), std::string_view::npos);
+}
+
+TEST(RegistryTest, SampledMetricsAreReadAtScrapeTime) {
+    MetricsRegistry reg;
+    auto work = std::make_shared<std::vector<double>>(std::vector<double>{1.5, 0});
+    reg.add_sampled_family("work_seconds_total", "Work", Counter::TYPE, "worker", {"0", "1"},
+                           [work](size_t i) { return (*work)[i]; });
+    reg.add_sampled("ratio", "Ratio", Gauge::TYPE, [] { return 0.25; });
+
+    std::string page = reg.serialize();
+    EXPECT_NE(page.find("# TYPE work_seconds_total counter\n"
+                        "work_seconds_total{worker=\"0\"} 1.5\n"
+                        "work_seconds_total{worker=\"1\"} 0\n"), std::string::npos);
+    EXPECT_NE(page.find("# TYPE ratio gauge\nratio 0.25\n"), std::string::npos);
+
+    (*work)[1] = 86400.123456789;   // exact(): not flattened to 6 digits
+    EXPECT_NE(reg.serialize().find("work_seconds_total{worker=\"1\"} 86400.123456789\n"),
+              std::string::npos);
+    EXPECT_THROW(reg.add_sampled("h", "H", "histogram", [] { return 0.0; }),
+                 std::invalid_argument);
+}
+
 // ─────────────────────────────────────────────────────────────
 // ThreadPoolV3 Tests
 // ─────────────────────────────────────────────────────────────
@@ -232,7 +637,167 @@ TEST_F(PoolFixture, MetricsSerializeToPrometheusFormat) {
     EXPECT_NE(metrics.find("_count 3"), std::string::npos);
 }
 
+TEST_F(PoolFixture, TaskLatencyHasQuantiles) {
+    for (int i = 0; i < 50; ++i)
+        pool->enqueue([]{ return 0; });
+    pool->wait_all();
+
+    HdrHistogram::Snapshot lat = pool->task_latency();
+    EXPECT_EQ(lat.count(), 50u);
+    EXPECT_GT(lat.quantile(0.5), 0.0);
+    EXPECT_LE(lat.quantile(0.5), lat.quantile(0.99));
+    EXPECT_NE(registry.serialize().find("threadpool_task_latency_seconds_summary{quantile=\"0.99\"}"),
+              std::string::npos);
+}
+
 TEST_F(PoolFixture, ThreadCountGaugeIsCorrect) {
     std::string metrics = registry.serialize();
     EXPECT_NE(metrics.find("threadpool_thread_count 4"), std::string::npos);
 }
+
+TEST_F(PoolFixture, AffineTasksAreCountedAsHitsOrSteals) {
+    for (int i = 0; i < 200; ++i)
+        pool->enqueue_affine(i % 8, []{ return 0; });
+    pool->wait_all();
+
+    EXPECT_EQ(pool->tasks_completed(), 200u);
+    EXPECT_EQ(pool->affinity_hits() + pool->affinity_steals(), 200u);
+    EXPECT_GT(pool->affinity_hits(), 0u);
+
+    std::string metrics = registry.serialize();
+    EXPECT_NE(metrics.find("threadpool_affinity_hits_total"),   std::string::npos);
+    EXPECT_NE(metrics.find("threadpool_affinity_steals_total"), std::string::npos);
+}
+
+TEST_F(PoolFixture, SameKeyMapsToSameHomeWorker) {
+    EXPECT_EQ(pool->home_worker(std::string("tenant-a")),
+              pool->home_worker(std::string("tenant-a")));
+    EXPECT_LT(pool->home_worker(12345), pool->thread_count());
+}
+
+TEST(PoolLatencySplit, QueueWaitAndExecutionAddUpToLatency) {
+    MetricsRegistry registry;
+    ThreadPoolV3<256> pool(1, &registry);
+    for (int i = 0; i < 4; ++i)
+        pool.enqueue([] { std::this_thread::sleep_for(5ms); });
+    pool.wait_all();
+
+    HdrHistogram::Snapshot wait = pool.queue_wait(), exec = pool.execution_time(),
+                           total = pool.task_latency();
+    EXPECT_EQ(wait.count(), 4u);
+    EXPECT_EQ(exec.count(), 4u);
+    EXPECT_GE(exec.min(), 0.005 * 0.99);
+    EXPECT_GE(wait.max(), 0.015 * 0.99);      // the 4th task queued behind three
+    EXPECT_NEAR(wait.sum() + exec.sum(), total.sum(), 1e-6);
+    EXPECT_EQ(pool.cpu_time().count(), 0u);   // opt-in only
+
+    std::string metrics = registry.serialize();
+    EXPECT_NE(metrics.find("threadpool_task_queue_wait_seconds_count 4"), std::string::npos);
+    EXPECT_NE(metrics.find("threadpool_task_execution_seconds_count 4"), std::string::npos);
+    EXPECT_EQ(metrics.find("threadpool_task_cpu_seconds"), std::string::npos);
+}
+
+TEST(PoolLatencySplit, CpuTimeSeparatesBlockingFromComputing) {
+    MetricsRegistry registry;
+    ThreadPoolV3<256, metrics_policy::WithCpuTime<metrics_policy::Full>> pool(1, &registry);
+    pool.enqueue([] { std::this_thread::sleep_for(20ms); }).get();
+    pool.wait_all();
+
+    EXPECT_EQ(pool.cpu_time().count(), 1u);
+    EXPECT_GE(pool.execution_time().max(), 0.020 * 0.99);
+    EXPECT_LT(pool.cpu_time().max(), 0.010);   // asleep, not on CPU
+    EXPECT_NE(registry.serialize().find("threadpool_task_cpu_seconds_count 1"), std::string::npos);
+}
+
+TEST(PoolUtilization, PerWorkerCountersOutliveThePool) {
+    MetricsRegistry registry;
+    {
+        ThreadPoolV3<256> pool(2, &registry);
+        for (int i = 0; i < 40; ++i) pool.enqueue([] { return 0; });
+        pool.enqueue([] { std::this_thread::sleep_for(20ms); });
+        pool.wait_all();
+
+        uint64_t tasks = 0, busy = 0;
+        for (size_t w = 0; w < 2; ++w) {
+            tasks += pool.worker_stats(w).tasks;
+            busy  += pool.worker_stats(w).busy_ns;
+        }
+        EXPECT_EQ(tasks, 41u);
+        EXPECT_GE(busy, 20'000'000u);
+        EXPECT_GT(pool.utilization(), 0.0);
+        EXPECT_LE(pool.utilization(), 1.0);
+
+        std::string metrics = registry.serialize();
+        for (const char* name : {"threadpool_worker_busy_seconds_total{worker=\"1\"}",
+                                 "threadpool_worker_idle_seconds_total{worker=\"0\"}",
+                                 "threadpool_worker_spin_seconds_total{worker=\"0\"}",
+                                 "threadpool_worker_park_seconds_total{worker=\"0\"}",
+                                 "threadpool_worker_tasks_total{worker=\"0\"}",
+                                 "threadpool_worker_dequeue_retries_total{worker=\"1\"}",
+                                 "# TYPE threadpool_utilization_ratio gauge"})
+            EXPECT_NE(metrics.find(name), std::string::npos) << name;
+    }
+    // The registry still scrapes the final totals once the pool is gone.
+    std::string a = registry.serialize();
+    std::this_thread::sleep_for(5ms);
+    EXPECT_EQ(registry.serialize(), a);
+}
+
+TEST(PoolMetricsPolicy, CountersOnlyRegistersNoGaugesOrLatency) {
+    MetricsRegistry registry;
+    ThreadPoolV3<256, metrics_policy::CountersOnly> pool(2, &registry);
+    for (int i = 0; i < 20; ++i) pool.enqueue([] { return 0; });
+    pool.enqueue([]() -> int { throw std::runtime_error("x"); });
+    pool.wait_all();
+
+    EXPECT_EQ(pool.tasks_submitted(), 21u);
+    EXPECT_EQ(pool.tasks_completed(), 20u);
+    EXPECT_EQ(pool.tasks_failed(), 1u);
+    EXPECT_EQ(pool.task_latency().count(), 0u);
+    std::string metrics = registry.serialize();
+    EXPECT_NE(metrics.find("threadpool_tasks_completed_total 20"), std::string::npos);
+    EXPECT_EQ(metrics.find("threadpool_queue_depth_current"), std::string::npos);
+    EXPECT_EQ(metrics.find("threadpool_task_latency_seconds"), std::string::npos);
+}
+
+TEST(PoolMetricsPolicy, NoneRunsTasksAndRegistersNothing) {
+    MetricsRegistry registry;
+    ThreadPoolV3<256, metrics_policy::None> pool(2, &registry);
+    std::vector<std::future<int>> fs;
+    for (int i = 0; i < 50; ++i) fs.push_back(pool.enqueue([i] { return i; }));
+    pool.wait_all();
+    for (int i = 0; i < 50; ++i) EXPECT_EQ(fs[i].get(), i);
+
+    EXPECT_EQ(pool.tasks_submitted(), 0u);
+    EXPECT_EQ(registry.serialize(), "");
+    ThreadPoolV3<256, metrics_policy::None> no_registry(1);
+    EXPECT_EQ(no_registry.enqueue([] { return 7; }).get(), 7);
+}
+
+TEST(PoolMetricsPolicy, SampledTimesOneTaskInN) {
+    MetricsRegistry registry;
+    ThreadPoolV3<256, metrics_policy::Sampled<8>> pool(2, &registry);
+    for (int i = 0; i < 64; ++i) pool.enqueue([] { return 0; });
+    pool.wait_all();
+
+    EXPECT_EQ(pool.tasks_completed(), 64u);           // counters stay exact
+    EXPECT_EQ(pool.task_latency().count(), 8u);       // one submitting thread: 64 / 8
+    EXPECT_NE(registry.serialize().find("threadpool_active_workers_current 0"), std::string::npos);
+}
+
+TEST(PoolWaitStrategy, BlockingPoolReportsParksToRegistry) {
+    MetricsRegistry registry;
+    PoolOptions opts;
+    opts.wait_strategy = WaitStrategy::Blocking;
+    ThreadPoolV3<256> pool(2, &registry, opts);
+
+    pool.enqueue([] { return 1; }).get();
+    std::this_thread::sleep_for(20ms);            // let both workers park
+    EXPECT_EQ(pool.enqueue([] { return 2; }).get(), 2);  // and wake one
+    pool.wait_all();
+
+    std::string metrics = registry.serialize();
+    EXPECT_NE(metrics.find("threadpool_worker_spins_total"), std::string::npos);
+    EXPECT_NE(metrics.find("threadpool_worker_parks_total"), std::string::npos);
+    EXPECT_EQ(metrics.find("threadpool_worker_parks_total 0\n"), std::string::npos);
+}
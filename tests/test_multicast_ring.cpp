@@ -0,0 +1,103 @@
+/**
+ * test_multicast_ring.cpp — MulticastRing fan-out, dependencies, gating
+ */
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "multicast_ring.h"
+
+struct Event {
+    int64_t value = 0;
+    int64_t a = 0, b = 0;   // written by upstream consumers
+};
+
+TEST(MulticastRing, EveryConsumerSeesEveryEventInOrder) {
+    MulticastRing<Event, 64> ring;
+    auto& c1 = ring.add_consumer();
+    auto& c2 = ring.add_consumer();
+
+    const int64_t N = 10000;
+    std::vector<int64_t> seen1, seen2;
+    std::thread t1([&] { c1.drain_until(N - 1, [&](Event& e, int64_t, bool) { seen1.push_back(e.value); }); });
+    std::thread t2([&] { c2.drain_until(N - 1, [&](Event& e, int64_t, bool) { seen2.push_back(e.value); }); });
+
+    for (int64_t i = 0; i < N; ++i)
+        ring.publish_event([i](Event& e) { e.value = i; });
+    t1.join();
+    t2.join();
+
+    ASSERT_EQ(seen1.size(), static_cast<size_t>(N));
+    ASSERT_EQ(seen2.size(), static_cast<size_t>(N));
+    for (int64_t i = 0; i < N; ++i) {
+        EXPECT_EQ(seen1[i], i);
+        EXPECT_EQ(seen2[i], i);
+    }
+}
+
+TEST(MulticastRing, DiamondDependencySeesUpstreamResults) {
+    MulticastRing<Event, 128> ring;
+    auto& c1 = ring.add_consumer();
+    auto& c2 = ring.add_consumer();
+    auto& c3 = ring.add_consumer({&c1, &c2});
+
+    const int64_t N = 20000;
+    std::atomic<int64_t> bad{0}, sum{0};
+    std::thread t1([&] { c1.drain_until(N - 1, [](Event& e, int64_t, bool) { e.a = e.value * 2; }); });
+    std::thread t2([&] { c2.drain_until(N - 1, [](Event& e, int64_t, bool) { e.b = e.value * 3; }); });
+    std::thread t3([&] {
+        c3.drain_until(N - 1, [&](Event& e, int64_t, bool) {
+            if (e.a != e.value * 2 || e.b != e.value * 3) ++bad;
+            sum += e.value;
+        });
+    });
+
+    // Two producers claiming in batches of 8.
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; ++p)
+        producers.emplace_back([&] {
+            for (int64_t k = 0; k < N / 2; k += 8) {
+                int64_t first = ring.claim(8);
+                for (int64_t s = first; s < first + 8; ++s) ring[s].value = s;
+                ring.publish(first, 8);
+            }
+        });
+    for (auto& t : producers) t.join();
+    t1.join(); t2.join(); t3.join();
+
+    EXPECT_EQ(bad, 0);
+    EXPECT_EQ(sum, N * (N - 1) / 2);
+    EXPECT_EQ(ring.gating_sequence(), N - 1);
+}
+
+TEST(MulticastRing, SlowestConsumerGatesProducers) {
+    MulticastRing<Event, 8> ring;
+    auto& fast = ring.add_consumer();
+    auto& slow = ring.add_consumer();
+
+    for (int i = 0; i < 8; ++i) ASSERT_GE(ring.try_claim(), 0);
+    ring.publish(0, 8);
+    EXPECT_EQ(ring.try_claim(), -1) << "ring is full";
+
+    EXPECT_EQ(fast.poll([](Event&, int64_t, bool) {}), 8u);
+    EXPECT_EQ(ring.try_claim(), -1) << "the slow consumer still holds every slot";
+
+    size_t batches = 0;
+    EXPECT_EQ(slow.poll([&](Event&, int64_t, bool end) { batches += end; }), 8u);
+    EXPECT_EQ(batches, 1u) << "one poll, one batch";
+    EXPECT_EQ(ring.try_claim(4), 8);
+}
+
+TEST(MulticastRing, ConsumersMustBeAddedBeforeFirstClaim) {
+    MulticastRing<Event, 8> ring;
+    EXPECT_THROW(ring.claim(), std::logic_error);
+    ring.add_consumer();
+    EXPECT_THROW(ring.claim(9), std::invalid_argument);
+    ring.claim();
+    EXPECT_THROW(ring.add_consumer(), std::logic_error);
+
+    MulticastRing<Event, 8> other;
+    auto& foreign = other.add_consumer();
+    MulticastRing<Event, 8> third;
+    EXPECT_THROW(third.add_consumer({&foreign}), std::invalid_argument);
+}
@@ -0,0 +1,100 @@
+/**
+ * test_object_pool.cpp — ObjectPool reuse, cross-thread release, metrics
+ */
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+#include "object_pool.h"
+#include "lockfree_queue.h"
+
+TEST(ObjectPool, ReleasedObjectIsReusedWithItsState) {
+    ObjectPool<std::vector<char>, 4> pool;
+    const char* data = nullptr;
+    {
+        auto h = pool.acquire();
+        h->reserve(4096);
+        data = h->data();
+    }
+    auto h = pool.acquire();
+    EXPECT_EQ(h->data(), data) << "same object, capacity kept";
+    EXPECT_GE(h->capacity(), 4096u);
+    h.reset();
+    pool.flush_stats();
+    EXPECT_EQ(pool.misses(), 1u);
+    EXPECT_EQ(pool.hits(), 1u);
+    EXPECT_EQ(pool.objects(), 1u);
+}
+
+TEST(ObjectPool, SpillsAndRefillsThroughTheDepot) {
+    ObjectPool<int, 4> pool;
+    std::vector<ObjectPool<int, 4>::Handle> held;
+    for (int i = 0; i < 20; ++i) held.push_back(pool.acquire());
+    std::set<int*> distinct;
+    for (auto& h : held) distinct.insert(h.get());
+    EXPECT_EQ(distinct.size(), 20u);
+
+    held.clear();                      // magazine overflows into the depot
+    for (int i = 0; i < 20; ++i) held.push_back(pool.acquire());
+    pool.flush_stats();
+    EXPECT_EQ(pool.objects(), 20u) << "second round must be all hits";
+    EXPECT_EQ(pool.misses(), 20u);
+    EXPECT_EQ(pool.hits(), 20u);
+}
+
+TEST(ObjectPool, CrossThreadReleaseStress) {
+    // Producers acquire, consumers release: objects migrate between
+    // threads' magazines through the depot. Every object must be owned
+    // by at most one handle at a time.
+    using Pool = ObjectPool<std::atomic<int>, 8>;
+    Pool pool;
+    LockFreeQueue<Pool::Handle*, 1024> q;
+    std::atomic<int> violations{0};
+    std::atomic<bool> done{false};
+    const int PER_PRODUCER = 20000;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 2; ++p)
+        threads.emplace_back([&] {
+            for (int i = 0; i < PER_PRODUCER; ++i) {
+                auto* h = new Pool::Handle(pool.acquire());
+                if ((*h)->exchange(1) != 0) ++violations;
+                while (!q.try_enqueue(h)) std::this_thread::yield();
+            }
+        });
+    for (int c = 0; c < 2; ++c)
+        threads.emplace_back([&] {
+            while (true) {
+                if (auto h = q.try_dequeue()) {
+                    (**h)->store(0);
+                    delete *h;
+                } else if (done.load()) {
+                    break;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    threads[0].join();
+    threads[1].join();
+    done = true;
+    threads[2].join();
+    threads[3].join();
+
+    EXPECT_EQ(violations, 0);
+    EXPECT_LT(pool.objects(), static_cast<size_t>(2 * PER_PRODUCER));
+}
+
+TEST(ObjectPool, ExportsHitMissAndFootprint) {
+    MetricsRegistry registry;
+    ObjectPool<std::vector<char>, 2> pool(&registry, "bufs");
+    for (int i = 0; i < 10; ++i) pool.acquire();
+    pool.flush_stats();
+
+    std::string m = registry.serialize();
+    EXPECT_NE(m.find("bufs_hits_total 9"), std::string::npos);
+    EXPECT_NE(m.find("bufs_misses_total 1"), std::string::npos);
+    EXPECT_NE(m.find("bufs_objects 1"), std::string::npos);
+    EXPECT_NE(m.find("bufs_bytes"), std::string::npos);
+}
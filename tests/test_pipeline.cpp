@@ -0,0 +1,122 @@
+/**
+ * test_pipeline.cpp — Pipeline builder, ordering and backpressure tests
+ */
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include "pipeline.h"
+
+using namespace std::chrono_literals;
+
+TEST(PipelineTest, EveryItemPassesEveryStage) {
+    Pipeline<int> p(4);
+    std::atomic<long> sum{0};
+    p.add_parallel_stage("double", 4, [](int& v) { v *= 2; })
+     .add_parallel_stage("inc",    2, [](int& v) { v += 1; })
+     .add_serial_stage("sink",        [&](int& v) { sum += v; });
+
+    for (int i = 0; i < 1000; ++i) p.push(i);
+    p.wait();
+
+    // Σ (2i + 1) for i in [0, 1000)
+    EXPECT_EQ(sum.load(), 1000L * 999 + 1000);
+    for (size_t i = 0; i < p.stage_count(); ++i)
+        EXPECT_EQ(p.stage_stats(i).processed, 1000u) << p.stage_stats(i).name;
+    EXPECT_EQ(p.in_flight(), 0u);
+}
+
+TEST(PipelineTest, SerialStagePreservesPushOrder) {
+    Pipeline<int, 64> p(4);
+    std::vector<int> out;
+    p.add_parallel_stage("jitter", 4, [](int& v) {
+         if (v % 7 == 0) std::this_thread::sleep_for(100us);  // reorder on purpose
+     })
+     .add_serial_stage("collect", [&](int& v) { out.push_back(v); });
+
+    for (int i = 0; i < 500; ++i) p.push(i);
+    p.wait();
+
+    ASSERT_EQ(out.size(), 500u);
+    for (int i = 0; i < 500; ++i) EXPECT_EQ(out[i], i);
+}
+
+TEST(PipelineTest, ParallelDegreeIsRespected) {
+    Pipeline<int> p(4);
+    std::atomic<int> inside{0}, peak{0};
+    p.add_parallel_stage("limited", 2, [&](int&) {
+        int now = ++inside;
+        int prev = peak.load();
+        while (now > prev && !peak.compare_exchange_weak(prev, now)) {}
+        std::this_thread::sleep_for(200us);
+        --inside;
+    });
+
+    for (int i = 0; i < 100; ++i) p.push(i);
+    p.wait();
+    EXPECT_LE(peak.load(), 2);
+    EXPECT_EQ(p.stage_stats(0).processed, 100u);
+}
+
+TEST(PipelineTest, TokensBoundInFlightItems) {
+    Pipeline<int, 4> p(2);
+    std::atomic<bool> release{false};
+    p.add_serial_stage("gate", [&](int&) {
+        while (!release.load()) std::this_thread::yield();
+    });
+
+    int admitted = 0;
+    while (admitted < 100 && p.try_push(admitted)) ++admitted;
+    EXPECT_EQ(admitted, 4) << "Only MaxTokens items may be in flight";
+
+    release = true;
+    p.wait();
+    EXPECT_TRUE(p.try_push(0)) << "Retired tokens must be reusable";
+    p.wait();
+}
+
+TEST(PipelineTest, StageMetricsExported) {
+    MetricsRegistry registry;
+    Pipeline<int> p(2, &registry, "codec");
+    p.add_parallel_stage("decode", 2, [](int&) {})
+     .add_serial_stage("encode", [](int& v) { if (v == 3) throw std::runtime_error("bad"); });
+    for (int i = 0; i < 10; ++i) p.push(i);
+    p.wait();
+
+    std::string s = registry.serialize();
+    EXPECT_NE(s.find("codec_decode_tokens_total 10"), std::string::npos);
+    EXPECT_NE(s.find("codec_encode_tokens_total 10"), std::string::npos);
+    EXPECT_NE(s.find("codec_encode_errors_total 1"), std::string::npos);
+    EXPECT_NE(s.find("codec_tokens_in_flight 0"), std::string::npos);
+}
+
+TEST(PipelineTest, AddStageAfterPushThrows) {
+    Pipeline<int> p(1);
+    p.add_serial_stage("only", [](int&) {});
+    p.push(1);
+    EXPECT_THROW(p.add_serial_stage("late", [](int&) {}), std::logic_error);
+    p.wait();
+}
+
+TEST(PipelineTest, SmallPoolQueueNeverOverflows) {
+    // 16 tokens through a 32-slot pool queue: every hand-off and pump
+    // must fit, however the stages back up.
+    Pipeline<int, 16, 32> p(4);
+    std::atomic<long> sum{0};
+    p.add_parallel_stage("slow", 1, [](int& v) { if (v % 64 == 0) std::this_thread::sleep_for(50us); })
+     .add_parallel_stage("wide", 3, [](int& v) { v += 1; })
+     .add_serial_stage("ordered",   [](int&) {})
+     .add_parallel_stage("narrow", 1, [](int&) {})
+     .add_serial_stage("sink",      [&](int& v) { sum += v; });
+
+    for (int i = 0; i < 20000; ++i) p.push(i);
+    p.wait();
+    EXPECT_EQ(sum.load(), 20000L * 19999 / 2 + 20000);
+
+
+    // 16 tokens + 16 stages fill the 32 slots; a 17th stage is refused.
+    Pipeline<int, 16, 32> q(1);
+    for (int i = 0; i < 16; ++i) q.add_serial_stage("s" + std::to_string(i), [](int&) {});
+    EXPECT_THROW(q.add_serial_stage("one_too_many", [](int&) {}), std::logic_error);
+}
@@ -120,3 +120,31 @@ TEST(ProtocolTest, ClosedSocketReturnsFalse) {
 
     ::close(sv[0]);
 }
+
+TEST(ProtocolTest, PooledMessageReturnsBufferToPool) {
+    int sv[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+
+    proto::BufferPool pool;
+    {
+        proto::PooledMessage sent(proto::MessageType::REQUEST, 7, std::string(1000, 'x'), pool);
+        ASSERT_TRUE(proto::send_message(sv[0], sent, pool));
+        proto::PooledMessage received(pool);
+        ASSERT_TRUE(proto::recv_message(sv[1], received));
+        EXPECT_EQ(received.id, 7u);
+        EXPECT_EQ(received.payload.size(), 1000u);
+    }
+    // Round two is served entirely from recycled buffers.
+    size_t objects = pool.objects();
+    {
+        proto::PooledMessage sent(proto::MessageType::REQUEST, 8, std::string(1000, 'y'), pool);
+        ASSERT_TRUE(proto::send_message(sv[0], sent, pool));
+        proto::PooledMessage received(pool);
+        ASSERT_TRUE(proto::recv_message(sv[1], received));
+        EXPECT_EQ(received.payload_str(), std::string(1000, 'y'));
+    }
+    EXPECT_EQ(pool.objects(), objects);
+
+    ::close(sv[0]);
+    ::close(sv[1]);
+}
@@ -0,0 +1,229 @@
+/**
+ * test_reclaim.cpp — Epoch and Hazard reclamation: grace periods, stress
+ * with poisoned nodes, idle-time collection in pool workers, orphaned
+ * garbage of exited threads, bounded garbage behind a stalled reader
+ */
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "reclaim.h"
+#include "threadpool_v2.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr uint64_t LIVE = 0x11FE11FE11FE11FEull;
+constexpr uint64_t DEAD = 0xDEADDEADDEADDEADull;
+
+struct Node {
+    std::atomic<int>*     freed;
+    std::atomic<uint64_t> magic{LIVE};
+    uint64_t              value = 0;
+};
+
+void free_node(void* p) {
+    Node* n = static_cast<Node*>(p);
+    n->freed->fetch_add(1, std::memory_order_relaxed);
+    delete n;
+}
+
+// Deleter for the stress tests: poison the node and park it instead of
+// freeing it, so a premature "free" is a readable, checkable LIVE → DEAD
+// flip rather than undefined behaviour.
+struct Graveyard {
+    std::mutex         mtx;
+    std::vector<Node*> nodes;
+    ~Graveyard() { for (Node* n : nodes) delete n; }
+};
+Graveyard* graveyard = nullptr;
+
+void bury_node(void* p) {
+    Node* n = static_cast<Node*>(p);
+    n->magic.store(DEAD, std::memory_order_relaxed);
+    n->freed->fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lk(graveyard->mtx);
+    graveyard->nodes.push_back(n);
+}
+
+template<typename Pred>
+bool eventually(Pred pred, std::chrono::milliseconds limit = 2000ms) {
+    auto deadline = std::chrono::steady_clock::now() + limit;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(Epoch, RetiredNodeOutlivesOpenGuard) {
+    std::atomic<int> freed{0};
+    std::atomic<int> stage{0};
+    std::thread reader([&] {
+        Epoch::Guard g;
+        stage = 1;
+        while (stage.load() != 2) std::this_thread::yield();
+    });
+    while (stage.load() != 1) std::this_thread::yield();
+
+    Epoch::retire(new Node{&freed}, &free_node, sizeof(Node));
+    for (int i = 0; i < 10; ++i) Epoch::collect();
+    EXPECT_EQ(freed.load(), 0) << "freed while a guard from before the retire was open";
+    EXPECT_GE(Epoch::local_pending(), 1u);
+
+    stage = 2;
+    reader.join();
+    EXPECT_TRUE(eventually([&] { Epoch::collect(); return freed.load() == 1; }));
+}
+
+TEST(Epoch, ReadersNeverSeeReclaimedNodes) {
+    Graveyard yard;
+    graveyard = &yard;
+    std::atomic<int> freed{0};
+    std::atomic<Node*> shared{new Node{&freed}};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> bad{0}, reads{0};
+    const int WRITES = 20000;
+
+    std::vector<std::thread> ts;
+    for (int r = 0; r < 2; ++r)
+        ts.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                Epoch::Guard g;
+                Node* n = shared.load(std::memory_order_acquire);
+                if (n->magic.load(std::memory_order_relaxed) != LIVE)
+                    bad.fetch_add(1);
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w)
+        writers.emplace_back([&, w] {
+            for (int i = 0; i < WRITES; ++i) {
+                Node* old = shared.exchange(new Node{&freed, LIVE, uint64_t(w) << 32 | i},
+                                            std::memory_order_acq_rel);
+                Epoch::retire(old, &bury_node, sizeof(Node));
+            }
+        });
+    for (auto& t : writers) t.join();
+    stop = true;
+    for (auto& t : ts) t.join();
+
+    EXPECT_EQ(bad.load(), 0u);
+    EXPECT_GT(reads.load(), 0u);
+    // The writers exited with garbage in their bags: it was orphaned and
+    // is freed by whoever collects next.
+    EXPECT_TRUE(eventually([&] { Epoch::collect(); return freed.load() == 2 * WRITES; }))
+        << freed.load() << " of " << 2 * WRITES;
+    delete shared.load();
+    graveyard = nullptr;
+}
+
+TEST(Epoch, PoolWorkersReclaimWhenIdle) {
+    std::atomic<int> freed{0};
+    const int TASKS = 8, PER_TASK = 5;   // well under COLLECT_EVERY per worker
+    {
+        ThreadPoolV2<> pool(2);
+        for (int t = 0; t < TASKS; ++t)
+            pool.post([&] {
+                for (int i = 0; i < PER_TASK; ++i)
+                    Epoch::retire(new Node{&freed}, &free_node, sizeof(Node));
+            });
+        pool.wait_all();
+        // No collect() here: the workers reclaim on their own once idle.
+        EXPECT_TRUE(eventually([&] { return freed.load() == TASKS * PER_TASK; }))
+            << freed.load() << " of " << TASKS * PER_TASK;
+    }
+}
+
+TEST(Hazard, ProtectedNodeSurvivesScan) {
+    std::atomic<int> freed{0};
+    Node* first = new Node{&freed};
+    std::atomic<Node*> src{first};
+    std::atomic<int> stage{0};
+
+    std::thread reader([&] {
+        Hazard::Pointer hp;
+        Node* n = hp.protect(src);
+        EXPECT_EQ(n, first);
+        stage = 1;
+        while (stage.load() != 2) std::this_thread::yield();
+        EXPECT_EQ(n->magic, LIVE);
+        hp.reset();
+        stage = 3;
+        while (stage.load() != 4) std::this_thread::yield();
+    });
+    while (stage.load() != 1) std::this_thread::yield();
+
+    Node* second = new Node{&freed};
+    Node* old = src.exchange(second);
+    Hazard::retire(old, &free_node, sizeof(Node));
+    Hazard::scan();
+    EXPECT_EQ(freed.load(), 0);
+    EXPECT_EQ(Hazard::local_pending(), 1u);
+
+    stage = 2;
+    while (stage.load() != 3) std::this_thread::yield();
+    Hazard::scan();
+    EXPECT_EQ(freed.load(), 1);
+    stage = 4;
+    reader.join();
+
+    Hazard::Pointer a, b, c, d;
+    EXPECT_THROW(Hazard::Pointer e, std::length_error);
+    delete second;
+}
+
+TEST(Hazard, GarbageStaysBoundedBehindStalledReader) {
+    std::atomic<int> freed{0};
+    std::atomic<Node*> src{new Node{&freed}};
+    std::atomic<int> stage{0};
+
+    // The reader protects the current node and then stalls.
+    std::thread reader([&] {
+        Hazard::Pointer hp;
+        hp.protect(src);
+        stage = 1;
+        while (stage.load() != 2) std::this_thread::yield();
+    });
+    while (stage.load() != 1) std::this_thread::yield();
+
+    const int N = 20000;
+    size_t peak = 0;
+    for (int i = 0; i < N; ++i) {
+        Hazard::retire(src.exchange(new Node{&freed}), &free_node, sizeof(Node));
+        peak = std::max(peak, Hazard::local_pending());
+    }
+    // Everything except the stalled reader's node is freed; what waits
+    // never exceeded one scan threshold.
+    Hazard::scan();
+    EXPECT_EQ(freed.load(), N - 1);
+    EXPECT_LE(peak, std::max(Hazard::MIN_SCAN, 2 * Hazard::SLOTS * 64));
+
+    stage = 2;
+    reader.join();
+    Hazard::scan();
+    EXPECT_EQ(freed.load(), N);
+    delete src.load();
+}
+
+TEST(Hazard, ExitedThreadsGarbageIsAdopted) {
+    std::atomic<int> freed{0};
+    std::thread([&] {
+        for (int i = 0; i < 10; ++i) Hazard::retire(new Node{&freed}, &free_node, sizeof(Node));
+        EXPECT_EQ(Hazard::local_pending(), 10u);   // under MIN_SCAN: nothing freed yet
+    }).join();
+    EXPECT_EQ(freed.load(), 0);
+    EXPECT_GE(Hazard::pending(), 10u);
+
+    Hazard::retire(new Node{&freed}, &free_node, sizeof(Node));
+    Hazard::scan();   // adopts the orphans and frees all of them
+    EXPECT_EQ(freed.load(), 11);
+}
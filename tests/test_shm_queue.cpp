@@ -0,0 +1,158 @@
+/**
+ * test_shm_queue.cpp — ShmQueue: header validation, cross-process hand-off,
+ * futex wakeups, recovery of slots held by crashed peers
+ */
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "shm_queue.h"
+
+using namespace std::chrono_literals;
+
+struct Msg {
+    uint64_t id = 0;
+    uint64_t value = 0;
+};
+
+static std::string unique_name(const char* tag) {
+    return "/tp_shm_test_" + std::to_string(::getpid()) + "_" + tag;
+}
+
+// Runs `body` in a forked child and returns its exit status.
+template<typename F>
+static int in_child(F&& body) {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        body();
+        ::_exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+TEST(ShmQueue, CreateOpenRoundTripIsFifo) {
+    auto name = unique_name("fifo");
+    auto server = ShmQueue<Msg>::create(name, 8);
+    auto client = ShmQueue<Msg>::open(name, 8);
+    EXPECT_TRUE(server.is_owner());
+    EXPECT_EQ(client.capacity(), 8u);
+
+    for (uint64_t i = 0; i < 8; ++i) ASSERT_TRUE(client.try_enqueue(Msg{i, i * 10}));
+    EXPECT_FALSE(client.try_enqueue(Msg{99, 0}));
+    EXPECT_EQ(server.size(), 8u);
+
+    Msg m;
+    for (uint64_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(server.try_dequeue(m));
+        EXPECT_EQ(m.id, i);
+        EXPECT_EQ(m.value, i * 10);
+    }
+    EXPECT_FALSE(server.try_dequeue(m));
+    EXPECT_FALSE(server.dequeue(m, 5ms));   // times out, doesn't hang
+}
+
+TEST(ShmQueue, OpenRejectsMismatchedHeader) {
+    auto name = unique_name("validate");
+    auto server = ShmQueue<Msg>::create(name, 16);
+
+    struct Bigger { uint64_t a, b, c; };
+    EXPECT_THROW(ShmQueue<Bigger>::open(name), std::runtime_error);
+    EXPECT_THROW(ShmQueue<Msg>::open(name, 32), std::runtime_error);
+    EXPECT_NO_THROW(ShmQueue<Msg>::open(name, 0));
+    EXPECT_THROW(ShmQueue<Msg>::open(unique_name("missing")), std::system_error);
+    EXPECT_THROW(ShmQueue<Msg>::open("no-slash"), std::invalid_argument);
+    EXPECT_THROW(ShmQueue<Msg>::create(name, 16), std::runtime_error);   // creator alive
+    EXPECT_THROW(ShmQueue<Msg>::create(unique_name("cap"), 12), std::invalid_argument);
+}
+
+TEST(ShmQueue, CreateReplacesRegionOfDeadCreator) {
+    auto name = unique_name("stale");
+    // The child creates the region and dies without cleaning up.
+    ASSERT_EQ(in_child([&] {
+        auto q = ShmQueue<Msg>::create(name, 8);
+        q.try_enqueue(Msg{1, 1});
+        ::_exit(0);
+    }), 0);
+    auto fresh = ShmQueue<Msg>::create(name, 8);
+    EXPECT_TRUE(fresh.empty());
+}
+
+TEST(ShmQueue, ProducerProcessWakesBlockedConsumer) {
+    auto name = unique_name("xproc");
+    auto server = ShmQueue<Msg>::create(name, 64);
+    const uint64_t N = 20000;
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        auto q = ShmQueue<Msg>::open(name, 64);
+        std::this_thread::sleep_for(20ms);   // let the parent go to sleep first
+        for (uint64_t i = 0; i < N; ++i)
+            if (!q.enqueue(Msg{i, i}, 5s)) ::_exit(1);
+        ::_exit(0);
+    }
+
+    Msg m;
+    uint64_t expect = 0;
+    for (; expect < N; ++expect) {
+        ASSERT_TRUE(server.dequeue(m, 5s)) << "stalled at " << expect;
+        ASSERT_EQ(m.id, expect);   // one producer → its order is preserved
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_EQ(server.recovered(), 0u);
+}
+
+TEST(ShmQueue, SlotOfCrashedProducerIsTombstoned) {
+    auto name = unique_name("deadprod");
+    auto server = ShmQueue<Msg>::create(name, 4);
+
+    // Child claims a slot and dies before publishing it.
+    ASSERT_EQ(in_child([&] {
+        auto q = ShmQueue<Msg>::open(name);
+        q.try_produce([](Msg&) { ::_exit(0); });
+    }), 0);
+
+    server.try_enqueue(Msg{7, 0});
+    Msg m;
+    EXPECT_FALSE(server.try_dequeue(m));   // head is wedged on the dead claim
+    // The blocking call recovers on its own while it waits.
+    ASSERT_TRUE(server.dequeue(m, 2s));
+    EXPECT_EQ(m.id, 7u);
+    EXPECT_EQ(server.recovered(), 1u);
+
+    // The ring keeps cycling past the tombstoned slot.
+    for (uint64_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(server.try_enqueue(Msg{i, 0}));
+        ASSERT_TRUE(server.try_dequeue(m));
+        EXPECT_EQ(m.id, i);
+    }
+}
+
+TEST(ShmQueue, SlotOfCrashedConsumerIsReleased) {
+    auto name = unique_name("deadcons");
+    auto server = ShmQueue<Msg>::create(name, 2);
+    ASSERT_TRUE(server.try_enqueue(Msg{1, 0}));
+    ASSERT_TRUE(server.try_enqueue(Msg{2, 0}));
+
+    // Child takes the first item and dies before releasing its slot.
+    ASSERT_EQ(in_child([&] {
+        auto q = ShmQueue<Msg>::open(name);
+        q.try_consume([](Msg&) { ::_exit(0); });
+    }), 0);
+
+    Msg m;
+    ASSERT_TRUE(server.try_dequeue(m));
+    EXPECT_EQ(m.id, 2u);
+    EXPECT_FALSE(server.try_enqueue(Msg{3, 0}));   // the dead consumer's slot is still held
+    EXPECT_EQ(server.recover(), 1u);
+    EXPECT_TRUE(server.try_enqueue(Msg{3, 0}));
+    ASSERT_TRUE(server.try_dequeue(m));
+    EXPECT_EQ(m.id, 3u);
+}
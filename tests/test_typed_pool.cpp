@@ -0,0 +1,83 @@
+/**
+ * test_typed_pool.cpp — TypedPool: exactly-once handling, wait_all, job types
+ */
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "typed_pool.h"
+
+struct Job {
+    int                 id = -1;
+    std::array<char, 64> buf{};
+};
+
+struct Tally {
+    std::vector<std::atomic<int>>* seen;
+    void operator()(Job& j) const { (*seen)[j.id].fetch_add(1, std::memory_order_relaxed); }
+};
+
+TEST(TypedPool, EveryJobIsHandledExactlyOnce) {
+    const int N = 20000;
+    std::vector<std::atomic<int>> seen(N);
+    TypedPool<Job, Tally, 256> pool(4, Tally{&seen});
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; ++p)
+        producers.emplace_back([&, p] {
+            for (int i = p; i < N; i += 2) pool.submit(Job{i, {}});
+        });
+    for (auto& t : producers) t.join();
+    pool.wait_all();
+
+    EXPECT_EQ(pool.total_submitted(), static_cast<size_t>(N));
+    EXPECT_EQ(pool.total_completed(), static_cast<size_t>(N));
+    for (int i = 0; i < N; ++i) ASSERT_EQ(seen[i].load(), 1) << "job " << i;
+}
+
+TEST(TypedPool, WaitAllSeesHandlerSideEffects) {
+    struct Sum {
+        std::atomic<long> total{0};
+        void operator()(int& v) { total.fetch_add(v, std::memory_order_relaxed); }
+    };
+    Sum sum;   // outlives the pool; workers call it through the reference
+    TypedPool<int, std::reference_wrapper<Sum>> pool(3, std::ref(sum));
+    for (int round = 1; round <= 3; ++round) {
+        for (int i = 1; i <= 1000; ++i) pool.submit(i);
+        pool.wait_all();
+        EXPECT_EQ(sum.total.load(), round * 500500L);
+    }
+}
+
+TEST(TypedPool, MoveOnlyJobsAndLambdaHandlers) {
+    std::atomic<size_t> bytes{0};
+    auto handle = [&bytes](std::unique_ptr<std::string>& s) { bytes += s->size(); };
+    {
+        TypedPool<std::unique_ptr<std::string>, decltype(handle)> pool(2, handle, 1);
+        for (int i = 0; i < 500; ++i) pool.submit(std::make_unique<std::string>(10, 'x'));
+        pool.wait_all();
+    }
+    EXPECT_EQ(bytes.load(), 5000u);
+}
+
+TEST(TypedPool, TrySubmitLeavesJobIntactWhenFull) {
+    std::atomic<bool> release{false};
+    auto block = [&release](int&) { while (!release.load()) std::this_thread::yield(); };
+    TypedPool<int, decltype(block), 4> pool(1, block, 1);
+
+    pool.submit(0);   // worker blocks on this one
+    while (pool.queue_depth() != 0) std::this_thread::yield();
+    int accepted = 0;
+    for (int i = 0; i < 10; ++i) {
+        int job = i;
+        if (pool.try_submit(std::move(job))) ++accepted;
+    }
+    EXPECT_EQ(accepted, 4);
+    release = true;
+    pool.wait_all();
+    EXPECT_EQ(pool.total_completed(), 5u);
+}